@@ -7,7 +7,22 @@
                 "native/config.c",
                 "native/tunnel.c",
                 "native/excep.c",
-                "native/debug.c"
+                "native/debug.c",
+                "native/event.c",
+                "native/pump.c",
+                "native/wake.c",
+                "native/reactor.c",
+                "native/async.c",
+                "native/promise.c",
+                "native/batch.c",
+                "native/usage.c",
+                "native/callbacks.c",
+                "native/refs.c",
+                "native/instance.c",
+                "native/marshal.c",
+                "native/ascii.c",
+                "native/intern.c",
+                "native/whitelist.c"
             ],
             "actions": [
                 {
@@ -1,5 +1,16 @@
 #include <node_api.h>
 #include "debug.h"
+#include "instance.h"
+#include "pump.h"
+#include "wake.h"
+#include "reactor.h"
+#include "async.h"
+#include "promise.h"
+#include "batch.h"
+#include "usage.h"
+#include "callbacks.h"
+#include "refs.h"
+#include "whitelist.h"
 
 napi_value Init1(napi_env env, napi_value exports);
 napi_value Init2(napi_env env, napi_value exports);
@@ -7,10 +18,27 @@ napi_value Init3(napi_env env, napi_value exports);
 
 napi_value Init(napi_env env, napi_value exports)
 {
+    // Per-env state (debug flag, last exception) must exist before anything logs.
+    if (pinggy_instance_init(env) != napi_ok)
+    {
+        napi_throw_error(env, NULL, "Failed to initialize addon instance data");
+        return NULL;
+    }
+
     Init1(env, exports);
     Init2(env, exports);
     Init3(env, exports);
     InitDebug(env, exports);
+    InitPump(env, exports);
+    InitWake(env, exports);
+    InitReactor(env, exports);
+    InitAsync(env, exports);
+    InitPromise(env, exports);
+    InitBatch(env, exports);
+    InitUsage(env, exports);
+    InitCallbacks(env, exports);
+    InitRefs(env, exports);
+    InitWhitelist(env, exports);
 
     return exports;
 }
@@ -0,0 +1,125 @@
+#include <stdint.h>
+#include <string.h>
+#include <uv.h>
+#include "ascii.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PINGGY_ASCII_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define PINGGY_ASCII_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang only emit AVX2 for functions marked for it; MSVC takes the
+// intrinsics as they are.
+#if defined(PINGGY_ASCII_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PINGGY_TARGET_AVX2 __attribute__((target("avx2")))
+#define PINGGY_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define PINGGY_TARGET_AVX2
+#define PINGGY_TARGET_SSE2
+#endif
+
+#define PINGGY_HIGH_BITS 0x8080808080808080ULL
+
+static int ascii_scalar(const unsigned char *data, size_t length)
+{
+    uint64_t seen = 0;
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        seen |= word;
+    }
+    for (; i < length; i++)
+    {
+        seen |= data[i];
+    }
+    return (seen & PINGGY_HIGH_BITS) == 0;
+}
+
+#ifdef PINGGY_ASCII_X86
+PINGGY_TARGET_SSE2 static int ascii_sse2(const unsigned char *data, size_t length)
+{
+    __m128i seen = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        seen = _mm_or_si128(seen, _mm_loadu_si128((const __m128i *)(data + i)));
+    }
+    return _mm_movemask_epi8(seen) == 0 && ascii_scalar(data + i, length - i);
+}
+
+PINGGY_TARGET_AVX2 static int ascii_avx2(const unsigned char *data, size_t length)
+{
+    __m256i seen = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32)
+    {
+        seen = _mm256_or_si256(seen, _mm256_loadu_si256((const __m256i *)(data + i)));
+    }
+    return _mm256_movemask_epi8(seen) == 0 && ascii_scalar(data + i, length - i);
+}
+
+static int cpu_has_avx2(void)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    int osxsave = (info[2] & (1 << 27)) != 0;
+    int avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return 0;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // PINGGY_ASCII_X86
+
+#ifdef PINGGY_ASCII_NEON
+static int ascii_neon(const unsigned char *data, size_t length)
+{
+    uint8x16_t seen = vdupq_n_u8(0);
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16)
+    {
+        seen = vorrq_u8(seen, vld1q_u8(data + i));
+    }
+    return vmaxvq_u8(seen) < 0x80 && ascii_scalar(data + i, length - i);
+}
+#endif
+
+typedef int (*AsciiScan)(const unsigned char *data, size_t length);
+
+static AsciiScan g_ascii_scan = ascii_scalar;
+static uv_once_t g_ascii_once = UV_ONCE_INIT;
+
+static void ascii_select(void)
+{
+#if defined(PINGGY_ASCII_X86)
+    g_ascii_scan = cpu_has_avx2() ? ascii_avx2 : ascii_sse2;
+#elif defined(PINGGY_ASCII_NEON)
+    g_ascii_scan = ascii_neon;
+#endif
+}
+
+int pinggy_is_ascii(const char *data, size_t length)
+{
+    // Below one vector the setup costs more than it saves.
+    if (length < 16)
+    {
+        return ascii_scalar((const unsigned char *)data, length);
+    }
+    uv_once(&g_ascii_once, ascii_select);
+    return g_ascii_scan((const unsigned char *)data, length);
+}
@@ -0,0 +1,21 @@
+#ifndef PINGGY_ASCII_H
+#define PINGGY_ASCII_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Non-zero if none of the `length` bytes at `data` has its high bit set.
+    //
+    // Scans 32 bytes at a time with AVX2 when the CPU has it, 16 with SSE2 or
+    // NEON otherwise; the choice is made once, on first use.
+    int pinggy_is_ascii(const char *data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_ASCII_H
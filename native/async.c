@@ -0,0 +1,438 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "helper_macro.h"
+#include "event.h"
+#include "pump.h"
+#include "wake.h"
+#include "async.h"
+#include "batch.h"
+#include "instance.h"
+#include "excep.h"
+#include "marshal.h"
+#include "promise.h"
+
+/*
+ * Tunnels currently claimed by async work or by a JS-thread resume. Entries
+ * exist only while someone holds or waits for the tunnel.
+ */
+typedef struct TunnelClaim
+{
+    pinggy_ref_t tunnel;
+    int held;
+    int work_waiters;
+    int resume_waiters;
+    struct TunnelClaim *next;
+} TunnelClaim;
+
+static TunnelClaim *g_claims = NULL;
+static uv_mutex_t g_claims_lock;
+static uv_cond_t g_claims_cond;
+static uv_once_t g_claims_once = UV_ONCE_INIT;
+
+static void claims_init_once(void)
+{
+    uv_mutex_init(&g_claims_lock);
+    uv_cond_init(&g_claims_cond);
+}
+
+// Caller holds g_claims_lock.
+static TunnelClaim *claim_get(pinggy_ref_t tunnel)
+{
+    for (TunnelClaim *it = g_claims; it != NULL; it = it->next)
+    {
+        if (it->tunnel == tunnel)
+        {
+            return it;
+        }
+    }
+    TunnelClaim *claim = (TunnelClaim *)calloc(1, sizeof(TunnelClaim));
+    if (claim == NULL)
+    {
+        return NULL;
+    }
+    claim->tunnel = tunnel;
+    claim->next = g_claims;
+    g_claims = claim;
+    return claim;
+}
+
+// Caller holds g_claims_lock.
+static void claim_put(TunnelClaim *claim)
+{
+    if (claim->held || claim->work_waiters > 0 || claim->resume_waiters > 0)
+    {
+        return;
+    }
+    for (TunnelClaim **it = &g_claims; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == claim)
+        {
+            *it = claim->next;
+            break;
+        }
+    }
+    free(claim);
+}
+
+static void claim_release(pinggy_ref_t tunnel)
+{
+    uv_mutex_lock(&g_claims_lock);
+    for (TunnelClaim *it = g_claims; it != NULL; it = it->next)
+    {
+        if (it->tunnel == tunnel)
+        {
+            it->held = 0;
+            uv_cond_broadcast(&g_claims_cond);
+            claim_put(it);
+            break;
+        }
+    }
+    uv_mutex_unlock(&g_claims_lock);
+}
+
+void tunnel_async_resume_begin(pinggy_ref_t tunnel)
+{
+    uv_once(&g_claims_once, claims_init_once);
+    uv_mutex_lock(&g_claims_lock);
+    TunnelClaim *claim = claim_get(tunnel);
+    if (claim != NULL)
+    {
+        // Work that is already waiting goes first; it only copies state.
+        claim->resume_waiters++;
+        while (claim->held || claim->work_waiters > 0)
+        {
+            uv_cond_wait(&g_claims_cond, &g_claims_lock);
+        }
+        claim->resume_waiters--;
+        claim->held = 1;
+    }
+    uv_mutex_unlock(&g_claims_lock);
+}
+
+void tunnel_async_resume_end(pinggy_ref_t tunnel)
+{
+    claim_release(tunnel);
+}
+
+// Called on a threadpool thread.
+static void work_claim(pinggy_ref_t tunnel)
+{
+    uv_once(&g_claims_once, claims_init_once);
+    uv_mutex_lock(&g_claims_lock);
+    TunnelClaim *claim = claim_get(tunnel);
+    if (claim != NULL)
+    {
+        claim->work_waiters++;
+        while (claim->held)
+        {
+            // Cut short a resume sleeping on the JS thread.
+            tunnel_wake(tunnel);
+            uv_cond_wait(&g_claims_cond, &g_claims_lock);
+        }
+        claim->work_waiters--;
+        claim->held = 1;
+    }
+    uv_mutex_unlock(&g_claims_lock);
+}
+
+typedef enum
+{
+    PINGGY_ASYNC_START = 0,
+    PINGGY_ASYNC_STOP,
+    PINGGY_ASYNC_GREETING,
+    PINGGY_ASYNC_USAGES,
+    PINGGY_ASYNC_WEB_DEBUGGING_ADDRESS,
+} PinggyAsyncOp;
+
+typedef struct
+{
+    PinggyAsyncOp op;
+    pinggy_ref_t tunnel;
+    PinggyInstance *instance; // bound to the threadpool thread during the call
+    napi_async_work work;
+    napi_deferred deferred;
+
+    pinggy_bool_t success;
+    char *text;
+    size_t text_len;
+    const char *error;
+    int raised; // libpinggy raised an exception during the call
+    PinggyEventQueue events;
+} PinggyAsyncRequest;
+
+static const char *const async_resource_names[] = {
+    "PinggyTunnelStart",
+    "PinggyTunnelStop",
+    "PinggyTunnelGreetMessage",
+    "PinggyTunnelUsages",
+    "PinggyTunnelWebDebuggingAddress",
+};
+
+// Two-step length/copy read used by the string getters.
+static void read_string(PinggyAsyncRequest *request,
+                        pinggy_const_int_t (*get_len)(pinggy_ref_t, pinggy_capa_t, pinggy_char_p_t, pinggy_capa_p_t),
+                        pinggy_const_int_t (*get)(pinggy_ref_t, pinggy_capa_t, pinggy_char_p_t))
+{
+    pinggy_capa_t required_len = 0;
+    pinggy_const_int_t rc = get_len(request->tunnel, 0, NULL, &required_len);
+    if (rc < 0)
+    {
+        request->error = "Failed to get length";
+        return;
+    }
+    request->success = pinggy_true;
+    if (required_len == 0)
+    {
+        return;
+    }
+
+    request->text = (char *)malloc((size_t)required_len + 1);
+    if (request->text == NULL)
+    {
+        request->success = pinggy_false;
+        request->error = "Memory allocation failed";
+        return;
+    }
+    pinggy_const_int_t copied_len = get(request->tunnel, required_len, request->text);
+    if (copied_len < 0)
+    {
+        request->success = pinggy_false;
+        request->error = "Failed to copy value";
+        return;
+    }
+    request->text[required_len] = '\0';
+    request->text_len = strnlen(request->text, (size_t)copied_len);
+}
+
+static void async_execute(napi_env env, void *data)
+{
+    PinggyAsyncRequest *request = (PinggyAsyncRequest *)data;
+    PinggyInstance *previous_instance = pinggy_instance_enter(request->instance);
+    pinggy_ref_t previous_tunnel = pinggy_exception_attribute(request->tunnel);
+    uint32_t raised = pinggy_exception_raised();
+
+    if (request->op == PINGGY_ASYNC_STOP)
+    {
+        // pinggy_tunnel_stop is the one thread-safe libpinggy call.
+        request->success = pinggy_tunnel_stop(request->tunnel);
+        request->raised = pinggy_exception_raised() != raised;
+        tunnel_wake(request->tunnel);
+        pinggy_exception_attribute(previous_tunnel);
+        pinggy_instance_enter(previous_instance);
+        return;
+    }
+
+    TunnelDriver *driver = tunnel_driver_acquire(request->tunnel);
+    if (driver == NULL)
+    {
+        work_claim(request->tunnel);
+    }
+    pinggy_event_defer(&request->events);
+
+    switch (request->op)
+    {
+    case PINGGY_ASYNC_START:
+        request->success = pinggy_tunnel_start_non_blocking(request->tunnel);
+        if (!request->success)
+        {
+            request->error = "Failed to start tunnel in non-blocking mode";
+        }
+        break;
+    case PINGGY_ASYNC_GREETING:
+        read_string(request, pinggy_tunnel_get_greeting_msgs_len, pinggy_tunnel_get_greeting_msgs);
+        break;
+    case PINGGY_ASYNC_USAGES:
+        read_string(request, pinggy_tunnel_get_current_usages_len, pinggy_tunnel_get_current_usages);
+        if (request->success && request->text == NULL)
+        {
+            request->success = pinggy_false;
+            request->error = "Failed to get usages length";
+        }
+        break;
+    case PINGGY_ASYNC_WEB_DEBUGGING_ADDRESS:
+        read_string(request, pinggy_tunnel_get_webdebugging_addr_len, pinggy_tunnel_get_webdebugging_addr);
+        break;
+    default:
+        break;
+    }
+
+    request->raised = pinggy_exception_raised() != raised;
+    pinggy_event_defer(NULL);
+    if (driver == NULL)
+    {
+        claim_release(request->tunnel);
+    }
+    tunnel_driver_release(driver);
+    // The completion is queued on the JS thread's loop, which may be blocked
+    // in a resume of this very tunnel.
+    tunnel_wake(request->tunnel);
+    pinggy_exception_attribute(previous_tunnel);
+    pinggy_instance_enter(previous_instance);
+}
+
+static void async_complete(napi_env env, napi_status status, void *data)
+{
+    PinggyAsyncRequest *request = (PinggyAsyncRequest *)data;
+    napi_value value = NULL;
+    char exception[PINGGY_EXCEPTION_TEXT_SIZE];
+    const char *failure = NULL;
+
+    // Callbacks fired during the call run before the promise settles.
+    pinggy_event_queue_flush(env, &request->events);
+    pinggy_event_batch_flush(env, request->tunnel);
+
+    // The exception went to the env's remote slot, tagged with the tunnel.
+    // Fail the call with it rather than leave it for whatever JS calls next.
+    if (status == napi_ok && request->raised &&
+        pinggy_exception_take_remote(env, request->tunnel, exception, sizeof(exception)))
+    {
+        napi_value code, message;
+        napi_create_string_utf8(env, "ERR_PINGGY_EXCEPTION", NAPI_AUTO_LENGTH, &code);
+        napi_create_string_utf8(env, exception, NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, code, message, &value);
+        napi_reject_deferred(env, request->deferred, value);
+        failure = exception;
+    }
+    else if (status == napi_ok && request->success)
+    {
+        if (request->op == PINGGY_ASYNC_START || request->op == PINGGY_ASYNC_STOP)
+        {
+            napi_get_boolean(env, request->success, &value);
+        }
+        else
+        {
+            pinggy_string_create(env, request->text != NULL ? request->text : "", request->text_len, &value);
+        }
+        napi_resolve_deferred(env, request->deferred, value);
+    }
+    else
+    {
+        napi_value message;
+        failure = status == napi_cancelled ? "Operation cancelled" : request->error;
+        if (failure == NULL)
+        {
+            failure = "Operation failed";
+        }
+        napi_create_string_utf8(env, failure, NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, NULL, message, &value);
+        napi_reject_deferred(env, request->deferred, value);
+    }
+
+    // A start promise armed for this attempt would otherwise wait forever.
+    if (request->op == PINGGY_ASYNC_START && failure != NULL)
+    {
+        tunnel_start_promise_cancel(env, request->tunnel, failure);
+    }
+    else if (request->op == PINGGY_ASYNC_STOP && status == napi_ok)
+    {
+        tunnel_start_promise_cancel(env, request->tunnel, "Tunnel stopped");
+    }
+    PINGGY_DEBUG("async %s for tunnel %u done, success = %d",
+                 async_resource_names[request->op], (unsigned)request->tunnel, (int)request->success);
+
+    napi_delete_async_work(env, request->work);
+    pinggy_instance_release(request->instance);
+    free(request->text);
+    free(request);
+}
+
+// Common body of every async entry point: fn(tunnelRef) -> Promise.
+static napi_value queue_async(napi_env env, napi_callback_info info, PinggyAsyncOp op)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (tunnel ref)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected argument to be an unsigned integer (tunnel ref)");
+
+    PinggyAsyncRequest *request = (PinggyAsyncRequest *)calloc(1, sizeof(PinggyAsyncRequest));
+    NAPI_CHECK_CONDITION_THROW(env, request != NULL, "Failed to allocate memory for async request");
+    request->op = op;
+    request->tunnel = (pinggy_ref_t)tunnel_ref;
+
+    napi_value promise, resource_name;
+    status = napi_create_promise(env, &request->deferred, &promise);
+    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to create promise", free(request));
+    request->instance = pinggy_instance_get(env);
+    pinggy_instance_retain(request->instance);
+
+    napi_create_string_utf8(env, async_resource_names[op], NAPI_AUTO_LENGTH, &resource_name);
+    status = napi_create_async_work(env, NULL, resource_name, async_execute, async_complete, request, &request->work);
+    if (status == napi_ok)
+    {
+        status = napi_queue_async_work(env, request->work);
+        if (status != napi_ok)
+        {
+            napi_delete_async_work(env, request->work);
+        }
+    }
+    if (status != napi_ok)
+    {
+        napi_value message, error;
+        napi_create_string_utf8(env, "Failed to queue async work", NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, NULL, message, &error);
+        napi_reject_deferred(env, request->deferred, error);
+        pinggy_instance_release(request->instance);
+        free(request);
+    }
+
+    return promise;
+}
+
+napi_value TunnelStartAsync(napi_env env, napi_callback_info info)
+{
+    return queue_async(env, info, PINGGY_ASYNC_START);
+}
+
+napi_value TunnelStopAsync(napi_env env, napi_callback_info info)
+{
+    return queue_async(env, info, PINGGY_ASYNC_STOP);
+}
+
+napi_value GetTunnelGreetMessageAsync(napi_env env, napi_callback_info info)
+{
+    return queue_async(env, info, PINGGY_ASYNC_GREETING);
+}
+
+napi_value GetTunnelUsagesAsync(napi_env env, napi_callback_info info)
+{
+    return queue_async(env, info, PINGGY_ASYNC_USAGES);
+}
+
+napi_value GetTunnelWebDebuggingAddressAsync(napi_env env, napi_callback_info info)
+{
+    return queue_async(env, info, PINGGY_ASYNC_WEB_DEBUGGING_ADDRESS);
+}
+
+napi_value InitAsync(napi_env env, napi_value exports)
+{
+    napi_value start_fn, stop_fn, greet_fn, usages_fn, web_debugging_fn;
+
+    napi_create_function(env, NULL, 0, TunnelStartAsync, NULL, &start_fn);
+    napi_set_named_property(env, exports, "tunnelStartAsync", start_fn);
+
+    napi_create_function(env, NULL, 0, TunnelStopAsync, NULL, &stop_fn);
+    napi_set_named_property(env, exports, "tunnelStopAsync", stop_fn);
+
+    napi_create_function(env, NULL, 0, GetTunnelGreetMessageAsync, NULL, &greet_fn);
+    napi_set_named_property(env, exports, "getTunnelGreetMessageAsync", greet_fn);
+
+    napi_create_function(env, NULL, 0, GetTunnelUsagesAsync, NULL, &usages_fn);
+    napi_set_named_property(env, exports, "getTunnelUsagesAsync", usages_fn);
+
+    napi_create_function(env, NULL, 0, GetTunnelWebDebuggingAddressAsync, NULL, &web_debugging_fn);
+    napi_set_named_property(env, exports, "getTunnelWebDebuggingAddressAsync", web_debugging_fn);
+
+    return exports;
+}
@@ -0,0 +1,35 @@
+#ifndef PINGGY_ASYNC_H
+#define PINGGY_ASYNC_H
+
+#include <node_api.h>
+#include "../pinggy.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Promise-returning variants of tunnel calls that may block (connecting,
+    // stopping, copying tunnel state). The libpinggy call runs on the libuv
+    // threadpool through napi_async_work; callbacks it fires are queued and
+    // dispatched on the JS thread before the promise settles. An exception
+    // libpinggy raises during the call rejects the promise with an Error
+    // whose code is "ERR_PINGGY_EXCEPTION".
+    //
+    // libpinggy is not thread-safe, so a tunnel resumed from the JS thread
+    // (tunnelResume*) brackets every resume with the calls below.
+    // Pending work wakes the resume and is let in before the next one.
+    // Tunnels driven by a pump or reactor use tunnel_driver_acquire instead.
+
+    // Waits until no async work holds or is waiting for the tunnel.
+    void tunnel_async_resume_begin(pinggy_ref_t tunnel);
+
+    void tunnel_async_resume_end(pinggy_ref_t tunnel);
+
+    napi_value InitAsync(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_ASYNC_H
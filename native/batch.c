@@ -0,0 +1,346 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "helper_macro.h"
+#include "event.h"
+#include "promise.h"
+#include "batch.h"
+#include "callbacks.h"
+
+typedef struct EventBatch
+{
+    pinggy_ref_t tunnel;
+    napi_env env;
+    napi_ref callback_ref;
+
+    // Ring of event copies; capacity is a power of two.
+    PinggyEvent **ring;
+    uint32_t head;
+    uint32_t count;
+    uint32_t capacity;
+    int flush_requested;
+
+    struct EventBatch *next;
+} EventBatch;
+
+static EventBatch *g_batches = NULL;
+static uv_mutex_t g_batches_lock;
+static uv_once_t g_batches_once = UV_ONCE_INIT;
+
+static void batches_init_once(void)
+{
+    uv_mutex_init(&g_batches_lock);
+}
+
+// Caller holds g_batches_lock.
+static EventBatch *batch_find(pinggy_ref_t tunnel)
+{
+    for (EventBatch *it = g_batches; it != NULL; it = it->next)
+    {
+        if (it->tunnel == tunnel)
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+// Caller holds g_batches_lock.
+static int batch_push(EventBatch *batch, PinggyEvent *event)
+{
+    if (batch->count == batch->capacity)
+    {
+        uint32_t capacity = batch->capacity * 2;
+        PinggyEvent **ring = (PinggyEvent **)malloc(capacity * sizeof(PinggyEvent *));
+        if (ring == NULL)
+        {
+            return 0;
+        }
+        for (uint32_t i = 0; i < batch->count; i++)
+        {
+            ring[i] = batch->ring[(batch->head + i) & (batch->capacity - 1)];
+        }
+        free(batch->ring);
+        batch->ring = ring;
+        batch->head = 0;
+        batch->capacity = capacity;
+    }
+    batch->ring[(batch->head + batch->count) & (batch->capacity - 1)] = event;
+    batch->count++;
+    return 1;
+}
+
+// Caller holds g_batches_lock.
+static void batch_unlink(EventBatch *batch)
+{
+    for (EventBatch **it = &g_batches; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == batch)
+        {
+            *it = batch->next;
+            break;
+        }
+    }
+}
+
+static void batch_free(EventBatch *batch)
+{
+    for (uint32_t i = 0; i < batch->count; i++)
+    {
+        free(batch->ring[(batch->head + i) & (batch->capacity - 1)]);
+    }
+    free(batch->ring);
+    free(batch);
+}
+
+int pinggy_event_batch_append(const PinggyEvent *event)
+{
+    int taken = 0;
+    uv_once(&g_batches_once, batches_init_once);
+    uv_mutex_lock(&g_batches_lock);
+    EventBatch *batch = batch_find(event->tunnel);
+    if (batch != NULL)
+    {
+        PinggyEvent *copy = pinggy_event_clone(event);
+        if (copy != NULL && batch_push(batch, copy))
+        {
+            taken = 1;
+        }
+        else
+        {
+            free(copy);
+            PINGGY_DEBUG("Failed to queue event %d for tunnel %u", (int)event->type, (unsigned)event->tunnel);
+            // Dropped rather than dispatched on a thread that may not own the env.
+            taken = 1;
+        }
+    }
+    uv_mutex_unlock(&g_batches_lock);
+    return taken;
+}
+
+int pinggy_event_batch_claim_flush(pinggy_ref_t tunnel)
+{
+    int claimed = 0;
+    uv_once(&g_batches_once, batches_init_once);
+    uv_mutex_lock(&g_batches_lock);
+    EventBatch *batch = batch_find(tunnel);
+    if (batch != NULL && batch->count > 0 && !batch->flush_requested)
+    {
+        batch->flush_requested = 1;
+        claimed = 1;
+    }
+    uv_mutex_unlock(&g_batches_lock);
+    return claimed;
+}
+
+void pinggy_event_batch_flush(napi_env env, pinggy_ref_t tunnel)
+{
+    PinggyEvent **events = NULL;
+    uint32_t count = 0;
+    napi_ref callback_ref = NULL;
+
+    uv_once(&g_batches_once, batches_init_once);
+    uv_mutex_lock(&g_batches_lock);
+    EventBatch *batch = batch_find(tunnel);
+    if (batch != NULL && batch->env == env && batch->count > 0)
+    {
+        events = (PinggyEvent **)malloc(batch->count * sizeof(PinggyEvent *));
+        if (events != NULL)
+        {
+            count = batch->count;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                events[i] = batch->ring[(batch->head + i) & (batch->capacity - 1)];
+            }
+            batch->head = 0;
+            batch->count = 0;
+            batch->flush_requested = 0;
+            callback_ref = batch->callback_ref;
+        }
+    }
+    uv_mutex_unlock(&g_batches_lock);
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Usage updates are snapshots, and natively parsed ones all land in the
+    // tunnel's single usage view: only the latest of a batch is delivered, so
+    // its handler reads its own values.
+    uint32_t last_usage = count;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (events[i]->type == PINGGY_EVENT_USAGE_UPDATE)
+        {
+            last_usage = i;
+        }
+    }
+
+    napi_handle_scope scope;
+    napi_value callback, undefined, array, argv[2];
+    if (napi_open_handle_scope(env, &scope) == napi_ok)
+    {
+        uint32_t delivered = 0;
+        napi_create_array(env, &array);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            napi_value args[PINGGY_EVENT_MAX_STRINGS + 4], entry, type;
+            size_t argc = 0;
+
+            tunnel_start_promise_settle(env, events[i]);
+            if ((events[i]->type == PINGGY_EVENT_USAGE_UPDATE && i != last_usage) ||
+                pinggy_event_build_args(env, events[i], args, &argc) != napi_ok)
+            {
+                continue;
+            }
+            napi_create_array_with_length(env, argc + 1, &entry);
+            napi_create_uint32(env, (uint32_t)events[i]->type, &type);
+            napi_set_element(env, entry, 0, type);
+            for (size_t j = 0; j < argc; j++)
+            {
+                napi_set_element(env, entry, (uint32_t)(j + 1), args[j]);
+            }
+            napi_set_element(env, array, delivered++, entry);
+        }
+
+        if (napi_get_reference_value(env, callback_ref, &callback) == napi_ok && callback != NULL)
+        {
+            napi_create_uint32(env, (uint32_t)tunnel, &argv[0]);
+            argv[1] = array;
+            napi_get_undefined(env, &undefined);
+            napi_call_function(env, undefined, callback, 2, argv, NULL);
+        }
+        napi_close_handle_scope(env, scope);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        free(events[i]);
+    }
+    free(events);
+}
+
+static void batch_env_cleanup(void *arg)
+{
+    EventBatch *batch = (EventBatch *)arg;
+    uv_mutex_lock(&g_batches_lock);
+    batch_unlink(batch);
+    uv_mutex_unlock(&g_batches_lock);
+    napi_delete_reference(batch->env, batch->callback_ref);
+    batch_free(batch);
+}
+
+void pinggy_event_batch_release(napi_env env, pinggy_ref_t tunnel)
+{
+    uv_once(&g_batches_once, batches_init_once);
+    uv_mutex_lock(&g_batches_lock);
+    EventBatch *batch = batch_find(tunnel);
+    if (batch != NULL && batch->env == env)
+    {
+        batch_unlink(batch);
+    }
+    else
+    {
+        batch = NULL;
+    }
+    uv_mutex_unlock(&g_batches_lock);
+    if (batch == NULL)
+    {
+        return;
+    }
+    napi_remove_env_cleanup_hook(env, batch_env_cleanup, batch);
+    napi_delete_reference(env, batch->callback_ref);
+    batch_free(batch);
+}
+
+// tunnelSetEventBatchCallback(tunnelRef, callback(tunnelRef, events) | null)
+napi_value TunnelSetEventBatchCallback(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value args[2];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (tunnel ref, callback)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected first argument to be an unsigned integer (tunnel ref)");
+
+    napi_valuetype cb_type;
+    status = napi_typeof(env, args[1], &cb_type);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to check callback type");
+    NAPI_CHECK_CONDITION_THROW(env, cb_type == napi_function || cb_type == napi_null || cb_type == napi_undefined,
+                               "Second argument must be a function or null");
+
+    uv_once(&g_batches_once, batches_init_once);
+
+    EventBatch *batch = NULL;
+    if (cb_type == napi_function)
+    {
+        batch = (EventBatch *)calloc(1, sizeof(EventBatch));
+        NAPI_CHECK_CONDITION_THROW(env, batch != NULL, "Failed to allocate memory for EventBatch");
+        batch->ring = (PinggyEvent **)malloc(PINGGY_BATCH_INITIAL_CAPACITY * sizeof(PinggyEvent *));
+        NAPI_CHECK_CONDITION_THROW_AND_CLEANUP(env, batch->ring != NULL, "Failed to allocate memory for event ring", free(batch));
+        batch->capacity = PINGGY_BATCH_INITIAL_CAPACITY;
+        batch->tunnel = (pinggy_ref_t)tunnel_ref;
+        batch->env = env;
+        status = napi_create_reference(env, args[1], 1, &batch->callback_ref);
+        NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Unable to create reference", batch_free(batch));
+    }
+
+    uv_mutex_lock(&g_batches_lock);
+    EventBatch *previous = batch_find((pinggy_ref_t)tunnel_ref);
+    if (previous != NULL && previous->env != env)
+    {
+        uv_mutex_unlock(&g_batches_lock);
+        if (batch != NULL)
+        {
+            napi_delete_reference(env, batch->callback_ref);
+            batch_free(batch);
+        }
+        NAPI_THROW_ERROR(env, "Tunnel events are batched by another thread");
+    }
+    if (previous != NULL)
+    {
+        batch_unlink(previous);
+    }
+    if (batch != NULL)
+    {
+        batch->next = g_batches;
+        g_batches = batch;
+    }
+    uv_mutex_unlock(&g_batches_lock);
+
+    if (previous != NULL)
+    {
+        // Events still queued for the old callback are dropped.
+        napi_remove_env_cleanup_hook(env, batch_env_cleanup, previous);
+        napi_delete_reference(env, previous->callback_ref);
+        batch_free(previous);
+    }
+    if (batch != NULL)
+    {
+        napi_add_env_cleanup_hook(env, batch_env_cleanup, batch);
+        tunnel_set_event_trampolines((pinggy_ref_t)tunnel_ref, NULL);
+    }
+
+    napi_value js_result;
+    napi_get_boolean(env, batch != NULL, &js_result);
+    return js_result;
+}
+
+napi_value InitBatch(napi_env env, napi_value exports)
+{
+    napi_value set_batch_fn;
+
+    napi_create_function(env, NULL, 0, TunnelSetEventBatchCallback, NULL, &set_batch_fn);
+    napi_set_named_property(env, exports, "tunnelSetEventBatchCallback", set_batch_fn);
+
+    return exports;
+}
@@ -0,0 +1,44 @@
+#ifndef PINGGY_BATCH_H
+#define PINGGY_BATCH_H
+
+#include <node_api.h>
+#include "../pinggy.h"
+#include "event.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Batched event delivery.
+    //
+    // A tunnel with a batch callback gets its events copied into a per-tunnel
+    // ring instead of one JS call each. Whoever ran the resume flushes the ring
+    // once it returns, and the callback receives every event of that resume as
+    // one array of [type, ...callbackArgs] entries. Usage updates are folded:
+    // only the latest of a batch is delivered.
+
+#define PINGGY_BATCH_INITIAL_CAPACITY 16
+
+    // Copies the event into its tunnel's ring if the tunnel is batched.
+    // Returns non-zero if the event was taken. Any thread.
+    int pinggy_event_batch_append(const PinggyEvent *event);
+
+    // Non-zero if the tunnel's ring holds events and no flush has been
+    // requested for them yet; marks the flush as requested. Any thread.
+    int pinggy_event_batch_claim_flush(pinggy_ref_t tunnel);
+
+    // Delivers the tunnel's queued events in a single call. No-op unless `env`
+    // owns the batch callback. Must run on that env's JS thread.
+    void pinggy_event_batch_flush(napi_env env, pinggy_ref_t tunnel);
+
+    // Drops the tunnel's batch callback and queued events, if `env` owns them.
+    void pinggy_event_batch_release(napi_env env, pinggy_ref_t tunnel);
+
+    napi_value InitBatch(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_BATCH_H
@@ -0,0 +1,246 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "helper_macro.h"
+#include "event.h"
+#include "batch.h"
+#include "usage.h"
+#include "wake.h"
+#include "promise.h"
+#include "instance.h"
+#include "callbacks.h"
+
+typedef struct TunnelCallbacks
+{
+    pinggy_ref_t tunnel;
+    napi_env env;
+    CallbackData slots[PINGGY_EVENT_COUNT]; // callback_ref NULL when unset
+
+    struct TunnelCallbacks *next;
+} TunnelCallbacks;
+
+static TunnelCallbacks *g_callbacks = NULL;
+static uv_mutex_t g_callbacks_lock;
+static uv_once_t g_callbacks_once = UV_ONCE_INIT;
+
+static void callbacks_init_once(void)
+{
+    uv_mutex_init(&g_callbacks_lock);
+}
+
+// Caller holds g_callbacks_lock.
+static TunnelCallbacks *callbacks_find(pinggy_ref_t tunnel)
+{
+    for (TunnelCallbacks *it = g_callbacks; it != NULL; it = it->next)
+    {
+        if (it->tunnel == tunnel)
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+// Caller holds g_callbacks_lock.
+static void callbacks_unlink(TunnelCallbacks *block)
+{
+    for (TunnelCallbacks **it = &g_callbacks; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == block)
+        {
+            *it = block->next;
+            break;
+        }
+    }
+}
+
+static void callbacks_free(TunnelCallbacks *block)
+{
+    for (int i = 0; i < PINGGY_EVENT_COUNT; i++)
+    {
+        if (block->slots[i].callback_ref != NULL)
+        {
+            napi_delete_reference(block->env, block->slots[i].callback_ref);
+        }
+    }
+    free(block);
+}
+
+static void callbacks_env_cleanup(void *arg)
+{
+    TunnelCallbacks *block = (TunnelCallbacks *)arg;
+    uv_mutex_lock(&g_callbacks_lock);
+    callbacks_unlink(block);
+    uv_mutex_unlock(&g_callbacks_lock);
+    callbacks_free(block);
+}
+
+CallbackData *tunnel_callbacks_store(napi_env env, pinggy_ref_t tunnel, PinggyEventType type, napi_value callback)
+{
+    napi_ref ref, previous = NULL;
+    napi_status status;
+
+    status = napi_create_reference(env, callback, 1, &ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create reference for callback");
+
+    uv_once(&g_callbacks_once, callbacks_init_once);
+    uv_mutex_lock(&g_callbacks_lock);
+    TunnelCallbacks *block = callbacks_find(tunnel), *created = NULL;
+    if (block == NULL)
+    {
+        block = created = (TunnelCallbacks *)calloc(1, sizeof(TunnelCallbacks));
+        if (block != NULL)
+        {
+            block->tunnel = tunnel;
+            block->env = env;
+            for (int i = 0; i < PINGGY_EVENT_COUNT; i++)
+            {
+                block->slots[i].env = env;
+            }
+            block->next = g_callbacks;
+            g_callbacks = block;
+        }
+    }
+    int usable = block != NULL && block->env == env;
+    if (usable)
+    {
+        previous = block->slots[type].callback_ref;
+        block->slots[type].callback_ref = ref;
+    }
+    uv_mutex_unlock(&g_callbacks_lock);
+
+    if (!usable)
+    {
+        napi_delete_reference(env, ref);
+        NAPI_THROW_ERROR(env, block == NULL ? "Failed to allocate memory for tunnel callbacks"
+                                            : "Tunnel callbacks are owned by another thread");
+    }
+    if (previous != NULL)
+    {
+        napi_delete_reference(env, previous);
+    }
+    if (created != NULL)
+    {
+        napi_add_env_cleanup_hook(env, callbacks_env_cleanup, created);
+    }
+    return &block->slots[type];
+}
+
+void tunnel_callbacks_clear(napi_env env, pinggy_ref_t tunnel, PinggyEventType type)
+{
+    napi_ref previous = NULL;
+    uv_once(&g_callbacks_once, callbacks_init_once);
+    uv_mutex_lock(&g_callbacks_lock);
+    TunnelCallbacks *block = callbacks_find(tunnel);
+    if (block != NULL && block->env == env)
+    {
+        previous = block->slots[type].callback_ref;
+        block->slots[type].callback_ref = NULL;
+    }
+    uv_mutex_unlock(&g_callbacks_lock);
+    if (previous != NULL)
+    {
+        napi_delete_reference(env, previous);
+    }
+}
+
+napi_ref tunnel_callbacks_lookup(napi_env env, pinggy_ref_t tunnel, PinggyEventType type)
+{
+    napi_ref ref = NULL;
+    uv_once(&g_callbacks_once, callbacks_init_once);
+    uv_mutex_lock(&g_callbacks_lock);
+    TunnelCallbacks *block = callbacks_find(tunnel);
+    if (block != NULL && block->env == env)
+    {
+        // Only this env's thread replaces or frees the reference.
+        ref = block->slots[type].callback_ref;
+    }
+    uv_mutex_unlock(&g_callbacks_lock);
+    return ref;
+}
+
+napi_env tunnel_callbacks_env(pinggy_ref_t tunnel)
+{
+    napi_env env = NULL;
+    uv_once(&g_callbacks_once, callbacks_init_once);
+    uv_mutex_lock(&g_callbacks_lock);
+    TunnelCallbacks *block = callbacks_find(tunnel);
+    if (block != NULL)
+    {
+        env = block->env;
+    }
+    uv_mutex_unlock(&g_callbacks_lock);
+    return env;
+}
+
+void tunnel_callbacks_release(napi_env env, pinggy_ref_t tunnel)
+{
+    uv_once(&g_callbacks_once, callbacks_init_once);
+    uv_mutex_lock(&g_callbacks_lock);
+    TunnelCallbacks *block = callbacks_find(tunnel);
+    if (block != NULL && block->env == env)
+    {
+        callbacks_unlink(block);
+    }
+    else
+    {
+        block = NULL;
+    }
+    uv_mutex_unlock(&g_callbacks_lock);
+
+    // libpinggy keeps the slot addresses as user data. They are never
+    // dereferenced, so there is no need to re-register the trampolines
+    // (which would race with a thread still driving the tunnel).
+    pinggy_event_batch_release(env, tunnel);
+    tunnel_usage_view_release(env, tunnel);
+    tunnel_wake_flag_release(env, tunnel);
+    tunnel_start_promise_cancel(env, tunnel, "Tunnel closed");
+    if (block == NULL)
+    {
+        return;
+    }
+    napi_remove_env_cleanup_hook(env, callbacks_env_cleanup, block);
+    callbacks_free(block);
+    PINGGY_DEBUG("released callbacks of tunnel %u", (unsigned)tunnel);
+}
+
+// tunnelReleaseCallbacks(tunnelRef, reason?): drops every JS callback held for
+// the tunnel; a start promise still armed on it is rejected with `reason`.
+napi_value TunnelReleaseCallbacks(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value args[2];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (tunnel ref)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected argument to be an unsigned integer (tunnel ref)");
+
+    if (argc >= 2)
+    {
+        char reason[PINGGY_EXCEPTION_TEXT_SIZE];
+        if (napi_get_value_string_utf8(env, args[1], reason, sizeof(reason), NULL) == napi_ok)
+        {
+            tunnel_start_promise_cancel(env, (pinggy_ref_t)tunnel_ref, reason);
+        }
+    }
+    tunnel_callbacks_release(env, (pinggy_ref_t)tunnel_ref);
+    return NULL;
+}
+
+napi_value InitCallbacks(napi_env env, napi_value exports)
+{
+    napi_value release_fn;
+
+    napi_create_function(env, NULL, 0, TunnelReleaseCallbacks, NULL, &release_fn);
+    napi_set_named_property(env, exports, "tunnelReleaseCallbacks", release_fn);
+
+    return exports;
+}
@@ -0,0 +1,52 @@
+#ifndef PINGGY_CALLBACKS_H
+#define PINGGY_CALLBACKS_H
+
+#include <node_api.h>
+#include "../pinggy.h"
+#include "event.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Per-tunnel callback block.
+    //
+    // Every JS callback registered on a tunnel lives in one allocation with a
+    // slot per event type. The slot's address is the user data handed to
+    // libpinggy, but it only marks that JS wants the event: dispatch looks the
+    // callback up again by (tunnel, type), so events still queued when the
+    // block is released are dropped instead of touching freed memory.
+
+    // Registers the trampoline of `type` on the tunnel with `target` as user
+    // data (NULL: no per-event JS callback). Defined in tunnel.c.
+    pinggy_bool_t tunnel_set_event_trampoline(pinggy_ref_t tunnel, PinggyEventType type, CallbackData *target);
+
+    // Same for every event type.
+    pinggy_bool_t tunnel_set_event_trampolines(pinggy_ref_t tunnel, CallbackData *target);
+
+    // Stores `callback` for `type`, replacing the previous one. Returns the
+    // slot to register with libpinggy, or NULL with a JS exception pending.
+    CallbackData *tunnel_callbacks_store(napi_env env, pinggy_ref_t tunnel, PinggyEventType type, napi_value callback);
+
+    // Drops the callback stored for `type`, if any.
+    void tunnel_callbacks_clear(napi_env env, pinggy_ref_t tunnel, PinggyEventType type);
+
+    // The callback stored for the event, or NULL. JS thread of `env` only.
+    napi_ref tunnel_callbacks_lookup(napi_env env, pinggy_ref_t tunnel, PinggyEventType type);
+
+    // The env that owns the tunnel's callbacks, or NULL. Any thread.
+    napi_env tunnel_callbacks_env(pinggy_ref_t tunnel);
+
+    // Frees the block with every reference it holds, along with the tunnel's
+    // batch callback, usage view and start promise entry (rejecting a promise
+    // still armed on it). Safe to call more than once.
+    void tunnel_callbacks_release(napi_env env, pinggy_ref_t tunnel);
+
+    napi_value InitCallbacks(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_CALLBACKS_H
@@ -4,6 +4,10 @@
 #include "../pinggy.h"
 #include "debug.h"
 #include "helper_macro.h"
+#include "refs.h"
+#include "config_fields.h"
+#include "marshal.h"
+#include "excep.h"
 
 // Binding for pinggy_set_log_path
 napi_value SetLogPath(napi_env env, napi_callback_info info)
@@ -40,45 +44,18 @@ napi_value SetLogPath(napi_env env, napi_callback_info info)
         return NULL;
     }
 
-    // Convert JavaScript string to C string
-    size_t str_len;
-
-    // napi_status napi_get_value_string_utf8(napi_env env,
-    //                                    napi_value value,
-    //                                    char* buf,
-    //                                    size_t bufsize,
-    //                                    size_t* result)
-    // - [in] env: the Node-API environment
-    // - [in] value: the JavaScript string to convert
-    // - [in] buf: the buffer to store the converted string
-    // - [in] bufsize: the size of the destination buffer. When this value is insufficient, the returned string is truncated and null-terminated.
-    // - [out] result: Pointer to store the number of bytes copied
-    status = napi_get_value_string_utf8(env, args[0], NULL, 0, &str_len);
-    // if 'buf' is NULL, and 'bufsize' is 0, the function returns only the length of the string excluding the null terminator in `result`
-    // if 'buf' is provided, it copies the string into the buffer
-    if (status != napi_ok)
-    {
-        napi_throw_error(env, NULL, "Failed to get string length");
-        return NULL;
-        // returns NULL if there is an error in getting the length
-    }
-
-    char *log_path = (char *)malloc(str_len + 1); // allocates memorey for the C string, including space for the null terminator.
-    status = napi_get_value_string_utf8(env, args[0], log_path, str_len + 1, NULL);
-    // args: the JavaScript string to convert
-    // log_path: the pre-allocated buffer to store the converted string
-    // str_len + 1: the size of the destination buffer (log_path)
-    // NULL: the pointer to store the number of bytes copied, which we are not interested in here.
+    // Convert JavaScript string to C string (see marshal.h)
+    PinggyString log_path;
+    status = pinggy_string_from_js(env, args[0], &log_path);
     if (status != napi_ok)
     {
-        free(log_path);
         napi_throw_error(env, NULL, "Failed to get string value");
         return NULL;
     }
 
     // Call the library function
-    pinggy_set_log_path(log_path);
-    free(log_path);
+    pinggy_set_log_path(log_path.data);
+    pinggy_string_release(env, &log_path);
 
     // Return undefined (as the function has no return value)
     napi_get_undefined(env, &result);
@@ -127,6 +104,7 @@ napi_value CreateConfig(napi_env env, napi_callback_info info)
     napi_value result;
     // napi_value: a JavaScript value that will be returned to the calling JS code.
     pinggy_ref_t config_ref = pinggy_create_config();
+    pinggy_ref_own(env, config_ref, PINGGY_REF_CONFIG);
 
     napi_create_uint32(env, config_ref, &result);
     // napi_status napi_create_uint32(napi_env env, uint32_t value, napi_value* result)
@@ -137,189 +115,7 @@ napi_value CreateConfig(napi_env env, napi_callback_info info)
     return result;
 }
 
-// Wrapper for pinggy_config_set_server_address
-napi_value ConfigSetServerAddress(napi_env env, napi_callback_info info)
-{
-    // env: the Node-API environment pointer
-    // info: contains information about the function call including arguments
-
-    size_t argc = 2;    // Number of expected arguments
-    napi_value args[2]; // Array to store the JS arguments
-    napi_value result;  // return value for JS
-
-    // Parse arguments
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    // napi_status napi_get_cb_info(napi_env env,
-    //                          napi_callback_info cbinfo,
-    //                          size_t* argc,
-    //                          napi_value* argv,
-    //                          napi_value* thisArg,
-    //                          void** data)
-    // [in] env: the Node-API environment
-    // [in] cbinfo: the callback info passed into the callback function
-    // [in-out] argc: specifies the length of the provided 'argv' array and receives the actual count of arguments. argc can optionally be ignored by passing NULL
-    // [out] argv: C array of napi_values to which the arguments will be copied. If there are more arguments then the provided count, only the requested no of arguments are copied. If there are fewer arguments provided than claimed, the rest of argv is filled with napi_value vales that represent 'undefined'. 'argv' can also be optionally ignored.
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, server_address)");
-
-    // Get the first argument: config (uint32_t)
-    uint32_t config;
-    napi_get_value_uint32(env, args[0], &config);
-    // napi_status napi_get_value_uint32(napi_env env,
-    //                               napi_value value,
-    //                               uint32_t* result)
-    // [in] env: the Node-API environment
-    // [in] value: the JavaScript number to convert
-    // [out] result: C primitive equivalent of the given napi_value as a uint32_t
-
-    // the conversion is needed because
-    // - In JavaScript, all numbers (whether integer or floating-point) are represented as double-precision floating-point numbers.
-    // - In C, we have distinct types for integers (int, uint32_t, etc.) and floating-point numbers (float, double).
-
-    // Get the second argument: server_address (string)
-    size_t str_len;
-    napi_get_value_string_utf8(env, args[1], NULL, 0, &str_len);
-    // returns only the length of the string excluding the null terminator in `result`
-
-    char *server_address = (char *)malloc(str_len + 1); // Allocate memory for the C string
-    napi_get_value_string_utf8(env, args[1], server_address, str_len + 1, NULL);
-    // copies the string into the buffer
-
-    // Call the pinggy_config_set_server_address function
-    pinggy_config_set_server_address(config, server_address);
-
-    // Free allocated memory
-    free(server_address);
-
-    // Return undefined (as the function has no return value)
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_sni_server_name
-napi_value ConfigSetSniServerName(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_value result;
-
-    // Parse arguments
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-
-    // Validate the number of arguments
-    if (argc < 2)
-    {
-        napi_throw_type_error(env, NULL, "Expected two arguments (config, sni_server_name)");
-        return NULL;
-    }
-
-    // Get the first argument: config (uint32_t)
-    uint32_t config;
-    napi_get_value_uint32(env, args[0], &config);
-    // convert the JS number(which of double tyep) to C uint32_t
-
-    // Get the second argument: sni_server_name (string)
-    size_t str_read;
-    char sni_server_name[512]; // Buffer for the SNI server name
-    napi_get_value_string_utf8(env, args[1], sni_server_name, sizeof(sni_server_name), &str_read);
-    // convert the JS string to C string
-
-    // Call the pinggy_config_set_sni_server_name function
-    pinggy_config_set_sni_server_name(config, sni_server_name);
-
-    // Return undefined (void return type in C)
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_advanced_parsing
-napi_value ConfigSetAdvancedParsing(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;    // two arguments expected
-    napi_value args[2]; // array to store the arguments
-    napi_value result;  // return value to JS
-
-    // Parse arguments
-    napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    // napi_status napi_get_cb_info(napi_env env,
-    //                          napi_callback_info cbinfo,
-    //                          size_t* argc,
-    //                          napi_value* argv,
-    //                          napi_value* this_arg,
-    //                          void** data)
-    // [in] env: the Node-API environment
-    // [in] cbinfo: the callback info passed into the callback function
-    // [in-out] argc: specifies number of expected parameters and recieves the actual count of arguments. argc can optionally be ignored by passing NULL
-    // [out] argv: C array of napi_values to which the arguments will be copied. If there are more arguments than the provided count, only the requested no of arguments are copied. If ther are fewer arguments provided than claimed, the rest of argv is filled with napi_value values that represent 'undefined'. 'argv' can also be optionally ignored.
-    // [out] NULL: thisArg, the JavaScript 'this' argument for the call. Ignored in this case by passing NULL
-    // [out] NULL: the pointer to store the number of bytes copied, which we are not interested in here.
-
-    // Validate the number of arguments
-    if (argc < 2)
-    {
-        napi_throw_type_error(env, NULL, "Expected two arguments (config, advanced_parsing)");
-        return NULL;
-    }
-
-    // Get the first argument: config (uint32_t)
-    uint32_t config;
-    napi_get_value_uint32(env, args[0], &config);
-    // convert the JS number(which of double type) to C uint32_t
-
-    // Get the second argument: advanced_parsing (boolean)
-    bool advanced_parsing;
-    napi_get_value_bool(env, args[1], &advanced_parsing);
-    // convert the JS boolean to C bool
-
-    // Call the pinggy_config_set_advanced_parsing function
-    pinggy_config_set_advanced_parsing(config, advanced_parsing);
-
-    // Return undefined (void return type in C)
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-napi_value ConfigSetToken(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, token)");
-
-    // Get the first argument: config (uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Get the second argument: token (string)
-    size_t token_length;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &token_length);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid token argument");
-
-    pinggy_char_p_t token = malloc(token_length + 1);
-    NAPI_CHECK_CONDITION_THROW(env, token != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], token, token_length + 1, &token_length);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to get token string");
-
-    // Call the pinggy_config_set_token function
-    pinggy_config_set_token(config, token);
-
-    free(token);
-
-    // Return undefined
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
+// Wrapper for pinggy_config_add_forwarding_simple
 napi_value ConfigAddForwardingSimple(napi_env env, napi_callback_info info)
 {
     size_t argc = 2;
@@ -339,21 +135,13 @@ napi_value ConfigAddForwardingSimple(napi_env env, napi_callback_info info)
     NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
 
     // Get the second argument: forward_to (string)
-    size_t forward_to_length;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &forward_to_length);
+    PinggyString forward_to;
+    status = pinggy_string_from_js(env, args[1], &forward_to);
     NAPI_CHECK_STATUS_THROW(env, status, "Invalid forward_to argument");
 
-    pinggy_char_p_t forward_to = malloc(forward_to_length + 1);
-    NAPI_CHECK_CONDITION_RETURN(env, forward_to != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], forward_to, forward_to_length + 1, &forward_to_length);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get forward_to string", free(forward_to));
-
     // Call the pinggy_config_add_forwarding_simple function
-    pinggy_config_add_forwarding_simple(config, forward_to);
-
-    // Free allocated memory
-    free(forward_to);
+    pinggy_config_add_forwarding_simple(config, forward_to.data);
+    pinggy_string_release(env, &forward_to);
 
     // Return undefined (as the C function returns void)
     napi_value result;
@@ -379,41 +167,31 @@ napi_value ConfigAddForwarding(napi_env env, napi_callback_info info)
     NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
 
     // Get the second argument: forwarding_type (string) Example: "http", "tcp", "udp", "tls", "tlstcp".
-    size_t forwarding_type_length;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &forwarding_type_length);
+    PinggyString forwarding_type;
+    status = pinggy_string_from_js(env, args[1], &forwarding_type);
     NAPI_CHECK_STATUS_THROW(env, status, "Invalid forwarding_type argument");
 
-    pinggy_char_p_t forwarding_type = malloc(forwarding_type_length + 1);
-    NAPI_CHECK_CONDITION_THROW(env, forwarding_type != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], forwarding_type, forwarding_type_length + 1, &forwarding_type_length);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get forwarding_type string", free(forwarding_type));
     // Get the third argument: binding_url (string)  Examples: "example.pinggy.io", "example.pinggy.io:8080", ":80".
-    size_t binding_url_length;
-    status = napi_get_value_string_utf8(env, args[2], NULL, 0, &binding_url_length);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid binding_url argument");
-
-    pinggy_char_p_t binding_url = malloc(binding_url_length + 1);
-    NAPI_CHECK_CONDITION_THROW(env, binding_url != NULL, "Memory allocation failed");
-    status = napi_get_value_string_utf8(env, args[2], binding_url, binding_url_length + 1, &binding_url_length);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get binding_url string", free(binding_url));
+    PinggyString binding_url;
+    status = pinggy_string_from_js(env, args[2], &binding_url);
+    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Invalid binding_url argument", pinggy_string_release(env, &forwarding_type));
 
     // Get the 4th argument: forward_to (string) Examples: "http://localhost:3000"), an IP address (e.g., "127.0.0.1:8000"), or just a port (e.g., ":5000").
-    size_t forward_to_length;
-    status = napi_get_value_string_utf8(env, args[3], NULL, 0, &forward_to_length);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid forward_to argument");
-
-    pinggy_char_p_t forward_to = malloc(forward_to_length + 1);
-    NAPI_CHECK_CONDITION_THROW(env, forward_to != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[3], forward_to, forward_to_length + 1, &forward_to_length);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get forward_to string", free(forward_to));
+    PinggyString forward_to;
+    status = pinggy_string_from_js(env, args[3], &forward_to);
+    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Invalid forward_to argument",
+                                    {
+                                        pinggy_string_release(env, &binding_url);
+                                        pinggy_string_release(env, &forwarding_type);
+                                    });
 
     // Call the pinggy_config_add_forwarding function
-    pinggy_config_add_forwarding(config, forwarding_type, binding_url, forward_to);
+    pinggy_config_add_forwarding(config, forwarding_type.data, binding_url.data, forward_to.data);
 
-    // Free allocated memory
-    free(forward_to);
+    // Release in reverse order of reading
+    pinggy_string_release(env, &forward_to);
+    pinggy_string_release(env, &binding_url);
+    pinggy_string_release(env, &forwarding_type);
 
     // Return undefined (as the C function returns void)
     napi_value result;
@@ -421,10 +199,11 @@ napi_value ConfigAddForwarding(napi_env env, napi_callback_info info)
     return result;
 }
 
-napi_value ConfigSetForce(napi_env env, napi_callback_info info)
+// Wrapper for pinggy_config_reset_forwardings
+napi_value ConfigResetForwardings(napi_env env, napi_callback_info info)
 {
-    size_t argc = 2;
-    napi_value args[2];
+    size_t argc = 1;
+    napi_value args[1];
     napi_status status;
 
     // Parse arguments
@@ -432,20 +211,15 @@ napi_value ConfigSetForce(napi_env env, napi_callback_info info)
     NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
 
     // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, force)");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
 
     // Get the first argument: config (pinggy_ref_t / uint32_t)
     pinggy_ref_t config;
     status = napi_get_value_uint32(env, args[0], &config);
     NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
 
-    // Get the second argument: force (pinggy_bool_t / uint8_t)
-    bool force;
-    status = napi_get_value_bool(env, args[1], &force);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid force argument");
-
-    // Call the pinggy_config_set_force function
-    pinggy_config_set_force(config, (pinggy_bool_t)force);
+    // Call the pinggy_config_reset_forwardings function
+    pinggy_config_reset_forwardings(config);
 
     // Return undefined (as the C function returns void)
     napi_value result;
@@ -453,1739 +227,596 @@ napi_value ConfigSetForce(napi_env env, napi_callback_info info)
     return result;
 }
 
-napi_value ConfigSetArgument(napi_env env, napi_callback_info info)
+// N-API wrapper for pinggy_version
+napi_value GetPinggyVersion(napi_env env, napi_callback_info info)
 {
-    size_t argc = 2;
-    napi_value args[2];
     napi_status status;
+    napi_value result;
+    // No arguments needed
+    size_t buffer_len = 128; // Should be enough for version string
+    char buffer[128];
 
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    // Call the macro-based function
+    pinggy_const_int_t len = pinggy_version(buffer_len, buffer);
+    NAPI_CHECK_CONDITION_RETURN(env, len >= 0, "Failed to get Pinggy version");
+    status = napi_create_string_utf8(env, buffer, len, &result);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create version string");
+    return result;
+}
 
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, argument)");
+// Accessors generated from config_fields.h. Every field of one kind shares
+// a single setter and getter callback; the JS function created for a field
+// carries its descriptor as callback data.
 
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
+// Leads every descriptor, so a generated callback can report errors before
+// it knows the field's kind.
+typedef struct ConfigFieldNames
+{
+    const char *key;
+    const char *label;
+    const char *setter;
+    const char *getter;
+} ConfigFieldNames;
 
-    // Get the second argument: argument (string)
-    size_t argument_length;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &argument_length);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid argument");
+typedef struct ConfigStringField
+{
+    ConfigFieldNames names;
+    int flags;
+    pinggy_void_t (*set)(pinggy_ref_t, pinggy_const_char_p_t);
+    PinggyStringGetter get;
+} ConfigStringField;
 
-    // Allocate memory for the argument string
-    pinggy_char_p_t argument = malloc(argument_length + 1);
-    NAPI_CHECK_CONDITION_THROW(env, argument != NULL, "Memory allocation failed");
+typedef struct ConfigBoolField
+{
+    ConfigFieldNames names;
+    pinggy_void_t (*set)(pinggy_ref_t, pinggy_bool_t);
+    pinggy_bool_t (*get)(pinggy_ref_t);
+} ConfigBoolField;
 
-    status = napi_get_value_string_utf8(env, args[1], argument, argument_length + 1, &argument_length);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get argument string", free(argument));
+typedef struct ConfigUint16Field
+{
+    ConfigFieldNames names;
+    pinggy_void_t (*set)(pinggy_ref_t, pinggy_uint16_t);
+    pinggy_uint16_t (*get)(pinggy_ref_t);
+} ConfigUint16Field;
 
-    // Call the pinggy_config_set_argument function
-    pinggy_config_set_argument(config, argument);
+// Some string setters are declared with a non-const pointer they never write
+// through; these adapters give all of them the same signature.
+#define X(field, key, label, setter, getter, flags)                                       \
+    static pinggy_void_t config_set_##field(pinggy_ref_t config, pinggy_const_char_p_t value) \
+    {                                                                                     \
+        pinggy_config_set_##field(config, (pinggy_char_p_t)value);                        \
+    }
+PINGGY_CONFIG_STRING_FIELDS(X)
+#undef X
+
+static const ConfigStringField g_string_fields[] = {
+#define X(field, key, label, setter, getter, flags) \
+    {{key, label, setter, getter}, flags, config_set_##field, pinggy_config_get_##field##_len},
+    PINGGY_CONFIG_STRING_FIELDS(X)
+#undef X
+};
+
+static const ConfigBoolField g_bool_fields[] = {
+#define X(field, key, label, setter, getter) \
+    {{key, label, setter, getter}, pinggy_config_set_##field, pinggy_config_get_##field},
+    PINGGY_CONFIG_BOOL_FIELDS(X)
+#undef X
+};
+
+static const ConfigUint16Field g_uint16_fields[] = {
+#define X(field, key, label, setter, getter) \
+    {{key, label, setter, getter}, pinggy_config_set_##field, pinggy_config_get_##field},
+    PINGGY_CONFIG_UINT16_FIELDS(X)
+#undef X
+};
+
+#define CONFIG_FIELD_COUNT(table) (sizeof(table) / sizeof((table)[0]))
+
+// Throws an error whose message names the field, e.g. "Invalid token argument".
+static napi_value config_field_throw(napi_env env, const char *format, const char *label)
+{
+    char message[200];
+    snprintf(message, sizeof(message), format, label);
+    NAPI_THROW_ERROR(env, message);
+}
+
+// Parses (config) or (config, value) for a generated accessor. On failure an
+// error is pending and 0 is returned.
+static int config_field_args(napi_env env, napi_callback_info info, size_t expected, napi_value *args,
+                             pinggy_ref_t *config, void **field)
+{
+    size_t argc = expected;
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, field);
+    if (status != napi_ok || *field == NULL)
+    {
+        napi_throw_error(env, NULL, "Failed to parse arguments");
+        return 0;
+    }
+    if (argc < expected)
+    {
+        const ConfigFieldNames *names = (const ConfigFieldNames *)*field;
+        if (expected == 1)
+        {
+            napi_throw_error(env, NULL, "Expected one argument (config)");
+        }
+        else
+        {
+            config_field_throw(env, "Expected two arguments (config, %s)", names->label);
+        }
+        return 0;
+    }
+    status = napi_get_value_uint32(env, args[0], config);
+    if (status != napi_ok)
+    {
+        napi_throw_error(env, NULL, "Invalid config argument");
+        return 0;
+    }
+    return 1;
+}
 
-    // Free allocated memory
-    free(argument);
+static napi_value ConfigStringSet(napi_env env, napi_callback_info info)
+{
+    napi_value args[2];
+    pinggy_ref_t config;
+    void *data = NULL;
+    if (!config_field_args(env, info, 2, args, &config, &data))
+    {
+        return NULL;
+    }
+    const ConfigStringField *field = (const ConfigStringField *)data;
+
+    PinggyString value;
+    napi_status status = pinggy_string_from_js(env, args[1], &value);
+    if (status != napi_ok)
+    {
+        return config_field_throw(env, status == napi_string_expected ? "Invalid %s argument" : "Failed to get %s string",
+                                  field->names.label);
+    }
+    field->set(config, value.data);
+    pinggy_string_release(env, &value);
 
-    // Return undefined (as the C function returns void)
     napi_value result;
     napi_get_undefined(env, &result);
     return result;
 }
 
-napi_value ConfigSetSSL(napi_env env, napi_callback_info info)
+static napi_value ConfigStringGet(napi_env env, napi_callback_info info)
 {
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, ssl)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
+    napi_value args[1];
     pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Get the second argument: ssl (pinggy_bool_t / uint8_t)
-    bool ssl;
-    status = napi_get_value_bool(env, args[1], &ssl);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid ssl argument");
-
-    // Call the pinggy_config_set_ssl function
-    pinggy_config_set_ssl(config, (pinggy_bool_t)ssl);
+    void *data = NULL;
+    if (!config_field_args(env, info, 1, args, &config, &data))
+    {
+        return NULL;
+    }
+    const ConfigStringField *field = (const ConfigStringField *)data;
 
-    // Return undefined (since the function returns void)
+    PinggyString value;
+    if (pinggy_string_from_native(env, config, field->get, &value) < 0)
+    {
+        return config_field_throw(env, "Failed to get %s", field->names.label);
+    }
+    if (value.length == 0 && !(field->flags & PINGGY_CONFIG_FIELD_EMPTY_OK))
+    {
+        pinggy_string_release(env, &value);
+        return config_field_throw(env, "Failed to get required length for %s", field->names.label);
+    }
     napi_value result;
-    napi_get_undefined(env, &result);
+    napi_status status = pinggy_string_to_js(env, &value, &result);
+    pinggy_string_release(env, &value);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create string");
     return result;
 }
 
-napi_value ConfigSetInsecure(napi_env env, napi_callback_info info)
+static napi_value ConfigBoolSet(napi_env env, napi_callback_info info)
 {
-    size_t argc = 2;
     napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, insecure)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
     pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Get the second argument: insecure (pinggy_bool_t / uint8_t)
-    bool insecure;
-    status = napi_get_value_bool(env, args[1], &insecure);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid insecure argument");
+    void *data = NULL;
+    if (!config_field_args(env, info, 2, args, &config, &data))
+    {
+        return NULL;
+    }
+    const ConfigBoolField *field = (const ConfigBoolField *)data;
 
-    // Call the pinggy_config_set_insecure function
-    pinggy_config_set_insecure(config, (pinggy_bool_t)insecure);
+    bool value;
+    if (napi_get_value_bool(env, args[1], &value) != napi_ok)
+    {
+        return config_field_throw(env, "Invalid %s argument", field->names.label);
+    }
+    field->set(config, (pinggy_bool_t)value);
 
-    // Return undefined (since the function returns void)
     napi_value result;
     napi_get_undefined(env, &result);
     return result;
 }
 
-// Wrapper for pinggy_config_get_server_address
-napi_value ConfigGetServerAddress(napi_env env, napi_callback_info info)
+static napi_value ConfigBoolGet(napi_env env, napi_callback_info info)
 {
-    // env: the Node-API environment pointer
-    // info: contains information about the function call including arguments
-
-    size_t argc = 1;    // Number of expected arguments
-    napi_value args[1]; // Array to store the JS arguments (passed to cb_info function)
-    napi_status status; // return value for JS
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    // napi_status napi_get_cb_info(napi_env env,
-    //                          napi_callback_info cbinfo,
-    //                          size_t* argc,
-    //                          napi_value* argv,
-    //                          napi_value* thisArg,
-    //                          void** data)
-    // [in] env: the Node-API environment
-    // [in] cbinfo: the callback info passed into the callback function
-    // [in-out] argc: specifies number of expected parameters and receives the actual count of arguments. argc can optionally be ignored by passing NULL
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
+    napi_value args[1];
+    pinggy_ref_t config;
+    void *data = NULL;
+    if (!config_field_args(env, info, 1, args, &config, &data))
+    {
+        return NULL;
+    }
+    const ConfigBoolField *field = (const ConfigBoolField *)data;
 
-    // Get the first argument: config (uint32_t)
-    uint32_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    // napi_status napi_get_value_uint32(napi_env env,
-    //                               napi_value value,
-    //                               uint32_t* result)
-    // [in] env: the Node-API environment
-    // [in] value: the JavaScript number to convert, received as the first argument
-    // [out] result: C primitive equivalent of the given napi_value as a uint32_t, since JS numbers are to double type
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-    // Allocate buffer for the server address
-    pinggy_capa_t buffer_len = 0; // Example buffer length
-    pinggy_const_int_t rc = pinggy_config_get_server_address_len(config, 0, NULL, &buffer_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0 && buffer_len > 0, "Failed to get required length for server address");
-    // Allocate a buffer of the required length
-    pinggy_char_p_t buffer = malloc(buffer_len + 1); // +1 for null terminator
-    NAPI_CHECK_CONDITION_THROW(env, buffer != NULL, "Memory allocation failed");
-
-    // Call the pinggy_config_get_server_address function
-    int copied_len = pinggy_config_get_server_address(config, buffer_len + 1, buffer);
-    // get the length from the JS function preferabbly as a parameter
-
-    // Handle errors (if the copied length is negative, assuming it indicates an error)
-    NAPI_CHECK_CONDITION_THROW(env, copied_len >= 0, "Failed to get server address");
     napi_value result;
-    // Convert the buffer to a JavaScript string
-    status = napi_create_string_utf8(env, buffer, copied_len, &result);
-    // napi_status napi_create_string_utf8(napi_env env,
-    //                                  const char* str,
-    //                                  size_t length,
-    //                                  napi_value* result)
-    // [in] env: the Node-API environment
-    // [in] str: Character buffer representing a UTF-8 encoded string
-    // [in] length: the length of the string in bytes, or NAPI_AUTO_LENGTH if the string is null-terminated
-    // [out] result: the JavaScript string value
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create string");
-    free(buffer); // Free the allocated buffer
-
+    napi_status status = napi_get_boolean(env, field->get(config) != 0, &result);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create boolean");
     return result;
 }
 
-// Wrapper for pinggy_config_get_sni_server_name
-napi_value ConfigGetSniServerName(napi_env env, napi_callback_info info)
+static napi_value ConfigUint16Set(napi_env env, napi_callback_info info)
 {
-    // env: the Node-API environment pointer
-    // info: contains information about the function call including arguments
-
-    size_t argc = 1;    // Number of expected arguments
-    napi_value args[1]; // Array to store the JS arguments (passed to cb_info function)
-    napi_status status; // return value for JS
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    // [in] env: the Node-api environment
-    // [in] info: the callback info passed into the callback function
-    // [in-out] argc: specifies number of expected parameters and recieves the actual count of arguments. argc can optionally be ignored by passing NULL
-    // [out] args: C array of napi_values to which the arguments will be copied. If there are more arguments than the provided count, only the requested no of arguments are copied. If ther are fewer arguments provided than claimed, the rest of args is filled with napi_value values that represent 'undefined'. 'args' can also be optionally ignored.
-    // [out] NULL: thisArg, the JavaScript 'this' argument for the call. Ignored in this case by passing NULL
-    // [out] NULL: the pointer to store the number of bytes copied, which we are not interested in here.
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
+    napi_value args[2];
+    pinggy_ref_t config;
+    void *data = NULL;
+    if (!config_field_args(env, info, 2, args, &config, &data))
+    {
+        return NULL;
+    }
+    const ConfigUint16Field *field = (const ConfigUint16Field *)data;
 
-    // Get the first argument: config (uint32_t)
-    uint32_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
+    uint32_t value;
+    if (napi_get_value_uint32(env, args[1], &value) != napi_ok)
+    {
+        return config_field_throw(env, "Invalid %s argument", field->names.label);
+    }
+    field->set(config, (pinggy_uint16_t)value);
 
-    // Allocate buffer for the SNI server name
-    pinggy_capa_t required_len = 0;
-    pinggy_const_int_t rc = pinggy_config_get_sni_server_name_len(config, 0, NULL, &required_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0 && required_len > 0, "Failed to get required length for SNI server name");
-    pinggy_char_p_t buffer = malloc(required_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, buffer != NULL, "Memory allocation failed");
-    // Call the pinggy_config_get_sni_server_name function
-    int copied_len = pinggy_config_get_sni_server_name(config, required_len + 1, buffer);
-
-    // Handle errors (if the copied length is negative, assuming it indicates an error)
-    NAPI_CHECK_CONDITION_THROW(env, copied_len >= 0, "Failed to get SNI server name");
     napi_value result;
-    // Convert the buffer to a JavaScript string
-    status = napi_create_string_utf8(env, buffer, copied_len, &result);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create string");
-    free(buffer); // Free the allocated buffer
-
+    napi_get_undefined(env, &result);
     return result;
 }
 
-// Wrapper for pinggy_config_get_advanced_parsing
-napi_value ConfigGetAdvancedParsing(napi_env env, napi_callback_info info)
+static napi_value ConfigUint16Get(napi_env env, napi_callback_info info)
 {
-    size_t argc = 1;
     napi_value args[1];
+    pinggy_ref_t config;
+    void *data = NULL;
+    if (!config_field_args(env, info, 1, args, &config, &data))
+    {
+        return NULL;
+    }
+    const ConfigUint16Field *field = (const ConfigUint16Field *)data;
+
     napi_value result;
-    napi_status status;
+    napi_status status = napi_create_uint32(env, (uint32_t)field->get(config), &result);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create result");
+    return result;
+}
 
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-    // Get the first argument: config (uint32_t)
-    uint32_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the pinggy_config_get_advanced_parsing function
-    pinggy_bool_t advanced_parsing = pinggy_config_get_advanced_parsing(config);
+// The fields of all three kinds as one list: boolean fields, then uint16,
+// then strings. configFieldKeys exports their keys in this order.
 
-    // Return the boolean value (advanced_parsing) as a JavaScript boolean
-    status = napi_get_boolean(env, advanced_parsing, &result);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create boolean");
-    return result;
-}
-
-napi_value ConfigGetToken(napi_env env, napi_callback_info info)
+typedef enum ConfigFieldKind
 {
-    size_t argc = 1;    // Number of expected arguments
-    napi_value args[1]; // Array to store the JS arguments (passed to cb_info function)
-    napi_value result;  // return value for JS
-    napi_status status; // return value for JS
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    CONFIG_FIELD_BOOL,
+    CONFIG_FIELD_UINT16,
+    CONFIG_FIELD_STRING,
+} ConfigFieldKind;
 
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (uint32_t)
-    uint32_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Allocate buffer for the token
-    pinggy_capa_t required_len = 0; // Example buffer length
-    pinggy_const_int_t rc = pinggy_config_get_token_len(config, 0, NULL, &required_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0, "Failed to get required length for token");
+#define CONFIG_FIELD_TOTAL \
+    (CONFIG_FIELD_COUNT(g_bool_fields) + CONFIG_FIELD_COUNT(g_uint16_fields) + CONFIG_FIELD_COUNT(g_string_fields))
 
-    if (required_len == 0)
+// Descriptor of the field at `position` of configFieldKeys.
+static const ConfigFieldNames *config_field_at(size_t position, ConfigFieldKind *kind)
+{
+    if (position < CONFIG_FIELD_COUNT(g_bool_fields))
     {
-        // If the required length is 0, return an empty string
-        status = napi_create_string_utf8(env, "", NAPI_AUTO_LENGTH, &result);
-        return result;
+        *kind = CONFIG_FIELD_BOOL;
+        return &g_bool_fields[position].names;
+    }
+    position -= CONFIG_FIELD_COUNT(g_bool_fields);
+    if (position < CONFIG_FIELD_COUNT(g_uint16_fields))
+    {
+        *kind = CONFIG_FIELD_UINT16;
+        return &g_uint16_fields[position].names;
+    }
+    position -= CONFIG_FIELD_COUNT(g_uint16_fields);
+    *kind = CONFIG_FIELD_STRING;
+    return &g_string_fields[position].names;
+}
+
+// configApply(config, field, value, field, value, ...): sets any number of
+// fields in one call. Each field is given by its index in configFieldKeys,
+// so nothing has to be looked up by name here. Fields are set in argument
+// order; pairs with an undefined or null value are skipped.
+//
+// Stops at the first setter that makes libpinggy raise, returning that
+// field's key with the exception left for getLastException. Returns
+// undefined once every field is set.
+
+// Sets one field from `value`. Returns 0 if `value` is undefined or null
+// and the field was left alone, -1 with an error pending if it has the
+// wrong type.
+static int config_apply_field(napi_env env, pinggy_ref_t config, const ConfigFieldNames *names, ConfigFieldKind kind,
+                              napi_value value)
+{
+    // The value is converted first and its type only looked at when that
+    // fails, saving a call per field.
+    switch (kind)
+    {
+    case CONFIG_FIELD_BOOL:
+    {
+        bool flag;
+        if (napi_get_value_bool(env, value, &flag) != napi_ok)
+        {
+            break;
+        }
+        ((const ConfigBoolField *)names)->set(config, (pinggy_bool_t)flag);
+        return 1;
+    }
+    case CONFIG_FIELD_UINT16:
+    {
+        uint32_t number;
+        if (napi_get_value_uint32(env, value, &number) != napi_ok)
+        {
+            break;
+        }
+        ((const ConfigUint16Field *)names)->set(config, (pinggy_uint16_t)number);
+        return 1;
+    }
+    case CONFIG_FIELD_STRING:
+    {
+        PinggyString str;
+        if (pinggy_string_from_js(env, value, &str) != napi_ok)
+        {
+            break;
+        }
+        ((const ConfigStringField *)names)->set(config, str.data);
+        pinggy_string_release(env, &str);
+        return 1;
+    }
     }
-    pinggy_char_p_t buffer = malloc(required_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, buffer != NULL, "Memory allocation failed");
-
-    // Call the pinggy_config_get_token function
-    pinggy_const_int_t copied_len = pinggy_config_get_token(config, required_len + 1, buffer);
-
-    // Handle errors (if the copied length is negative, assuming it indicates an error)
-    NAPI_CHECK_CONDITION_THROW(env, copied_len >= 0, "Failed to get token");
-
-    // Convert the buffer to a JavaScript string
-    status = napi_create_string_utf8(env, buffer, copied_len, &result);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to create string", free(buffer));
-
-    free(buffer);
-    return result;
-}
-
-napi_value ConfigGetForwardings(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_CONDITION_THROW(env, status == napi_ok, "Invalid config argument");
-
-    pinggy_capa_t required_len = 0;
-    pinggy_const_int_t rc = pinggy_config_get_forwardings_len(config, 0, NULL, &required_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0 && required_len > 0, "Failed to get required length for forwarding_rules");
-
-    // Create a buffer to hold the forwarding rules
-    pinggy_char_p_t forwarding_rules = malloc(required_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, forwarding_rules != NULL, "Memory allocation failed");
-
-    // Call the pinggy function to Retrieves the forwarding rules (as a JSON string) from the tunnel config.
-    pinggy_const_int_t copied_length = pinggy_config_get_forwardings(config, required_len + 1, forwarding_rules);
-    NAPI_CHECK_CONDITION_THROW(env, copied_length >= 0, "Failed to get forwarding_rules");
-    // Return the forwarding_rules as a JavaScript string
-    napi_value result;
-    status = napi_create_string_utf8(env, forwarding_rules, copied_length, &result);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to create string from forwarding_rules", free(forwarding_rules));
-
-    // Free the allocated memory for udp_forward_to
-    free(forwarding_rules);
-
-    return result;
-}
-
-napi_value ConfigGetForce(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the pinggy function to get the force status
-    pinggy_const_bool_t force = pinggy_config_get_force(config);
-
-    // Return the force status as a JavaScript boolean
-    napi_value result;
-    status = napi_get_boolean(env, force, &result);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create boolean");
 
-    return result;
+    napi_valuetype type;
+    if (napi_typeof(env, value, &type) == napi_ok && (type == napi_undefined || type == napi_null))
+    {
+        return 0;
+    }
+    config_field_throw(env, "Invalid %s option", names->key);
+    return -1;
 }
 
-napi_value ConfigGetArgument(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Determine buffer size (assuming a reasonable buffer length for now)
-    pinggy_capa_t buffer_len = 1024; // You can make this dynamic based on your use case
-
-    // Allocate buffer
-    pinggy_char_p_t buffer = malloc(buffer_len);
-    NAPI_CHECK_CONDITION_THROW(env, buffer != NULL, "Memory allocation failed");
-
-    // Call the pinggy function to get the argument
-    pinggy_const_int_t length = pinggy_config_get_argument(config, buffer_len, buffer);
-
-    // If length is 0, return undefined as no argument was retrieved
-    NAPI_CHECK_CONDITION_RETURN_UNDEFINED_AND_CLEANUP(env, length >= 0, free(buffer));
-
-    // Create JavaScript string from the buffer
-    napi_value result;
-    status = napi_create_string_utf8(env, buffer, length, &result);
-    free(buffer); // Free buffer after usage
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create string from argument");
-
-    return result;
-}
+// Room for every field once; repeating a field gains nothing.
+#define CONFIG_APPLY_MAX_ARGS (1 + 2 * CONFIG_FIELD_TOTAL)
 
-napi_value ConfigGetSsl(napi_env env, napi_callback_info info)
+static napi_value ConfigApply(napi_env env, napi_callback_info info)
 {
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    size_t argc = CONFIG_APPLY_MAX_ARGS;
+    napi_value args[CONFIG_APPLY_MAX_ARGS];
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
     NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1 && argc % 2 == 1, "Expected arguments (config, field, value, ...)");
+    // argc counts every argument passed, not just those copied to args.
+    NAPI_CHECK_CONDITION_THROW(env, argc <= CONFIG_APPLY_MAX_ARGS, "Too many config fields");
 
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
     pinggy_ref_t config;
     status = napi_get_value_uint32(env, args[0], &config);
     NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
 
-    // Call the pinggy_config_get_ssl function
-    pinggy_bool_t ssl_enabled = pinggy_config_get_ssl(config);
+    uint32_t raised = pinggy_exception_raised();
+    for (size_t i = 1; i < argc; i += 2)
+    {
+        uint32_t position;
+        status = napi_get_value_uint32(env, args[i], &position);
+        NAPI_CHECK_CONDITION_THROW(env, status == napi_ok && position < CONFIG_FIELD_TOTAL, "Invalid config field");
+
+        ConfigFieldKind kind;
+        const ConfigFieldNames *names = config_field_at(position, &kind);
+        int set = config_apply_field(env, config, names, kind, args[i + 1]);
+        if (set < 0)
+        {
+            return NULL;
+        }
+        if (set > 0 && pinggy_exception_raised() != raised)
+        {
+            napi_value failed;
+            status = napi_create_string_utf8(env, names->key, NAPI_AUTO_LENGTH, &failed);
+            NAPI_CHECK_STATUS_THROW(env, status, "Failed to create string");
+            return failed;
+        }
+    }
 
-    // Return the boolean value (ssl_enabled) as a JavaScript boolean
     napi_value result;
-    napi_get_boolean(env, ssl_enabled, &result);
+    napi_get_undefined(env, &result);
     return result;
 }
 
-napi_value ConfigGetInsecure(napi_env env, napi_callback_info info)
+// configSnapshot(config): every field in one object, keyed like
+// configFieldKeys. String fields are returned as libpinggy gives them (JSON
+// text for the list fields), or null if they cannot be read.
+static napi_value ConfigSnapshot(napi_env env, napi_callback_info info)
 {
     size_t argc = 1;
     napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
     NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
     NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
 
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
     pinggy_ref_t config;
     status = napi_get_value_uint32(env, args[0], &config);
     NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
 
-    // Call the pinggy_config_get_insecure function
-    pinggy_bool_t insecure_enabled = pinggy_config_get_insecure(config);
-
-    // Return the boolean value (insecure_enabled) as a JavaScript boolean
-    napi_value result;
-    napi_get_boolean(env, insecure_enabled, &result);
-    return result;
-}
+    // Defined all at once rather than one napi_set_named_property per field.
+    napi_property_descriptor properties[CONFIG_FIELD_TOTAL];
+    for (size_t i = 0; i < CONFIG_FIELD_TOTAL; i++)
+    {
+        ConfigFieldKind kind;
+        const ConfigFieldNames *names = config_field_at(i, &kind);
+        napi_value value = NULL;
+        switch (kind)
+        {
+        case CONFIG_FIELD_BOOL:
+            status = napi_get_boolean(env, ((const ConfigBoolField *)names)->get(config) != 0, &value);
+            break;
+        case CONFIG_FIELD_UINT16:
+            status = napi_create_uint32(env, (uint32_t)((const ConfigUint16Field *)names)->get(config), &value);
+            break;
+        case CONFIG_FIELD_STRING:
+        {
+            PinggyString str;
+            if (pinggy_string_from_native(env, config, ((const ConfigStringField *)names)->get, &str) < 0)
+            {
+                status = napi_get_null(env, &value);
+                break;
+            }
+            status = pinggy_string_to_js(env, &str, &value);
+            pinggy_string_release(env, &str);
+            break;
+        }
+        }
+        NAPI_CHECK_STATUS_THROW(env, status, "Failed to create value");
+        properties[i] = (napi_property_descriptor){names->key, NULL, NULL, NULL, NULL, value, napi_default_jsproperty, NULL};
+    }
 
-// N-API wrapper for pinggy_version
-napi_value GetPinggyVersion(napi_env env, napi_callback_info info)
-{
-    napi_status status;
     napi_value result;
-    // No arguments needed
-    size_t buffer_len = 128; // Should be enough for version string
-    char buffer[128];
-
-    // Call the macro-based function
-    pinggy_const_int_t len = pinggy_version(buffer_len, buffer);
-    NAPI_CHECK_CONDITION_RETURN(env, len >= 0, "Failed to get Pinggy version");
-    status = napi_create_string_utf8(env, buffer, len, &result);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create version string");
+    status = napi_create_object(env, &result);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create object");
+    status = napi_define_properties(env, result, CONFIG_FIELD_TOTAL, properties);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to set snapshot fields");
     return result;
 }
 
-// Wrapper for pinggy_config_set_https_only
-napi_value ConfigSetHttpsOnly(napi_env env, napi_callback_info info)
+// Copies one field from `source` to `target`. Empty and unreadable strings
+// are left at the new config's default.
+static void config_copy_field(napi_env env, pinggy_ref_t source, pinggy_ref_t target, const ConfigFieldNames *names,
+                              ConfigFieldKind kind)
 {
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, https_only)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Get the second argument: https_only (pinggy_bool_t / bool)
-    bool https_only;
-    status = napi_get_value_bool(env, args[1], &https_only);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid https_only argument");
-
-    // Call the pinggy_config_set_https_only function
-    pinggy_config_set_https_only(config, (pinggy_bool_t)https_only);
-
-    // Return undefined
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
+    switch (kind)
+    {
+    case CONFIG_FIELD_BOOL:
+    {
+        const ConfigBoolField *field = (const ConfigBoolField *)names;
+        field->set(target, field->get(source));
+        break;
+    }
+    case CONFIG_FIELD_UINT16:
+    {
+        const ConfigUint16Field *field = (const ConfigUint16Field *)names;
+        field->set(target, field->get(source));
+        break;
+    }
+    case CONFIG_FIELD_STRING:
+    {
+        const ConfigStringField *field = (const ConfigStringField *)names;
+        PinggyString str;
+        if (pinggy_string_from_native(env, source, field->get, &str) < 0)
+        {
+            break;
+        }
+        if (str.length > 0)
+        {
+            field->set(target, str.data);
+        }
+        pinggy_string_release(env, &str);
+        break;
+    }
+    }
 }
 
-// Wrapper for pinggy_config_get_https_only
-napi_value ConfigGetHttpsOnly(napi_env env, napi_callback_info info)
+// configClone(config): a new config, owned by the calling env, holding a
+// copy of every field of `config`. The source is only read, so one config
+// may be cloned by several workers at once.
+//
+// Returns the new ref, with any exception a setter raised left for
+// getLastException.
+static napi_value ConfigClone(napi_env env, napi_callback_info info)
 {
     size_t argc = 1;
     napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
     NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
     NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
 
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the pinggy_config_get_https_only function
-    pinggy_bool_t https_only = pinggy_config_get_https_only(config);
-
-    // Return the boolean value as a JavaScript boolean
-    napi_value result;
-    napi_get_boolean(env, https_only, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_allow_preflight
-napi_value ConfigSetAllowPreflight(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, allow_preflight)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
+    pinggy_ref_t source;
+    status = napi_get_value_uint32(env, args[0], &source);
     NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
 
-    // Get the second argument: allow_preflight (pinggy_bool_t / bool)
-    bool allow_preflight;
-    status = napi_get_value_bool(env, args[1], &allow_preflight);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid allow_preflight argument");
+    pinggy_ref_t clone = pinggy_create_config();
+    NAPI_CHECK_CONDITION_THROW(env, clone != INVALID_PINGGY_REF, "Failed to create config");
+    pinggy_ref_own(env, clone, PINGGY_REF_CONFIG);
 
-    // Call the pinggy_config_set_allow_preflight function
-    pinggy_config_set_allow_preflight(config, (pinggy_bool_t)allow_preflight);
+    for (size_t i = 0; i < CONFIG_FIELD_TOTAL; i++)
+    {
+        ConfigFieldKind kind;
+        const ConfigFieldNames *names = config_field_at(i, &kind);
+        config_copy_field(env, source, clone, names, kind);
+    }
 
-    // Return undefined
     napi_value result;
-    napi_get_undefined(env, &result);
+    status = napi_create_uint32(env, clone, &result);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create config value");
     return result;
 }
 
-// Wrapper for pinggy_config_get_allow_preflight
-napi_value ConfigGetAllowPreflight(napi_env env, napi_callback_info info)
+// configFieldKeys: the key of every field, by index.
+static void config_export_field_keys(napi_env env, napi_value exports)
 {
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the pinggy_config_get_allow_preflight function
-    pinggy_bool_t allow_preflight = pinggy_config_get_allow_preflight(config);
-
-    // Return the boolean value as a JavaScript boolean
-    napi_value result;
-    napi_get_boolean(env, allow_preflight, &result);
-    return result;
+    napi_value keys;
+    if (napi_create_array_with_length(env, CONFIG_FIELD_TOTAL, &keys) != napi_ok)
+    {
+        return;
+    }
+    for (size_t i = 0; i < CONFIG_FIELD_TOTAL; i++)
+    {
+        ConfigFieldKind kind;
+        napi_value key;
+        if (napi_create_string_utf8(env, config_field_at(i, &kind)->key, NAPI_AUTO_LENGTH, &key) != napi_ok ||
+            napi_set_element(env, keys, (uint32_t)i, key) != napi_ok)
+        {
+            return;
+        }
+    }
+    napi_object_freeze(env, keys);
+    napi_set_named_property(env, exports, "configFieldKeys", keys);
 }
 
-// Wrapper for pinggy_config_set_x_forwarded_for
-napi_value ConfigSetXForwardedFor(napi_env env, napi_callback_info info)
+static void config_export(napi_env env, napi_value exports, const char *name, napi_callback cb, const void *data)
 {
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, x_forwarded_for)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    bool x_forwarded_for;
-    status = napi_get_value_bool(env, args[1], &x_forwarded_for);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid x_forwarded_for argument");
-
-    pinggy_config_set_x_forwarded_for(config, (pinggy_bool_t)x_forwarded_for);
-
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
+    napi_value fn;
+    if (napi_create_function(env, name, NAPI_AUTO_LENGTH, cb, (void *)data, &fn) == napi_ok)
+    {
+        napi_set_named_property(env, exports, name, fn);
+    }
 }
 
-// Wrapper for pinggy_config_get_x_forwarded_for
-napi_value ConfigGetXForwardedFor(napi_env env, napi_callback_info info)
+napi_value Init1(napi_env env, napi_value exports)
 {
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    pinggy_bool_t x_forwarded_for = pinggy_config_get_x_forwarded_for(config);
-
-    napi_value result;
-    napi_get_boolean(env, x_forwarded_for, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_reverse_proxy
-napi_value ConfigSetReverseProxy(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, reverse_proxy)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Get the second argument: reverse_proxy (pinggy_bool_t / bool)
-    bool reverse_proxy;
-    status = napi_get_value_bool(env, args[1], &reverse_proxy);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid reverse_proxy argument");
-
-    // Call the pinggy_config_set_reverse_proxy function
-    pinggy_config_set_reverse_proxy(config, (pinggy_bool_t)reverse_proxy);
-
-    // Return undefined
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_reverse_proxy
-napi_value ConfigGetReverseProxy(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the pinggy_config_get_reverse_proxy function
-    pinggy_bool_t reverse_proxy = pinggy_config_get_reverse_proxy(config);
-
-    // Return the boolean value as a JavaScript boolean
-    napi_value result;
-    napi_get_boolean(env, reverse_proxy, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_original_request_url
-napi_value ConfigSetOriginalRequestUrl(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, original_request_url)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    bool original_request_url;
-    status = napi_get_value_bool(env, args[1], &original_request_url);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid original_request_url argument");
-
-    pinggy_config_set_original_request_url(config, (pinggy_bool_t)original_request_url);
-
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_original_request_url
-napi_value ConfigGetOriginalRequestUrl(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    pinggy_bool_t original_request_url = pinggy_config_get_original_request_url(config);
-
-    napi_value result;
-    napi_get_boolean(env, original_request_url, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_ip_white_list
-napi_value ConfigSetIpWhiteList(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, ip_white_list)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // determines the length of the ip_white_list string
-    size_t ip_len;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &ip_len);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid ip_white_list argument");
-
-    pinggy_char_p_t ip_white_list = malloc(ip_len + 1); // +1 for null terminator
-    NAPI_CHECK_CONDITION_THROW(env, ip_white_list != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], ip_white_list, ip_len + 1, &ip_len);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get ip_white_list string", free(ip_white_list));
-
-    pinggy_config_set_ip_white_list(config, ip_white_list);
-    free(ip_white_list);
-
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_ip_white_list
-napi_value ConfigGetIpWhiteList(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // First call the _len variant to get required buffer size
-    pinggy_capa_t required_len = 0;
-    pinggy_const_int_t rc = pinggy_config_get_ip_white_list_len(config, 0, NULL, &required_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0 && required_len > 0, "Failed to determine ip_white_list length");
-
-    pinggy_char_p_t ip_white_list = malloc(required_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, ip_white_list != NULL, "Memory allocation failed");
-
-    // Call the pinggy function to get the ip_white_list
-    pinggy_const_int_t copied = pinggy_config_get_ip_white_list(config, required_len + 1, ip_white_list);
-    NAPI_CHECK_CONDITION_THROW(env, copied >= 0, "Failed to get ip_white_list");
-
-    // Return the ip_white_list as a JavaScript string
-    napi_value result;
-    status = napi_create_string_utf8(env, ip_white_list, copied, &result);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to create JS string from ip_white_list", free(ip_white_list));
-
-    free(ip_white_list);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_basic_auths
-napi_value ConfigSetBasicAuths(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, basic_auths)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // determine length of the basic_auths string
-    size_t auth_len;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &auth_len);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid basic_auths argument");
-
-    pinggy_char_p_t basic_auths = malloc(auth_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, basic_auths != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], basic_auths, auth_len + 1, &auth_len);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get basic_auths string", free(basic_auths));
-
-    pinggy_config_set_basic_auths(config, basic_auths);
-    free(basic_auths);
-
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_basic_auths
-napi_value ConfigGetBasicAuths(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the _len variant to get the required buffer size
-    pinggy_capa_t required_len = 0;
-    pinggy_const_int_t rc = pinggy_config_get_basic_auths_len(config, 0, NULL, &required_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0 && required_len > 0, "Failed to determine basic_auths length");
-
-    pinggy_char_p_t basic_auths = malloc(required_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, basic_auths != NULL, "Memory allocation failed");
-
-    pinggy_const_int_t copied = pinggy_config_get_basic_auths(config, required_len + 1, basic_auths);
-    NAPI_CHECK_CONDITION_THROW(env, copied >= 0, "Failed to get basic_auths");
-
-    napi_value result;
-    status = napi_create_string_utf8(env, basic_auths, copied, &result);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to create JS string from basic_auths", free(basic_auths));
-
-    free(basic_auths);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_bearer_token_auths
-napi_value ConfigSetBearerTokenAuths(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, bearer_token_auths)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // determine length of the bearer_token_auths string
-    size_t auth_len;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &auth_len);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid bearer_token_auths argument");
-
-    pinggy_char_p_t bearer_token_auths = malloc(auth_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, bearer_token_auths != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], bearer_token_auths, auth_len + 1, &auth_len);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get bearer_token_auths string", free(bearer_token_auths));
-
-    pinggy_config_set_bearer_token_auths(config, bearer_token_auths);
-    free(bearer_token_auths);
-
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_bearer_token_auths
-napi_value ConfigGetBearerTokenAuths(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    pinggy_capa_t required_len = 0;
-    pinggy_const_int_t rc = pinggy_config_get_bearer_token_auths_len(config, 0, NULL, &required_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0 && required_len > 0, "Failed to determine bearer_token_auths length");
-
-    pinggy_char_p_t bearer_token_auths = malloc(required_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, bearer_token_auths != NULL, "Memory allocation failed");
-
-    pinggy_const_int_t copied = pinggy_config_get_bearer_token_auths(config, required_len + 1, bearer_token_auths);
-    NAPI_CHECK_CONDITION_THROW(env, copied >= 0, "Failed to get bearer_token_auths");
-
-    napi_value result;
-    status = napi_create_string_utf8(env, bearer_token_auths, copied, &result);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to create JS string from bearer_token_auths", free(bearer_token_auths));
-
-    free(bearer_token_auths);
-    return result;
-}
-// Wrapper for pinggy_config_set_header_modification
-napi_value ConfigSetHeaderModification(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, header_modification)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // determine length of the header_modification string
-    size_t header_len;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &header_len);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid header_modification argument");
-
-    pinggy_char_p_t header_modification = malloc(header_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, header_modification != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], header_modification, header_len + 1, &header_len);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get header_modification string", free(header_modification));
-
-    pinggy_config_set_header_manipulations(config, header_modification);
-    free(header_modification);
-
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_header_modification
-napi_value ConfigGetHeaderModification(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    pinggy_capa_t required_len = 0;
-    pinggy_const_int_t rc = pinggy_config_get_header_manipulations_len(config, 0, NULL, &required_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0 && required_len > 0, "Failed to determine header_modification length");
-
-    pinggy_char_p_t header_modification = malloc(required_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, header_modification != NULL, "Memory allocation failed");
-
-    pinggy_const_int_t copied = pinggy_config_get_header_manipulations(config, required_len + 1, header_modification);
-    NAPI_CHECK_CONDITION_THROW(env, copied >= 0, "Failed to get header_modification");
-
-    napi_value result;
-    status = napi_create_string_utf8(env, header_modification, copied, &result);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to create JS string from header_modification", free(header_modification));
-
-    free(header_modification);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_local_server_tls
-napi_value ConfigSetLocalServerTls(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, local_server_tls)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    size_t len;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &len);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid local_server_tls argument");
-
-    pinggy_char_p_t local_server_tls = malloc(len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, local_server_tls != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], local_server_tls, len + 1, &len);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get local_server_tls string", free(local_server_tls));
-
-    pinggy_config_set_local_server_tls(config, local_server_tls);
-    free(local_server_tls);
-
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_local_server_tls
-napi_value ConfigGetLocalServerTls(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    pinggy_capa_t required_len = 0;
-    pinggy_const_int_t rc = pinggy_config_get_local_server_tls_len(config, 0, NULL, &required_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0, "Failed to determine local_server_tls length");
-
-    if (required_len == 0)
-    {
-        // If the length is zero, return an empty string
-        napi_value result;
-        status = napi_create_string_utf8(env, "", 0, &result);
-        return result;
-    }
-
-    pinggy_char_p_t local_server_tls = malloc(required_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, local_server_tls != NULL, "Memory allocation failed");
-
-    pinggy_const_int_t copied = pinggy_config_get_local_server_tls(config, required_len + 1, local_server_tls);
-    NAPI_CHECK_CONDITION_THROW(env, copied >= 0, "Failed to get local_server_tls");
-
-    napi_value result;
-    status = napi_create_string_utf8(env, local_server_tls, copied, &result);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to create JS string from local_server_tls", free(local_server_tls));
-
-    free(local_server_tls);
-    return result;
-}
-// Wrapper for pinggy_config_set_auto_reconnect
-napi_value ConfigSetAutoReconnect(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, autoReconnect)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Get the second argument: autoReconnect (pinggy_bool_t / uint8_t)
-    bool autoReconnect;
-    status = napi_get_value_bool(env, args[1], &autoReconnect);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid autoReconnect argument");
-
-    // Call the pinggy_config_set_auto_reconnect function
-    pinggy_config_set_auto_reconnect(config, (pinggy_bool_t)autoReconnect);
-
-    // Return undefined (as the C function returns void)
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_auto_reconnect
-napi_value ConfigGetAutoReconnect(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the pinggy function to get the autoReconnect status
-    pinggy_const_bool_t autoReconnect = pinggy_config_get_auto_reconnect(config);
-
-    // Return the autoReconnect status as a JavaScript boolean
-    napi_value result;
-    status = napi_get_boolean(env, autoReconnect, &result);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create boolean from autoReconnect status");
-
-    return result;
-}
-
-// Wrapper for pinggy_config_set_reconnect_interval
-napi_value ConfigSetReconnectInterval(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, reconnectInterval)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Get the second argument: reconnectInterval (pinggy_uint32_t / uint32_t)
-    uint32_t reconnectInterval;
-    status = napi_get_value_uint32(env, args[1], &reconnectInterval);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid reconnectInterval argument");
-
-    // Call the pinggy_config_set_reconnect_interval function
-    pinggy_config_set_reconnect_interval(config, (pinggy_uint16_t)reconnectInterval);
-
-    // Return undefined (as the C function returns void)
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_reconnect_interval
-napi_value ConfigGetReconnectInterval(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the pinggy function to get the reconnect interval
-    pinggy_uint16_t interval = pinggy_config_get_reconnect_interval(config);
-
-    // Return the interval as a JavaScript number
-    napi_value result;
-    status = napi_create_uint32(env, (uint32_t)interval, &result);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create result");
-
-    return result;
-}
-
-// Wrapper for pinggy_config_set_max_reconnect_attempts
-napi_value ConfigSetMaxReconnectAttempts(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, maxReconnectAttempts)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Get the second argument: MaxReconnectAttempts (pinggy_uint32_t / uint32_t)
-    uint32_t maxReconnectAttempts;
-    status = napi_get_value_uint32(env, args[1], &maxReconnectAttempts);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid maxReconnectAttempts argument");
-
-    // Call the pinggy_config_set_max_reconnect_attempts function
-    pinggy_config_set_max_reconnect_attempts(config, (pinggy_uint32_t)maxReconnectAttempts);
-
-    // Return undefined (as the C function returns void)
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_max_reconnect_attempts
-napi_value ConfigGetMaxReconnectAttempts(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the pinggy function to get the max reconnect attempts
-    pinggy_uint32_t maxReconnectAttempts = pinggy_config_get_max_reconnect_attempts(config);
-
-    // Return the maxReconnectAttempts as a JavaScript number
-    napi_value result;
-    status = napi_create_uint32(env, (uint32_t)maxReconnectAttempts, &result);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create result");
-
-    return result;
-}
-// Wrapper for pinggy_config_set_forwardings
-napi_value ConfigSetForwardings(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, forwardings)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Get the second argument: forwardings (string)
-    size_t forwardings_len;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &forwardings_len);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid forwardings argument");
-
-    pinggy_char_p_t forwardings = malloc(forwardings_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, forwardings != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], forwardings, forwardings_len + 1, &forwardings_len);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get forwardings string", free(forwardings));
-
-    // Call the pinggy_config_set_forwardings function
-    pinggy_config_set_forwardings(config, forwardings);
-
-    // Free allocated memory
-    free(forwardings);
-
-    // Return undefined (as the C function returns void)
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_reset_forwardings
-napi_value ConfigResetForwardings(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    // Parse arguments
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    // Validate the number of arguments
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    // Get the first argument: config (pinggy_ref_t / uint32_t)
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    // Call the pinggy_config_reset_forwardings function
-    pinggy_config_reset_forwardings(config);
-
-    // Return undefined (as the C function returns void)
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_webdebugger_addr. Sets the port for the web debugger.
-napi_value ConfigSetWebdebuggerAddr(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, addr)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    size_t addr_len;
-    status = napi_get_value_string_utf8(env, args[1], NULL, 0, &addr_len);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid addr argument");
-
-    pinggy_char_p_t addr = malloc(addr_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, addr != NULL, "Memory allocation failed");
-
-    status = napi_get_value_string_utf8(env, args[1], addr, addr_len + 1, &addr_len);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to get addr string", free(addr));
-
-    pinggy_config_set_webdebugger_addr(config, addr);
-    free(addr);
-
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_set_webdebugger. Enables or disables the web debugger for the tunnel.
-napi_value ConfigSetWebdebugger(napi_env env, napi_callback_info info)
-{
-    size_t argc = 2;
-    napi_value args[2];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (config, enable)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    bool enable;
-    status = napi_get_value_bool(env, args[1], &enable);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid enable argument");
-
-    pinggy_config_set_webdebugger(config, (pinggy_bool_t)enable);
-
-    napi_value result;
-    napi_get_undefined(env, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_webdebugger. Checks whether the web debugger is enabled in the tunnel config.
-napi_value ConfigGetWebdebugger(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    pinggy_bool_t webdebugger_enabled = pinggy_config_get_webdebugger(config);
-
-    napi_value result;
-    napi_get_boolean(env, webdebugger_enabled, &result);
-    return result;
-}
-
-// Wrapper for pinggy_config_get_webdebugger_addr. Retrieves the web debugger bindaddress from the tunnel config.
-napi_value ConfigGetWebdebuggerAddr(napi_env env, napi_callback_info info)
-{
-    size_t argc = 1;
-    napi_value args[1];
-    napi_status status;
-
-    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
-    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
-
-    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (config)");
-
-    pinggy_ref_t config;
-    status = napi_get_value_uint32(env, args[0], &config);
-    NAPI_CHECK_STATUS_THROW(env, status, "Invalid config argument");
-
-    pinggy_capa_t required_len = 0;
-    pinggy_const_int_t rc = pinggy_config_get_webdebugger_addr_len(config, 0, NULL, &required_len);
-    NAPI_CHECK_CONDITION_THROW(env, rc >= 0 && required_len > 0, "Failed to determine webdebugger_addr length");
-
-    pinggy_char_p_t webdebugger_addr = malloc(required_len + 1);
-    NAPI_CHECK_CONDITION_THROW(env, webdebugger_addr != NULL, "Memory allocation failed");
-
-    pinggy_const_int_t copied = pinggy_config_get_webdebugger_addr(config, required_len + 1, webdebugger_addr);
-    NAPI_CHECK_CONDITION_THROW(env, copied >= 0, "Failed to get webdebugger_addr");
-
-    napi_value result;
-    status = napi_create_string_utf8(env, webdebugger_addr, copied, &result);
-    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Failed to create JS string from webdebugger_addr", free(webdebugger_addr));
-
-    free(webdebugger_addr);
-    return result;
-}
-
-// Initialize the module and export the function
-napi_value Init1(napi_env env, napi_value exports)
-{
-    napi_value create_config_fn;
-
-    napi_value set_log_path_fn,
-        set_log_enable_fn,
-        set_server_address_fn,
-        set_sni_server_name_fn,
-        set_advanced_parsing_fn,
-        set_token_fn,
-        set_force_fn,
-        set_argument_fn,
-        set_ssl_fn,
-        set_insecure_fn,
-        set_ip_white_list_fn,
-        set_basic_auths_fn,
-        set_bearer_token_auths_fn,
-        set_allow_preflight_fn,
-        set_https_only_fn,
-        set_x_forwarded_for_fn,
-        set_original_request_url_fn,
-        set_header_manipulations_fn,
-        set_local_server_tls_fn,
-        set_reconnect_interval_fn,
-        set_auto_reconnect_fn,
-        set_max_reconnect_attempts_fn,
-        set_reverse_proxy_fn,
-        set_forwarding_simple_fn,
-        set_forwarding_fn,
-        set_forwardings,
-        set_reset_forwardings,
-        set_webdebugger_addr_fn,
-        set_webdebugger_fn;
-
-    napi_value get_server_address_fn,
-        get_sni_server_name_fn,
-        get_advanced_parsing_fn,
-        get_token_fn,
-        get_force_fn,
-        get_argument_fn,
-        get_ssl_fn,
-        get_ip_white_list_fn,
-        get_basic_auths_fn,
-        get_bearer_token_auths_fn,
-        get_insecure_fn,
-        get_https_only_fn,
-        get_allow_preflight_fn,
-        get_reverse_proxy_fn,
-        get_x_forwarded_for_fn,
-        get_original_request_url_fn,
-        get_header_manipulations_fn,
-        get_local_server_tls_fn,
-        get_reconnect_interval_fn,
-        get_auto_reconnect_fn,
-        get_max_reconnect_attempts_fn,
-        get_pinggy_version_fn,
-        get_forwarding_fn,
-        get_webdebugger_fn,
-        get_webdebugger_addr_fn;
-
-    napi_create_function(env, NULL, 0, SetLogPath, NULL, &set_log_path_fn);
-    // napi_create_function(napi_env env,
-    //                              const char* utf8name,
-    //                              size_t length,
-    //                              napi_callback cb,
-    //                              void* data,
-    //                              napi_value* result);
-    // - [in] env: the Node-API environment
-    // - [in] utf8name: Optional name of the function encoded as UTF8. This is visible within JavaScript as the new function object's name property.
-    // - [in] length: Length of the utf8name string. Pass 0 if utf8name is NULL.
-    // - [in] cb: The C function to be called when this function is invoked in JavaScript.
-    // - [in] data: User-provided data context. This will be passed back into the function when invoked later.
-    // - [out] result: The new function object.
-
-    napi_set_named_property(env, exports, "setLogPath", set_log_path_fn);
-    // napi_status napi_set_named_property(napi_env env,
-    //                                  napi_value object,
-    //                                  const char* utf8name,
-    //                                  napi_value value)
-    // - [in] env: the Node-API environment
-    // - [in] object: the object to which the property is to be added
-    // - [in] utf8name: the name of the property to add
-    // - [in] value: the value of the property to add
-
-    napi_create_function(env, NULL, 0, SetLogEnable, NULL, &set_log_enable_fn);
-    napi_set_named_property(env, exports, "setLogEnable", set_log_enable_fn);
-
-    napi_create_function(env, NULL, 0, CreateConfig, NULL, &create_config_fn);
-    napi_set_named_property(env, exports, "createConfig", create_config_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetServerAddress, NULL, &set_server_address_fn);
-    napi_set_named_property(env, exports, "configSetServerAddress", set_server_address_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetServerAddress, NULL, &get_server_address_fn);
-    napi_set_named_property(env, exports, "configGetServerAddress", get_server_address_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetSniServerName, NULL, &get_sni_server_name_fn);
-    napi_set_named_property(env, exports, "configGetSniServerName", get_sni_server_name_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetSniServerName, NULL, &set_sni_server_name_fn);
-    napi_set_named_property(env, exports, "configSetSniServerName", set_sni_server_name_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetAdvancedParsing, NULL, &set_advanced_parsing_fn);
-    napi_set_named_property(env, exports, "configSetAdvancedParsing", set_advanced_parsing_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetAdvancedParsing, NULL, &get_advanced_parsing_fn);
-    napi_set_named_property(env, exports, "configGetAdvancedParsing", get_advanced_parsing_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetToken, NULL, &set_token_fn);
-    napi_set_named_property(env, exports, "configSetToken", set_token_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetForwardings, NULL, &get_forwarding_fn);
-    napi_set_named_property(env, exports, "configGetForwarding", get_forwarding_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetForce, NULL, &set_force_fn);
-    napi_set_named_property(env, exports, "configSetForce", set_force_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetForce, NULL, &get_force_fn);
-    napi_set_named_property(env, exports, "configGetForce", get_force_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetArgument, NULL, &set_argument_fn);
-    napi_set_named_property(env, exports, "configSetArgument", set_argument_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetArgument, NULL, &get_argument_fn);
-    napi_set_named_property(env, exports, "configGetArgument", get_argument_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetSSL, NULL, &set_ssl_fn);
-    napi_set_named_property(env, exports, "configSetSSL", set_ssl_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetWebdebuggerAddr, NULL, &set_webdebugger_addr_fn);
-    napi_set_named_property(env, exports, "configSetWebdebuggerAddr", set_webdebugger_addr_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetWebdebugger, NULL, &set_webdebugger_fn);
-    napi_set_named_property(env, exports, "configSetWebdebugger", set_webdebugger_fn);
-
-    napi_create_function(env, NULL, 0, ConfigResetForwardings, NULL, &set_reset_forwardings);
-    napi_set_named_property(env, exports, "configResetForwardings", set_reset_forwardings);
-
-    napi_create_function(env, NULL, 0, ConfigSetForwardings, NULL, &set_forwardings);
-    napi_set_named_property(env, exports, "configSetForwardings", set_forwardings);
-
-    napi_create_function(env, NULL, 0, ConfigAddForwarding, NULL, &set_forwarding_fn);
-    napi_set_named_property(env, exports, "configAddForwarding", set_forwarding_fn);
-
-    napi_create_function(env, NULL, 0, ConfigAddForwardingSimple, NULL, &set_forwarding_simple_fn);
-    napi_set_named_property(env, exports, "configAddForwardingSimple", set_forwarding_simple_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetInsecure, NULL, &set_insecure_fn);
-    napi_set_named_property(env, exports, "configSetInsecure", set_insecure_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetWebdebuggerAddr, NULL, &get_webdebugger_addr_fn);
-    napi_set_named_property(env, exports, "configGetWebdebuggerAddr", get_webdebugger_addr_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetWebdebugger, NULL, &get_webdebugger_fn);
-    napi_set_named_property(env, exports, "configGetWebdebugger", get_webdebugger_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetToken, NULL, &get_token_fn);
-    napi_set_named_property(env, exports, "configGetToken", get_token_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetSsl, NULL, &get_ssl_fn);
-    napi_set_named_property(env, exports, "configGetSsl", get_ssl_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetInsecure, NULL, &get_insecure_fn);
-    napi_set_named_property(env, exports, "configGetInsecure", get_insecure_fn);
-
-    napi_create_function(env, NULL, 0, GetPinggyVersion, NULL, &get_pinggy_version_fn);
-    napi_set_named_property(env, exports, "getPinggyVersion", get_pinggy_version_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetHttpsOnly, NULL, &set_https_only_fn);
-    napi_set_named_property(env, exports, "configSetHttpsOnly", set_https_only_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetHttpsOnly, NULL, &get_https_only_fn);
-    napi_set_named_property(env, exports, "configGetHttpsOnly", get_https_only_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetIpWhiteList, NULL, &set_ip_white_list_fn);
-    napi_set_named_property(env, exports, "configSetIpWhiteList", set_ip_white_list_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetIpWhiteList, NULL, &get_ip_white_list_fn);
-    napi_set_named_property(env, exports, "configGetIpWhiteList", get_ip_white_list_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetAllowPreflight, NULL, &set_allow_preflight_fn);
-    napi_set_named_property(env, exports, "configSetAllowPreflight", set_allow_preflight_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetAllowPreflight, NULL, &get_allow_preflight_fn);
-    napi_set_named_property(env, exports, "configGetAllowPreflight", get_allow_preflight_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetXForwardedFor, NULL, &set_x_forwarded_for_fn);
-    napi_set_named_property(env, exports, "configSetXForwardedFor", set_x_forwarded_for_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetXForwardedFor, NULL, &get_x_forwarded_for_fn);
-    napi_set_named_property(env, exports, "configGetXForwardedFor", get_x_forwarded_for_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetReverseProxy, NULL, &set_reverse_proxy_fn);
-    napi_set_named_property(env, exports, "configSetReverseProxy", set_reverse_proxy_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetReverseProxy, NULL, &get_reverse_proxy_fn);
-    napi_set_named_property(env, exports, "configGetReverseProxy", get_reverse_proxy_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetOriginalRequestUrl, NULL, &set_original_request_url_fn);
-    napi_set_named_property(env, exports, "configSetOriginalRequestUrl", set_original_request_url_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetOriginalRequestUrl, NULL, &get_original_request_url_fn);
-    napi_set_named_property(env, exports, "configGetOriginalRequestUrl", get_original_request_url_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetBasicAuths, NULL, &get_basic_auths_fn);
-    napi_set_named_property(env, exports, "configGetBasicAuths", get_basic_auths_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetBasicAuths, NULL, &set_basic_auths_fn);
-    napi_set_named_property(env, exports, "configSetBasicAuths", set_basic_auths_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetBearerTokenAuths, NULL, &get_bearer_token_auths_fn);
-    napi_set_named_property(env, exports, "configGetBearerTokenAuths", get_bearer_token_auths_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetBearerTokenAuths, NULL, &set_bearer_token_auths_fn);
-    napi_set_named_property(env, exports, "configSetBearerTokenAuths", set_bearer_token_auths_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetHeaderModification, NULL, &set_header_manipulations_fn);
-    napi_set_named_property(env, exports, "configSetHeaderModification", set_header_manipulations_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetHeaderModification, NULL, &get_header_manipulations_fn);
-    napi_set_named_property(env, exports, "configGetHeaderModification", get_header_manipulations_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetLocalServerTls, NULL, &set_local_server_tls_fn);
-    napi_set_named_property(env, exports, "configSetLocalServerTls", set_local_server_tls_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetLocalServerTls, NULL, &get_local_server_tls_fn);
-    napi_set_named_property(env, exports, "configGetLocalServerTls", get_local_server_tls_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetAutoReconnect, NULL, &set_auto_reconnect_fn);
-    napi_set_named_property(env, exports, "configSetAutoReconnect", set_auto_reconnect_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetAutoReconnect, NULL, &get_auto_reconnect_fn);
-    napi_set_named_property(env, exports, "configGetAutoReconnect", get_auto_reconnect_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetMaxReconnectAttempts, NULL, &set_max_reconnect_attempts_fn);
-    napi_set_named_property(env, exports, "configSetMaxReconnectAttempts", set_max_reconnect_attempts_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetMaxReconnectAttempts, NULL, &get_max_reconnect_attempts_fn);
-    napi_set_named_property(env, exports, "configGetMaxReconnectAttempts", get_max_reconnect_attempts_fn);
-
-    napi_create_function(env, NULL, 0, ConfigSetReconnectInterval, NULL, &set_reconnect_interval_fn);
-    napi_set_named_property(env, exports, "configSetReconnectInterval", set_reconnect_interval_fn);
-
-    napi_create_function(env, NULL, 0, ConfigGetReconnectInterval, NULL, &get_reconnect_interval_fn);
-    napi_set_named_property(env, exports, "configGetReconnectInterval", get_reconnect_interval_fn);
+    config_export(env, exports, "setLogPath", SetLogPath, NULL);
+    config_export(env, exports, "setLogEnable", SetLogEnable, NULL);
+    config_export(env, exports, "createConfig", CreateConfig, NULL);
+    config_export(env, exports, "configAddForwardingSimple", ConfigAddForwardingSimple, NULL);
+    config_export(env, exports, "configAddForwarding", ConfigAddForwarding, NULL);
+    config_export(env, exports, "configResetForwardings", ConfigResetForwardings, NULL);
+    config_export(env, exports, "getPinggyVersion", GetPinggyVersion, NULL);
+    config_export(env, exports, "configApply", ConfigApply, NULL);
+    config_export(env, exports, "configSnapshot", ConfigSnapshot, NULL);
+    config_export(env, exports, "configClone", ConfigClone, NULL);
+    config_export_field_keys(env, exports);
+
+    for (size_t i = 0; i < CONFIG_FIELD_COUNT(g_string_fields); i++)
+    {
+        const ConfigStringField *field = &g_string_fields[i];
+        config_export(env, exports, field->names.setter, ConfigStringSet, field);
+        config_export(env, exports, field->names.getter, ConfigStringGet, field);
+    }
+    for (size_t i = 0; i < CONFIG_FIELD_COUNT(g_bool_fields); i++)
+    {
+        const ConfigBoolField *field = &g_bool_fields[i];
+        config_export(env, exports, field->names.setter, ConfigBoolSet, field);
+        config_export(env, exports, field->names.getter, ConfigBoolGet, field);
+    }
+    for (size_t i = 0; i < CONFIG_FIELD_COUNT(g_uint16_fields); i++)
+    {
+        const ConfigUint16Field *field = &g_uint16_fields[i];
+        config_export(env, exports, field->names.setter, ConfigUint16Set, field);
+        config_export(env, exports, field->names.getter, ConfigUint16Get, field);
+    }
 
     return exports;
 }
@@ -0,0 +1,53 @@
+#ifndef PINGGY_CONFIG_FIELDS_H
+#define PINGGY_CONFIG_FIELDS_H
+
+// Config fields exposed to JS as a plain setter/getter pair.
+//
+// Each X-macro row expands, in config.c, into one descriptor; the accessors
+// themselves are a handful of shared callbacks that find their descriptor
+// through the function's data pointer. Fields with any other shape
+// (forwardings added one by one, log settings, ...) stay hand-written.
+//
+// Columns:
+//   field   suffix of the pinggy_config_set_* / pinggy_config_get_* calls
+//   key     name of the field in configFieldKeys, whose indices configApply
+//           takes (boolean fields, then uint16, then strings)
+//   label   argument name used in error messages
+//   setter  JS export name of the setter
+//   getter  JS export name of the getter
+//   flags   PINGGY_CONFIG_FIELD_* (string fields only)
+
+// An empty value reads back as "" instead of throwing.
+#define PINGGY_CONFIG_FIELD_EMPTY_OK 0x1
+
+#define PINGGY_CONFIG_STRING_FIELDS(X)                                                                                                            \
+    X(server_address, "serverAddress", "server_address", "configSetServerAddress", "configGetServerAddress", 0)                                   \
+    X(sni_server_name, "sniServerName", "sni_server_name", "configSetSniServerName", "configGetSniServerName", 0)                                 \
+    X(token, "token", "token", "configSetToken", "configGetToken", PINGGY_CONFIG_FIELD_EMPTY_OK)                                                  \
+    X(forwardings, "forwardings", "forwardings", "configSetForwardings", "configGetForwarding", 0)                                                \
+    X(argument, "argument", "argument", "configSetArgument", "configGetArgument", PINGGY_CONFIG_FIELD_EMPTY_OK)                                   \
+    X(ip_white_list, "ipWhiteList", "ip_white_list", "configSetIpWhiteList", "configGetIpWhiteList", 0)                                           \
+    X(basic_auths, "basicAuths", "basic_auths", "configSetBasicAuths", "configGetBasicAuths", 0)                                                  \
+    X(bearer_token_auths, "bearerTokenAuths", "bearer_token_auths", "configSetBearerTokenAuths", "configGetBearerTokenAuths", 0)                  \
+    X(header_manipulations, "headerModification", "header_modification", "configSetHeaderModification", "configGetHeaderModification", 0)         \
+    X(local_server_tls, "localServerTls", "local_server_tls", "configSetLocalServerTls", "configGetLocalServerTls", PINGGY_CONFIG_FIELD_EMPTY_OK) \
+    X(webdebugger_addr, "webdebuggerAddr", "addr", "configSetWebdebuggerAddr", "configGetWebdebuggerAddr", 0)
+
+#define PINGGY_CONFIG_BOOL_FIELDS(X)                                                                                                    \
+    X(advanced_parsing, "advancedParsing", "advanced_parsing", "configSetAdvancedParsing", "configGetAdvancedParsing")                  \
+    X(force, "force", "force", "configSetForce", "configGetForce")                                                                      \
+    X(ssl, "ssl", "ssl", "configSetSSL", "configGetSsl")                                                                                \
+    X(insecure, "insecure", "insecure", "configSetInsecure", "configGetInsecure")                                                       \
+    X(https_only, "httpsOnly", "https_only", "configSetHttpsOnly", "configGetHttpsOnly")                                                \
+    X(allow_preflight, "allowPreflight", "allow_preflight", "configSetAllowPreflight", "configGetAllowPreflight")                       \
+    X(x_forwarded_for, "xForwardedFor", "x_forwarded_for", "configSetXForwardedFor", "configGetXForwardedFor")                          \
+    X(reverse_proxy, "reverseProxy", "reverse_proxy", "configSetReverseProxy", "configGetReverseProxy")                                 \
+    X(original_request_url, "originalRequestUrl", "original_request_url", "configSetOriginalRequestUrl", "configGetOriginalRequestUrl") \
+    X(auto_reconnect, "autoReconnect", "autoReconnect", "configSetAutoReconnect", "configGetAutoReconnect")                             \
+    X(webdebugger, "webdebugger", "enable", "configSetWebdebugger", "configGetWebdebugger")
+
+#define PINGGY_CONFIG_UINT16_FIELDS(X)                                                                                                          \
+    X(reconnect_interval, "reconnectInterval", "reconnectInterval", "configSetReconnectInterval", "configGetReconnectInterval")                 \
+    X(max_reconnect_attempts, "maxReconnectAttempts", "maxReconnectAttempts", "configSetMaxReconnectAttempts", "configGetMaxReconnectAttempts")
+
+#endif // PINGGY_CONFIG_FIELDS_H
@@ -1,8 +1,10 @@
 #include "debug.h"
+#include "instance.h"
 #include <node_api.h>
 
-// Global debug flag - initialized to -1 to indicate uninitialized state
-int _pinggy_debug_enabled = -1;
+// Default debug flag, from PINGGY_DEBUG - initialized to -1 to indicate uninitialized state.
+// Envs keep their own flag in their instance data; this one covers threads without an env.
+static int _pinggy_debug_enabled = -1;
 
 // Function to initialize debug logging based on environment variable
 void pinggy_debug_init(void)
@@ -37,21 +39,38 @@ void pinggy_debug_init(void)
     }
 }
 
+// Function to get the process-wide default
+int pinggy_debug_default(void)
+{
+    // Auto-initialize if not done yet
+    if (_pinggy_debug_enabled == -1)
+    {
+        pinggy_debug_init();
+    }
+    return _pinggy_debug_enabled;
+}
+
 // Function to set debug logging state (for JavaScript API)
 void pinggy_debug_set_enabled(int enabled)
 {
+    PinggyInstance *instance = pinggy_instance_current();
+    if (instance != NULL)
+    {
+        instance->debug_enabled = enabled ? 1 : 0;
+        return;
+    }
     _pinggy_debug_enabled = enabled ? 1 : 0;
 }
 
 // Function to check if debug logging is enabled
 int pinggy_debug_is_enabled(void)
 {
-    // Auto-initialize if not done yet
-    if (_pinggy_debug_enabled == -1)
+    PinggyInstance *instance = pinggy_instance_current();
+    if (instance != NULL)
     {
-        pinggy_debug_init();
+        return instance->debug_enabled;
     }
-    return _pinggy_debug_enabled;
+    return pinggy_debug_default();
 }
 
 // N-API binding to enable/disable debug logging from JavaScript
@@ -10,16 +10,16 @@ extern "C"
 {
 #endif
 
-    // Global debug flag
-    extern int _pinggy_debug_enabled;
-
     // Function to initialize debug logging based on environment variable
     void pinggy_debug_init(void);
 
-    // Function to set debug logging state (for JavaScript API)
+    // Process-wide default from PINGGY_DEBUG; each env starts from it
+    int pinggy_debug_default(void);
+
+    // Function to set debug logging state for the calling thread's env (for JavaScript API)
     void pinggy_debug_set_enabled(int enabled);
 
-    // Function to check if debug logging is enabled
+    // Function to check if debug logging is enabled for the calling thread's env
     int pinggy_debug_is_enabled(void);
 
 // Debug logging macro
@@ -0,0 +1,321 @@
+#include <node_api.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "event.h"
+#include "pump.h"
+#include "promise.h"
+#include "batch.h"
+#include "usage.h"
+#include "callbacks.h"
+#include "marshal.h"
+#include "intern.h"
+
+// Shape of the JavaScript arguments for each event type. Arguments are always
+// passed as: tunnel, [number], strings..., [flag], [list]
+//
+// The leading `interned` strings, and the list when `intern_list` is set,
+// repeat from event to event and come from the env's intern table.
+typedef struct
+{
+    pinggy_len_t num_strings;
+    int has_number;
+    int has_flag;
+    int has_list;
+    pinggy_len_t interned;
+    int intern_list;
+} PinggyEventShape;
+
+static const PinggyEventShape event_shapes[PINGGY_EVENT_COUNT] = {
+    /* ADDITIONAL_FORWARDING_SUCCEEDED: bind_addr, forward_to_addr, forwarding_type */
+    {3, 0, 0, 0, 3, 0},
+    /* ADDITIONAL_FORWARDING_FAILED: bind_addr, forward_to_addr, forwarding_type, error */
+    {4, 0, 0, 0, 3, 0},
+    /* TUNNEL_ESTABLISHED: urls[] */
+    {0, 0, 0, 1, 0, 1},
+    /* TUNNEL_FAILED: msg */
+    {1, 0, 0, 0, 0, 0},
+    /* FORWARDINGS_CHANGED: url_map */
+    {1, 0, 0, 0, 0, 0},
+    /* DISCONNECTED: error, messages[] */
+    {1, 0, 0, 1, 0, 0},
+    /* TUNNEL_ERROR: error_no, error, recoverable */
+    {1, 1, 1, 0, 0, 0},
+    /* USAGE_UPDATE: usages */
+    {1, 0, 0, 0, 0, 0},
+    /* WILL_RECONNECT: error, messages[] */
+    {1, 0, 0, 1, 0, 0},
+    /* RECONNECTING: retry_cnt */
+    {0, 1, 0, 0, 0, 0},
+    /* RECONNECTION_COMPLETED: urls[] */
+    {0, 0, 0, 1, 0, 1},
+    /* RECONNECTION_FAILED: retry_cnt */
+    {0, 1, 0, 0, 0, 0},
+};
+
+PinggyEvent *pinggy_event_clone(const PinggyEvent *event)
+{
+    size_t lengths[PINGGY_EVENT_MAX_STRINGS] = {0};
+    size_t total = sizeof(PinggyEvent) + (size_t)event->num_list * sizeof(char *);
+    size_t usage_size = event->usage != NULL ? PINGGY_USAGE_FIELD_COUNT * sizeof(double) : 0;
+
+    for (pinggy_len_t i = 0; i < event->num_strings; i++)
+    {
+        lengths[i] = event->strings[i] ? strlen(event->strings[i]) + 1 : 0;
+        total += lengths[i];
+    }
+    for (pinggy_len_t i = 0; i < event->num_list; i++)
+    {
+        total += event->list[i] ? strlen(event->list[i]) + 1 : 1;
+    }
+
+    total += usage_size;
+
+    // Layout: [PinggyEvent][list pointers][usage values][string bytes]
+    PinggyEvent *copy = (PinggyEvent *)malloc(total);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    *copy = *event;
+    copy->next = NULL;
+
+    char **list = (char **)(copy + 1);
+    double *usage = (double *)(list + event->num_list);
+    char *cursor = (char *)usage + usage_size;
+
+    if (event->usage != NULL)
+    {
+        memcpy(usage, event->usage, usage_size);
+        copy->usage = usage;
+    }
+
+    for (pinggy_len_t i = 0; i < event->num_strings; i++)
+    {
+        if (event->strings[i] == NULL)
+        {
+            copy->strings[i] = NULL;
+            continue;
+        }
+        memcpy(cursor, event->strings[i], lengths[i]);
+        copy->strings[i] = cursor;
+        cursor += lengths[i];
+    }
+    for (pinggy_len_t i = 0; i < event->num_list; i++)
+    {
+        const char *item = event->list[i] ? event->list[i] : "";
+        size_t len = strlen(item) + 1;
+        memcpy(cursor, item, len);
+        list[i] = cursor;
+        cursor += len;
+    }
+    copy->list = event->num_list > 0 ? (const char **)list : NULL;
+
+    return copy;
+}
+
+napi_status pinggy_event_build_args(napi_env env, const PinggyEvent *event, napi_value *argv, size_t *argc)
+{
+    const PinggyEventShape *shape = &event_shapes[event->type];
+    napi_status status;
+    size_t n = 0;
+
+    status = napi_create_uint32(env, (uint32_t)event->tunnel, &argv[n++]);
+    if (status != napi_ok)
+        return status;
+
+    if (shape->has_number)
+    {
+        status = napi_create_uint32(env, event->number, &argv[n++]);
+        if (status != napi_ok)
+            return status;
+    }
+
+    if (event->usage != NULL)
+    {
+        // Parsed natively: the counters go to the tunnel's usage view and the
+        // callback gets null in place of the JSON text.
+        tunnel_usage_view_store(env, event->tunnel, event->usage);
+        status = napi_get_null(env, &argv[n++]);
+        if (status != napi_ok)
+            return status;
+    }
+    else
+    {
+        for (pinggy_len_t i = 0; i < shape->num_strings; i++)
+        {
+            const char *str = i < event->num_strings && event->strings[i] ? event->strings[i] : "";
+            status = i < shape->interned ? pinggy_string_intern(env, str, NAPI_AUTO_LENGTH, &argv[n++])
+                                         : pinggy_string_create(env, str, NAPI_AUTO_LENGTH, &argv[n++]);
+            if (status != napi_ok)
+                return status;
+        }
+    }
+
+    if (shape->has_flag)
+    {
+        status = napi_get_boolean(env, event->flag, &argv[n++]);
+        if (status != napi_ok)
+            return status;
+    }
+
+    if (shape->has_list)
+    {
+        napi_value array;
+        status = napi_create_array_with_length(env, event->num_list > 0 ? (size_t)event->num_list : 0, &array);
+        if (status != napi_ok)
+            return status;
+        for (pinggy_len_t i = 0; i < event->num_list; i++)
+        {
+            napi_value item;
+            const char *str = event->list[i] ? event->list[i] : "";
+            status = shape->intern_list ? pinggy_string_intern(env, str, NAPI_AUTO_LENGTH, &item)
+                                        : pinggy_string_create(env, str, NAPI_AUTO_LENGTH, &item);
+            if (status != napi_ok)
+                return status;
+            status = napi_set_element(env, array, (uint32_t)i, item);
+            if (status != napi_ok)
+                return status;
+        }
+        argv[n++] = array;
+    }
+
+    *argc = n;
+    return napi_ok;
+}
+
+void pinggy_event_dispatch(napi_env env, const PinggyEvent *event)
+{
+    if (env == NULL || event == NULL || event->type >= PINGGY_EVENT_COUNT)
+    {
+        return;
+    }
+
+    // Settle before calling JS: a throwing callback would leave an exception
+    // pending and the promise could not be resolved.
+    tunnel_start_promise_settle(env, event);
+    if (event->target == NULL)
+    {
+        return;
+    }
+
+    napi_handle_scope scope;
+    napi_status status = napi_open_handle_scope(env, &scope);
+    if (status != napi_ok)
+    {
+        PINGGY_DEBUG("Failed to open handle scope for event %d", (int)event->type);
+        return;
+    }
+
+    napi_value callback, undefined, js_result = NULL;
+    napi_value argv[PINGGY_EVENT_MAX_STRINGS + 4];
+    size_t argc = 0;
+
+    // Looked up again rather than read through event->target: the callback
+    // block may have been released while the event was queued.
+    napi_ref callback_ref = tunnel_callbacks_lookup(env, event->tunnel, event->type);
+    if (callback_ref == NULL)
+    {
+        napi_close_handle_scope(env, scope);
+        return;
+    }
+    status = napi_get_reference_value(env, callback_ref, &callback);
+    if (status == napi_ok && callback != NULL)
+    {
+        status = pinggy_event_build_args(env, event, argv, &argc);
+        if (status == napi_ok)
+        {
+            napi_get_undefined(env, &undefined);
+            status = napi_call_function(env, undefined, callback, argc, argv, &js_result);
+            PINGGY_DEBUG_RET(js_result);
+        }
+    }
+    if (status != napi_ok && status != napi_pending_exception)
+    {
+        PINGGY_DEBUG("Failed to deliver event %d, status %d", (int)event->type, (int)status);
+    }
+
+    napi_close_handle_scope(env, scope);
+}
+
+#ifdef _WIN32
+#define PINGGY_THREAD_LOCAL __declspec(thread)
+#else
+#define PINGGY_THREAD_LOCAL __thread
+#endif
+
+static PINGGY_THREAD_LOCAL PinggyEventQueue *g_deferred = NULL;
+
+void pinggy_event_defer(PinggyEventQueue *queue)
+{
+    g_deferred = queue;
+}
+
+void pinggy_event_queue_flush(napi_env env, PinggyEventQueue *queue)
+{
+    PinggyEvent *event = queue->head;
+    queue->head = queue->tail = NULL;
+    while (event != NULL)
+    {
+        PinggyEvent *next = event->next;
+        pinggy_event_dispatch(env, event);
+        free(event);
+        event = next;
+    }
+}
+
+void pinggy_event_deliver(const PinggyEvent *event)
+{
+    if (event == NULL || pinggy_event_batch_append(event))
+    {
+        return;
+    }
+    // Events without a JS target are still wanted by an armed start promise.
+    if (event->target == NULL && !tunnel_start_promise_wants(event))
+    {
+        return;
+    }
+
+    TunnelDriver *driver = tunnel_driver_current();
+    if (driver == NULL && g_deferred != NULL)
+    {
+        PinggyEvent *copy = pinggy_event_clone(event);
+        if (copy == NULL)
+        {
+            PINGGY_DEBUG("Failed to copy event %d for tunnel %u", (int)event->type, (unsigned)event->tunnel);
+            return;
+        }
+        if (g_deferred->tail != NULL)
+        {
+            g_deferred->tail->next = copy;
+        }
+        else
+        {
+            g_deferred->head = copy;
+        }
+        g_deferred->tail = copy;
+        return;
+    }
+    if (driver == NULL)
+    {
+        // Called from the JS thread (inside tunnelResume*): call straight into JS.
+        napi_env env = event->target != NULL ? tunnel_callbacks_env(event->tunnel) : NULL;
+        if (env == NULL)
+        {
+            tunnel_start_promise_settle(NULL, event);
+            return;
+        }
+        pinggy_event_dispatch(env, event);
+        return;
+    }
+
+    PinggyEvent *copy = pinggy_event_clone(event);
+    if (copy == NULL)
+    {
+        PINGGY_DEBUG("Failed to copy event %d for tunnel %u", (int)event->type, (unsigned)event->tunnel);
+        return;
+    }
+    tunnel_driver_post(driver, copy);
+}
@@ -0,0 +1,99 @@
+#ifndef PINGGY_EVENT_H
+#define PINGGY_EVENT_H
+
+#include <node_api.h>
+#include "../pinggy.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Every libpinggy tunnel callback the addon forwards to JavaScript.
+    typedef enum
+    {
+        PINGGY_EVENT_ADDITIONAL_FORWARDING_SUCCEEDED = 0,
+        PINGGY_EVENT_ADDITIONAL_FORWARDING_FAILED,
+        PINGGY_EVENT_TUNNEL_ESTABLISHED,
+        PINGGY_EVENT_TUNNEL_FAILED,
+        PINGGY_EVENT_FORWARDINGS_CHANGED,
+        PINGGY_EVENT_DISCONNECTED,
+        PINGGY_EVENT_TUNNEL_ERROR,
+        PINGGY_EVENT_USAGE_UPDATE,
+        PINGGY_EVENT_WILL_RECONNECT,
+        PINGGY_EVENT_RECONNECTING,
+        PINGGY_EVENT_RECONNECTION_COMPLETED,
+        PINGGY_EVENT_RECONNECTION_FAILED,
+        PINGGY_EVENT_COUNT
+    } PinggyEventType;
+
+// Pseudo event posted by a pump after a resume that filled a batch ring.
+#define PINGGY_EVENT_BATCH_FLUSH PINGGY_EVENT_COUNT
+
+#define PINGGY_EVENT_MAX_STRINGS 4
+
+    // Structure to hold callback reference and environment
+    typedef struct
+    {
+        napi_ref callback_ref;
+        napi_env env;
+
+    } CallbackData;
+
+    // One callback invocation captured from libpinggy.
+    //
+    // Trampolines fill an event on the stack with borrowed pointers; it is only
+    // deep-copied (pinggy_event_clone) when it has to outlive the callback, i.e.
+    // when it is handed to another thread.
+    typedef struct PinggyEvent
+    {
+        PinggyEventType type;
+        CallbackData *target;     // non-NULL if JS registered a callback; never dereferenced
+        pinggy_ref_t tunnel;
+        pinggy_uint32_t number;  // error_no / retry_cnt
+        pinggy_bool_t flag;      // recoverable
+        pinggy_len_t num_strings;
+        const char *strings[PINGGY_EVENT_MAX_STRINGS];
+        pinggy_len_t num_list;   // urls / messages
+        const char **list;
+        const double *usage;      // parsed usage counters (PINGGY_USAGE_FIELD_COUNT), see usage.h
+        struct PinggyEvent *next; // link while a copy sits in a PinggyEventQueue
+    } PinggyEvent;
+
+    // Copies captured on a thread that cannot call into JS, kept for later dispatch.
+    typedef struct
+    {
+        PinggyEvent *head;
+        PinggyEvent *tail;
+    } PinggyEventQueue;
+
+    // Deep copies an event (strings, list and usage included) into a single allocation.
+    // Release it with free().
+    PinggyEvent *pinggy_event_clone(const PinggyEvent *event);
+
+    // Converts the event into the arguments of its JavaScript callback
+    // (tunnel first). `argv` needs PINGGY_EVENT_MAX_STRINGS + 4 slots.
+    napi_status pinggy_event_build_args(napi_env env, const PinggyEvent *event, napi_value *argv, size_t *argc);
+
+    // Converts the event into JavaScript arguments and calls its target callback.
+    // Must run on the JS thread that owns the tunnel's callbacks.
+    void pinggy_event_dispatch(napi_env env, const PinggyEvent *event);
+
+    // Entry point for every trampoline: queues a copy in the tunnel's batch ring
+    // if it has one, else dispatches synchronously on the JS thread, or queues a
+    // copy to the owning env when called from a native pump thread.
+    void pinggy_event_deliver(const PinggyEvent *event);
+
+    // Makes pinggy_event_deliver on the calling thread append copies to `queue`
+    // instead of dispatching them. Pass NULL to stop. Used by work that runs
+    // libpinggy calls on the libuv threadpool.
+    void pinggy_event_defer(PinggyEventQueue *queue);
+
+    // Dispatches and frees every queued event. Must run on the JS thread.
+    void pinggy_event_queue_flush(napi_env env, PinggyEventQueue *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_EVENT_H
@@ -3,116 +3,338 @@
 #include <stdio.h>
 #include <node_api.h>
 #include "debug.h"
+#include "instance.h"
+#include "excep.h"
+#include "../pinggy.h" // adjust path if needed
 
 #ifdef _WIN32
-#include <windows.h>
-static CRITICAL_SECTION g_exception_lock;
-static BOOL g_lock_initialized = FALSE;
+#define PINGGY_THREAD_LOCAL __declspec(thread)
 #else
-#include <pthread.h>
-static pthread_mutex_t g_exception_lock = PTHREAD_MUTEX_INITIALIZER;
+#define PINGGY_THREAD_LOCAL __thread
 #endif
 
-#include "../pinggy.h" // adjust path if needed
+/*
+ * Per-thread exception storage.
+ *
+ * The handler runs on whichever thread called into libpinggy. On an env's JS
+ * thread it writes a thread-local slot that only that thread reads, so the
+ * common path (getLastException right after a synchronous call) takes no
+ * lock. Exceptions raised on the env's pump, reactor or threadpool threads
+ * go to the instance's remote slot under its lock. Either way the instance's
+ * generation counter is bumped, letting JS skip getLastException entirely
+ * while it has not moved.
+ */
+static PINGGY_THREAD_LOCAL PinggyExceptionSlot g_thread_exception;
+static PINGGY_THREAD_LOCAL pinggy_ref_t g_thread_tunnel = INVALID_PINGGY_REF;
+static PINGGY_THREAD_LOCAL uint32_t g_thread_raised = 0;
+
+uint32_t pinggy_exception_raised(void) { return g_thread_raised; }
 
-#define TLS_BUFFER_SIZE 512
+pinggy_ref_t pinggy_exception_attribute(pinggy_ref_t tunnel) {
+  pinggy_ref_t previous = g_thread_tunnel;
+  g_thread_tunnel = tunnel;
+  return previous;
+}
+
+static void slot_store(PinggyExceptionSlot *slot, const char *type,
+                       const char *message) {
+  snprintf(slot->type, PINGGY_EXCEPTION_BUFFER_SIZE, "%s", type ? type : "");
+  snprintf(slot->message, PINGGY_EXCEPTION_BUFFER_SIZE, "%s",
+           message ? message : "");
+  slot->tunnel = g_thread_tunnel;
+}
+
+/* A slot tagged with another tunnel is left for that tunnel's caller. */
+static int slot_matches(const PinggyExceptionSlot *slot, pinggy_ref_t tunnel) {
+  return tunnel == INVALID_PINGGY_REF || slot->tunnel == INVALID_PINGGY_REF ||
+         slot->tunnel == tunnel;
+}
+
+void set_tls_exception(const char *type, const char *message) {
+  PinggyInstance *instance = pinggy_instance_current();
+  g_thread_raised++;
+  if (instance == NULL) {
+    /* Not raised on behalf of any env; PinggyExceptionHandler logged it. */
+    return;
+  }
+  if (pinggy_instance_on_js_thread(instance)) {
+    slot_store(&g_thread_exception, type, message);
+    g_thread_exception.pending = 1;
+  } else {
+    uv_mutex_lock(&instance->exception_lock);
+    slot_store(&instance->remote_exception, type, message);
+    PINGGY_ATOMIC_STORE32(&instance->remote_exception.pending, 1);
+    uv_mutex_unlock(&instance->exception_lock);
+  }
+  PINGGY_ATOMIC_INC32(&instance->exception_generation);
+}
+
+void clear_tls_exception() { g_thread_exception.pending = 0; }
 
 /*
- * Global (cross-thread) exception storage.
+ * Exception history.
  *
- * Use a single, globally-shared buffer protected by a mutex so that any
- * thread writing an exception is visible from any thread reading it.
+ * Every exception raised for an env is also kept, untruncated up to
+ * PINGGY_EXCEPTION_TEXT_MAX, in a ring of the env's last
+ * PINGGY_EXCEPTION_HISTORY_SIZE exceptions. The console echo is written by
+ * the env's loop through a uv_async_t instead of by the raising thread, so a
+ * burst of exceptions costs the raising thread one uv_async_send each.
  */
-static char g_exception_type[TLS_BUFFER_SIZE] = {0};
-static char g_exception_message[TLS_BUFFER_SIZE] = {0};
+#define PINGGY_EXCEPTION_HISTORY_SIZE 64
+#define PINGGY_EXCEPTION_TEXT_MAX 4096
 
-// --- Global Lock Init/Cleanup ---
-void init_tls() {
-#ifdef _WIN32
-  if (!g_lock_initialized) {
-    InitializeCriticalSection(&g_exception_lock);
-    g_lock_initialized = TRUE;
+typedef struct PinggyExceptionRecord {
+  uint32_t sequence; /* 0 while the slot is unused */
+  double timestamp;  /* milliseconds since the epoch */
+  uint32_t thread;
+  pinggy_ref_t tunnel;
+  char *where;
+  char *what;
+} PinggyExceptionRecord;
+
+struct PinggyExceptionLog {
+  uv_mutex_t lock;
+  PinggyExceptionRecord records[PINGGY_EXCEPTION_HISTORY_SIZE];
+  uint32_t last_sequence;
+  uint32_t echoed_sequence;
+
+  uv_async_t echo;
+  int echo_open; /* cleared before the handle is closed */
+  napi_async_cleanup_hook_handle echo_cleanup;
+};
+
+static int32_t g_thread_count = 0;
+static PINGGY_THREAD_LOCAL uint32_t g_thread_number = 0;
+
+/* Small process-wide number of the calling thread, assigned on first use. */
+static uint32_t thread_number(void) {
+  if (g_thread_number == 0) {
+    g_thread_number = (uint32_t)PINGGY_ATOMIC_INC32(&g_thread_count);
   }
-#else
-  /* pthread_mutex_t is statically initialized; nothing to do. */
-#endif
+  return g_thread_number;
 }
 
-void cleanup_tls() {
-#ifdef _WIN32
-  if (g_lock_initialized) {
-    DeleteCriticalSection(&g_exception_lock);
-    g_lock_initialized = FALSE;
+static char *copy_bounded(const char *text) {
+  if (text == NULL) {
+    text = "";
   }
-#else
-  /* Static mutex — no explicit destroy needed for our use-case. */
-#endif
+  size_t len = strlen(text);
+  if (len > PINGGY_EXCEPTION_TEXT_MAX) {
+    len = PINGGY_EXCEPTION_TEXT_MAX;
+  }
+  char *copy = (char *)malloc(len + 1);
+  if (copy != NULL) {
+    memcpy(copy, text, len);
+    copy[len] = '\0';
+  }
+  return copy;
 }
 
-void set_tls_exception(const char *type, const char *message) {
-#ifdef _WIN32
-  EnterCriticalSection(&g_exception_lock);
-#else
-  pthread_mutex_lock(&g_exception_lock);
-#endif
-  snprintf(g_exception_type, TLS_BUFFER_SIZE, "%s", type ? type : "");
-  snprintf(g_exception_message, TLS_BUFFER_SIZE, "%s", message ? message : "");
-#ifdef _WIN32
-  LeaveCriticalSection(&g_exception_lock);
-#else
-  pthread_mutex_unlock(&g_exception_lock);
-#endif
+/* Writes every record not echoed yet to stdout. JS thread only. */
+static void log_echo(uv_async_t *handle) {
+  PinggyExceptionLog *log = (PinggyExceptionLog *)handle->data;
+  size_t size = 64, used = 0;
+
+  uv_mutex_lock(&log->lock);
+  uint32_t first = log->echoed_sequence + 1;
+  uint32_t oldest = log->last_sequence > PINGGY_EXCEPTION_HISTORY_SIZE
+                        ? log->last_sequence - PINGGY_EXCEPTION_HISTORY_SIZE + 1
+                        : 1;
+  uint32_t dropped = first < oldest ? oldest - first : 0;
+  if (dropped > 0) {
+    first = oldest;
+  }
+  for (uint32_t seq = first; seq <= log->last_sequence; seq++) {
+    PinggyExceptionRecord *record =
+        &log->records[seq % PINGGY_EXCEPTION_HISTORY_SIZE];
+    size += strlen(record->where ? record->where : "") +
+            strlen(record->what ? record->what : "") + 24;
+  }
+  char *text = first <= log->last_sequence || dropped > 0 ? (char *)malloc(size)
+                                                          : NULL;
+  if (text != NULL) {
+    if (dropped > 0) {
+      used += snprintf(text + used, size - used,
+                       "Pinggy Exception: %u more not shown\n", dropped);
+    }
+    for (uint32_t seq = first; seq <= log->last_sequence; seq++) {
+      PinggyExceptionRecord *record =
+          &log->records[seq % PINGGY_EXCEPTION_HISTORY_SIZE];
+      used += snprintf(text + used, size - used, "Pinggy Exception: %s: %s\n",
+                       record->where ? record->where : "",
+                       record->what ? record->what : "");
+    }
+  }
+  log->echoed_sequence = log->last_sequence;
+  uv_mutex_unlock(&log->lock);
+
+  if (text != NULL) {
+    fwrite(text, 1, used, stdout);
+    fflush(stdout);
+    free(text);
+  }
 }
 
-char *get_tls_exception_type() { return g_exception_type; }
-char *get_tls_exception_message() { return g_exception_message; }
+/* Records an exception. Returns 0 if the caller has to echo it itself. */
+static int log_append(PinggyExceptionLog *log, const char *where,
+                      const char *what) {
+  if (log == NULL) {
+    return 0;
+  }
+  char *where_copy = copy_bounded(where);
+  char *what_copy = copy_bounded(what);
+  uv_timeval64_t now;
+  uv_gettimeofday(&now);
 
-void clear_tls_exception() {
-#ifdef _WIN32
-  EnterCriticalSection(&g_exception_lock);
-#else
-  pthread_mutex_lock(&g_exception_lock);
-#endif
-  g_exception_type[0] = '\0';
-  g_exception_message[0] = '\0';
-#ifdef _WIN32
-  LeaveCriticalSection(&g_exception_lock);
-#else
-  pthread_mutex_unlock(&g_exception_lock);
-#endif
+  uv_mutex_lock(&log->lock);
+  uint32_t sequence = ++log->last_sequence;
+  PinggyExceptionRecord *record =
+      &log->records[sequence % PINGGY_EXCEPTION_HISTORY_SIZE];
+  char *old_where = record->where, *old_what = record->what;
+  record->sequence = sequence;
+  record->timestamp = (double)now.tv_sec * 1000.0 + (double)now.tv_usec / 1000.0;
+  record->thread = thread_number();
+  record->tunnel = g_thread_tunnel;
+  record->where = where_copy;
+  record->what = what_copy;
+  int echoed = log->echo_open;
+  if (echoed) {
+    uv_async_send(&log->echo);
+  } else {
+    log->echoed_sequence = sequence;
+  }
+  uv_mutex_unlock(&log->lock);
+
+  free(old_where);
+  free(old_what);
+  return echoed;
+}
+
+static void log_echo_closed(uv_handle_t *handle) {
+  PinggyExceptionLog *log = (PinggyExceptionLog *)handle->data;
+  napi_remove_async_cleanup_hook(log->echo_cleanup);
+}
+
+static void log_env_cleanup(napi_async_cleanup_hook_handle handle, void *arg) {
+  PinggyExceptionLog *log = (PinggyExceptionLog *)arg;
+  uv_mutex_lock(&log->lock);
+  log->echo_open = 0;
+  uv_mutex_unlock(&log->lock);
+  log_echo(&log->echo);
+  uv_close((uv_handle_t *)&log->echo, log_echo_closed);
+}
+
+static PinggyExceptionLog *log_create(napi_env env) {
+  uv_loop_t *loop;
+  if (napi_get_uv_event_loop(env, &loop) != napi_ok) {
+    return NULL;
+  }
+  PinggyExceptionLog *log =
+      (PinggyExceptionLog *)calloc(1, sizeof(PinggyExceptionLog));
+  if (log == NULL) {
+    return NULL;
+  }
+  if (uv_mutex_init(&log->lock) != 0) {
+    free(log);
+    return NULL;
+  }
+  if (uv_async_init(loop, &log->echo, log_echo) != 0) {
+    uv_mutex_destroy(&log->lock);
+    free(log);
+    return NULL;
+  }
+  log->echo.data = log;
+  uv_unref((uv_handle_t *)&log->echo);
+  log->echo_open = 1;
+  napi_add_async_cleanup_hook(env, log_env_cleanup, log, &log->echo_cleanup);
+  return log;
+}
+
+void pinggy_exception_log_free(PinggyExceptionLog *log) {
+  if (log == NULL) {
+    return;
+  }
+  for (int i = 0; i < PINGGY_EXCEPTION_HISTORY_SIZE; i++) {
+    free(log->records[i].where);
+    free(log->records[i].what);
+  }
+  uv_mutex_destroy(&log->lock);
+  free(log);
+}
+
+/* ERR_PINGGY_<WHERE>: `where` upper-cased, other characters folded to '_'. */
+static void error_code(const char *where, char *code, size_t size) {
+  size_t used = (size_t)snprintf(code, size, "ERR_PINGGY_");
+  int underscore = 1;
+  for (const char *p = where ? where : ""; *p != '\0' && used + 1 < size; p++) {
+    char c = *p;
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+        (c >= '0' && c <= '9')) {
+      code[used++] = (c >= 'a' && c <= 'z') ? (char)(c - 'a' + 'A') : c;
+      underscore = 0;
+    } else if (!underscore) {
+      code[used++] = '_';
+      underscore = 1;
+    }
+  }
+  while (used > 0 && code[used - 1] == '_') {
+    used--;
+  }
+  code[used] = '\0';
+  if (strcmp(code, "ERR_PINGGY") == 0) {
+    snprintf(code, size, "ERR_PINGGY_EXCEPTION");
+  }
 }
 
 // --- Pinggy Exception Callback ---
 void PinggyExceptionHandler(const char *etype, const char *ewhat) {
+  PinggyInstance *instance = pinggy_instance_current();
   set_tls_exception(etype, ewhat);
-  printf("Pinggy Exception: %s: %s\n", etype, ewhat);
+  if (instance == NULL || !log_append(instance->exception_log, etype, ewhat)) {
+    printf("Pinggy Exception: %s: %s\n", etype, ewhat);
+  }
 }
 
 // --- N-API: Get Last Exception ---
+// getLastException(tunnelRef?): takes the pending exception, skipping one
+// raised for a different tunnel.
 napi_value GetLastException(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
   napi_value result;
-  char buffer[TLS_BUFFER_SIZE * 2];
+  char buffer[PINGGY_EXCEPTION_TEXT_SIZE];
+  pinggy_ref_t tunnel = INVALID_PINGGY_REF;
+  int has_exception = 0;
 
-  /* Lock while we read so we don't race with PinggyExceptionHandler. */
-#ifdef _WIN32
-  EnterCriticalSection(&g_exception_lock);
-#else
-  pthread_mutex_lock(&g_exception_lock);
-#endif
+  napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+  if (argc >= 1) {
+    uint32_t tunnel_ref;
+    if (napi_get_value_uint32(env, args[0], &tunnel_ref) == napi_ok) {
+      tunnel = (pinggy_ref_t)tunnel_ref;
+    }
+  }
 
-  int has_exception = (g_exception_type[0] != '\0');
-  if (has_exception) {
-    snprintf(buffer, sizeof(buffer), "%s  %s", g_exception_type,
-             g_exception_message);
-    g_exception_type[0] = '\0';
-    g_exception_message[0] = '\0';
+  if (g_thread_exception.pending &&
+      slot_matches(&g_thread_exception, tunnel)) {
+    snprintf(buffer, sizeof(buffer), "%s  %s", g_thread_exception.type,
+             g_thread_exception.message);
+    g_thread_exception.pending = 0;
+    has_exception = 1;
   }
 
-#ifdef _WIN32
-  LeaveCriticalSection(&g_exception_lock);
-#else
-  pthread_mutex_unlock(&g_exception_lock);
-#endif
+  PinggyInstance *instance = pinggy_instance_get(env);
+  if (!has_exception && instance != NULL &&
+      PINGGY_ATOMIC_LOAD32(&instance->remote_exception.pending)) {
+    uv_mutex_lock(&instance->exception_lock);
+    PinggyExceptionSlot *remote = &instance->remote_exception;
+    if (remote->pending && slot_matches(remote, tunnel)) {
+      snprintf(buffer, sizeof(buffer), "%s  %s", remote->type,
+               remote->message);
+      PINGGY_ATOMIC_STORE32(&remote->pending, 0);
+      has_exception = 1;
+    }
+    uv_mutex_unlock(&instance->exception_lock);
+  }
 
   if (!has_exception) {
     napi_get_null(env, &result);
@@ -123,19 +345,151 @@ napi_value GetLastException(napi_env env, napi_callback_info info) {
   return result;
 }
 
+int pinggy_exception_take_remote(napi_env env, pinggy_ref_t tunnel,
+                                 char *buffer, size_t size) {
+  PinggyInstance *instance = pinggy_instance_get(env);
+  int taken = 0;
+  if (instance == NULL ||
+      !PINGGY_ATOMIC_LOAD32(&instance->remote_exception.pending)) {
+    return 0;
+  }
+  uv_mutex_lock(&instance->exception_lock);
+  PinggyExceptionSlot *remote = &instance->remote_exception;
+  if (remote->pending && remote->tunnel == tunnel) {
+    snprintf(buffer, size, "%s  %s", remote->type, remote->message);
+    PINGGY_ATOMIC_STORE32(&remote->pending, 0);
+    taken = 1;
+  }
+  uv_mutex_unlock(&instance->exception_lock);
+  return taken;
+}
+
+static napi_value history_entry(napi_env env,
+                                const PinggyExceptionRecord *record) {
+  napi_value error, code, message, value;
+  char code_text[64];
+  const char *where = record->where ? record->where : "";
+  const char *what = record->what ? record->what : "";
+  size_t text_len = strlen(where) + strlen(what) + 3;
+  char *text = (char *)malloc(text_len);
+  if (text == NULL) {
+    return NULL;
+  }
+  snprintf(text, text_len, "%s: %s", where, what);
+
+  error_code(where, code_text, sizeof(code_text));
+  napi_create_string_utf8(env, code_text, NAPI_AUTO_LENGTH, &code);
+  napi_create_string_utf8(env, text, NAPI_AUTO_LENGTH, &message);
+  free(text);
+  if (napi_create_error(env, code, message, &error) != napi_ok) {
+    return NULL;
+  }
+
+  napi_create_string_utf8(env, where, NAPI_AUTO_LENGTH, &value);
+  napi_set_named_property(env, error, "where", value);
+  napi_create_string_utf8(env, what, NAPI_AUTO_LENGTH, &value);
+  napi_set_named_property(env, error, "what", value);
+  napi_create_uint32(env, record->tunnel, &value);
+  napi_set_named_property(env, error, "tunnelRef", value);
+  napi_create_uint32(env, record->thread, &value);
+  napi_set_named_property(env, error, "thread", value);
+  napi_create_double(env, record->timestamp, &value);
+  napi_set_named_property(env, error, "timestamp", value);
+  napi_create_uint32(env, record->sequence, &value);
+  napi_set_named_property(env, error, "sequence", value);
+  return error;
+}
+
+// --- N-API: Exception History ---
+// getExceptionHistory(afterSequence?): the env's recent exceptions, oldest
+// first, as Error objects with a stable `code`.
+napi_value GetExceptionHistory(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value args[1];
+  napi_value result;
+  uint32_t after = 0;
+  PinggyExceptionRecord records[PINGGY_EXCEPTION_HISTORY_SIZE];
+  uint32_t count = 0;
+
+  napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+  if (argc >= 1) {
+    napi_get_value_uint32(env, args[0], &after);
+  }
+
+  PinggyInstance *instance = pinggy_instance_get(env);
+  PinggyExceptionLog *log = instance != NULL ? instance->exception_log : NULL;
+  if (log != NULL) {
+    /* Copy out under the lock; JS values are made without it. */
+    uv_mutex_lock(&log->lock);
+    uint32_t first = log->last_sequence > PINGGY_EXCEPTION_HISTORY_SIZE
+                         ? log->last_sequence - PINGGY_EXCEPTION_HISTORY_SIZE + 1
+                         : 1;
+    if (first <= after) {
+      first = after + 1;
+    }
+    for (uint32_t seq = first; seq <= log->last_sequence; seq++) {
+      records[count] = log->records[seq % PINGGY_EXCEPTION_HISTORY_SIZE];
+      records[count].where = copy_bounded(records[count].where);
+      records[count].what = copy_bounded(records[count].what);
+      count++;
+    }
+    uv_mutex_unlock(&log->lock);
+  }
+
+  napi_create_array_with_length(env, count, &result);
+  for (uint32_t i = 0; i < count; i++) {
+    napi_value entry = history_entry(env, &records[i]);
+    if (entry != NULL) {
+      napi_set_element(env, result, i, entry);
+    }
+    free(records[i].where);
+    free(records[i].what);
+  }
+  return result;
+}
+
+static void generation_view_finalize(napi_env env, void *data, void *hint) {
+  pinggy_instance_release((PinggyInstance *)hint);
+}
+
+// --- N-API: Exception Generation View ---
+// getExceptionGenerationView(): Int32Array over the env's exception
+// generation counter, or null where external buffers are not allowed.
+napi_value GetExceptionGenerationView(napi_env env, napi_callback_info info) {
+  napi_value buffer, result;
+  PinggyInstance *instance = pinggy_instance_get(env);
+
+  if (instance == NULL) {
+    napi_get_null(env, &result);
+    return result;
+  }
+  pinggy_instance_retain(instance);
+  if (napi_create_external_arraybuffer(
+          env, &instance->exception_generation, sizeof(int32_t),
+          generation_view_finalize, instance, &buffer) != napi_ok) {
+    pinggy_instance_release(instance);
+    /* e.g. napi_no_external_buffers_allowed; callers poll instead. */
+    napi_get_null(env, &result);
+    return result;
+  }
+  napi_create_typedarray(env, napi_int32_array, 1, buffer, 0, &result);
+  return result;
+}
+
 // --- N-API: Init Exception Handling ---
 napi_value InitExceptionHandling(napi_env env, napi_callback_info info) {
-  init_tls();
   pinggy_set_on_exception_callback(PinggyExceptionHandler);
   return NULL;
 }
 
-// --- N-API: Cleanup Hook ---
-void Cleanup(void *arg) { cleanup_tls(); }
-
 // Module initialization
 napi_value Init3(napi_env env, napi_value exports) {
-  napi_value fnInit, fnGetLast;
+  napi_value fnInit, fnGetLast, fnGeneration, fnHistory;
+  PinggyInstance *instance = pinggy_instance_get(env);
+
+  if (instance != NULL && instance->exception_log == NULL) {
+    instance->exception_log = log_create(env);
+  }
 
   napi_create_function(env, NULL, 0, InitExceptionHandling, NULL, &fnInit);
   napi_set_named_property(env, exports, "initExceptionHandling", fnInit);
@@ -143,6 +497,13 @@ napi_value Init3(napi_env env, napi_value exports) {
   napi_create_function(env, NULL, 0, GetLastException, NULL, &fnGetLast);
   napi_set_named_property(env, exports, "getLastException", fnGetLast);
 
-  napi_add_env_cleanup_hook(env, Cleanup, NULL);
+  napi_create_function(env, NULL, 0, GetExceptionGenerationView, NULL,
+                       &fnGeneration);
+  napi_set_named_property(env, exports, "getExceptionGenerationView",
+                          fnGeneration);
+
+  napi_create_function(env, NULL, 0, GetExceptionHistory, NULL, &fnHistory);
+  napi_set_named_property(env, exports, "getExceptionHistory", fnHistory);
+
   return exports;
 }
\ No newline at end of file
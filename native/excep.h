@@ -0,0 +1,36 @@
+#ifndef PINGGY_EXCEP_H
+#define PINGGY_EXCEP_H
+
+#include <node_api.h>
+#include <stdint.h>
+#include "../pinggy.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Ring of an env's recent exceptions with its console echo (excep.c).
+    typedef struct PinggyExceptionLog PinggyExceptionLog;
+
+    // Frees the ring once the instance holding it goes away.
+    void pinggy_exception_log_free(PinggyExceptionLog *log);
+
+    // Tags exceptions raised on the calling thread with `tunnel` (or
+    // INVALID_PINGGY_REF for none) and returns the previous tag.
+    pinggy_ref_t pinggy_exception_attribute(pinggy_ref_t tunnel);
+
+    // Number of exceptions libpinggy has raised on the calling thread so far;
+    // compare two readings to tell whether a call in between raised one.
+    uint32_t pinggy_exception_raised(void);
+
+    // Takes the exception another thread raised for `tunnel` (and only for
+    // it), formatted as getLastException returns it, so it is not reported
+    // again by a later call. Returns 0 if there is none. JS thread only.
+    int pinggy_exception_take_remote(napi_env env, pinggy_ref_t tunnel, char *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_EXCEP_H
@@ -0,0 +1,131 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdlib.h>
+#include "debug.h"
+#include "instance.h"
+#include "excep.h"
+#include "intern.h"
+
+#ifdef _WIN32
+#define PINGGY_THREAD_LOCAL __declspec(thread)
+#else
+#define PINGGY_THREAD_LOCAL __thread
+#endif
+
+static PINGGY_THREAD_LOCAL PinggyInstance *g_thread_instance = NULL;
+
+// Guards PinggyInstance.refs; only taken when a driver or async call starts
+// or ends.
+static uv_mutex_t g_instances_lock;
+static uv_once_t g_instances_once = UV_ONCE_INIT;
+
+static void instances_init_once(void)
+{
+    uv_mutex_init(&g_instances_lock);
+}
+
+static void instance_free(PinggyInstance *instance)
+{
+    pinggy_exception_log_free(instance->exception_log);
+    pinggy_scratch_free(&instance->scratch);
+    uv_mutex_destroy(&instance->exception_lock);
+    free(instance);
+}
+
+void pinggy_instance_retain(PinggyInstance *instance)
+{
+    if (instance == NULL)
+    {
+        return;
+    }
+    uv_once(&g_instances_once, instances_init_once);
+    uv_mutex_lock(&g_instances_lock);
+    instance->refs++;
+    uv_mutex_unlock(&g_instances_lock);
+}
+
+void pinggy_instance_release(PinggyInstance *instance)
+{
+    if (instance == NULL)
+    {
+        return;
+    }
+    uv_once(&g_instances_once, instances_init_once);
+    uv_mutex_lock(&g_instances_lock);
+    int last = --instance->refs == 0;
+    uv_mutex_unlock(&g_instances_lock);
+    if (last)
+    {
+        instance_free(instance);
+    }
+}
+
+static void instance_finalize(napi_env env, void *data, void *hint)
+{
+    (void)hint;
+    PinggyInstance *instance = (PinggyInstance *)data;
+    // The cache holds a reference into the env, so it goes now rather than
+    // with the last retain.
+    pinggy_intern_free(env, instance->interns);
+    instance->interns = NULL;
+    if (g_thread_instance == instance)
+    {
+        g_thread_instance = NULL;
+    }
+    pinggy_instance_release(instance);
+}
+
+napi_status pinggy_instance_init(napi_env env)
+{
+    PinggyInstance *instance = (PinggyInstance *)calloc(1, sizeof(PinggyInstance));
+    if (instance == NULL)
+    {
+        return napi_generic_failure;
+    }
+    instance->env = env;
+    instance->js_thread = uv_thread_self();
+    instance->debug_enabled = pinggy_debug_default();
+    instance->refs = 1;
+    if (uv_mutex_init(&instance->exception_lock) != 0)
+    {
+        free(instance);
+        return napi_generic_failure;
+    }
+
+    napi_status status = napi_set_instance_data(env, instance, instance_finalize, NULL);
+    if (status != napi_ok)
+    {
+        instance_free(instance);
+        return status;
+    }
+    g_thread_instance = instance;
+    return napi_ok;
+}
+
+PinggyInstance *pinggy_instance_get(napi_env env)
+{
+    void *data = NULL;
+    if (napi_get_instance_data(env, &data) != napi_ok)
+    {
+        return NULL;
+    }
+    return (PinggyInstance *)data;
+}
+
+PinggyInstance *pinggy_instance_current(void)
+{
+    return g_thread_instance;
+}
+
+int pinggy_instance_on_js_thread(PinggyInstance *instance)
+{
+    uv_thread_t self = uv_thread_self();
+    return instance != NULL && uv_thread_equal(&instance->js_thread, &self);
+}
+
+PinggyInstance *pinggy_instance_enter(PinggyInstance *instance)
+{
+    PinggyInstance *previous = g_thread_instance;
+    g_thread_instance = instance;
+    return previous;
+}
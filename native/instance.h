@@ -0,0 +1,95 @@
+#ifndef PINGGY_INSTANCE_H
+#define PINGGY_INSTANCE_H
+
+#include <node_api.h>
+#include <uv.h>
+#include <stdint.h>
+#include "../pinggy.h"
+#include "marshal.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PINGGY_EXCEPTION_BUFFER_SIZE 512
+// An exception's type and message joined by two spaces, as JS sees it.
+#define PINGGY_EXCEPTION_TEXT_SIZE (2 * PINGGY_EXCEPTION_BUFFER_SIZE + 2)
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PINGGY_ATOMIC_INC32(p) _InterlockedIncrement((volatile long *)(p))
+#define PINGGY_ATOMIC_LOAD32(p) _InterlockedOr((volatile long *)(p), 0)
+#define PINGGY_ATOMIC_STORE32(p, v) _InterlockedExchange((volatile long *)(p), (long)(v))
+#else
+#define PINGGY_ATOMIC_INC32(p) __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define PINGGY_ATOMIC_LOAD32(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define PINGGY_ATOMIC_STORE32(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+    // Last exception raised by libpinggy on one thread.
+    typedef struct PinggyExceptionSlot
+    {
+        int32_t pending;
+        pinggy_ref_t tunnel; // INVALID_PINGGY_REF when not raised for a tunnel
+        char type[PINGGY_EXCEPTION_BUFFER_SIZE];
+        char message[PINGGY_EXCEPTION_BUFFER_SIZE];
+    } PinggyExceptionSlot;
+
+    // Addon state owned by one env (the main thread or a worker), stored with
+    // napi_set_instance_data.
+    //
+    // libpinggy reports exceptions and the addon logs without any env at
+    // hand, so every thread working for an env binds its instance: the JS
+    // thread when the addon loads, pump and reactor threads for each resume
+    // of a driven tunnel, threadpool threads for each async call.
+    typedef struct PinggyInstance
+    {
+        napi_env env;
+        uv_thread_t js_thread;
+        int debug_enabled;
+
+        // Bumped on every exception raised for this env; JS polls it through
+        // an Int32Array and only asks for the exception when it moved.
+        int32_t exception_generation;
+
+        // The JS thread keeps its exceptions in a thread-local slot. Those
+        // raised on the env's other threads (pumps, reactors, async calls)
+        // land here instead.
+        uv_mutex_t exception_lock;
+        PinggyExceptionSlot remote_exception;
+
+        struct PinggyExceptionLog *exception_log; // recent exceptions, see excep.c
+
+        PinggyScratch scratch; // backs long strings passed to or from JS
+        struct PinggyInternTable *interns; // cached event strings, see intern.h; JS thread only
+
+        int refs; // the env's own reference plus one per pinggy_instance_retain
+    } PinggyInstance;
+
+    // Creates the env's instance and binds it to the calling (JS) thread.
+    napi_status pinggy_instance_init(napi_env env);
+
+    // The env's instance, or NULL before pinggy_instance_init. JS thread only.
+    PinggyInstance *pinggy_instance_get(napi_env env);
+
+    // The instance bound to the calling thread, or NULL.
+    PinggyInstance *pinggy_instance_current(void);
+
+    // Non-zero if the calling thread is the env's JS thread.
+    int pinggy_instance_on_js_thread(PinggyInstance *instance);
+
+    // Binds `instance` (may be NULL) to the calling thread and returns the
+    // previous binding, to be restored with another call.
+    PinggyInstance *pinggy_instance_enter(PinggyInstance *instance);
+
+    // Keep an instance usable from another thread past the env's teardown.
+    // Both accept NULL.
+    void pinggy_instance_retain(PinggyInstance *instance);
+    void pinggy_instance_release(PinggyInstance *instance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_INSTANCE_H
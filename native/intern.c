@@ -0,0 +1,131 @@
+#include <node_api.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "instance.h"
+#include "marshal.h"
+#include "intern.h"
+
+#define PINGGY_INTERN_SLOTS 512 // power of two
+
+typedef struct InternSlot
+{
+    uint32_t hash;
+    uint32_t length;
+    char *bytes; // NULL while the slot is empty
+} InternSlot;
+
+struct PinggyInternTable
+{
+    napi_ref strings; // Array; element i holds the string of slots[i]
+    InternSlot slots[PINGGY_INTERN_SLOTS];
+};
+
+static uint32_t intern_hash(const char *data, size_t length)
+{
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static PinggyInternTable *intern_table(napi_env env)
+{
+    PinggyInstance *instance = pinggy_instance_get(env);
+    if (instance == NULL)
+    {
+        return NULL;
+    }
+    if (instance->interns != NULL)
+    {
+        return instance->interns;
+    }
+
+    PinggyInternTable *table = (PinggyInternTable *)calloc(1, sizeof(PinggyInternTable));
+    if (table == NULL)
+    {
+        return NULL;
+    }
+    napi_value strings;
+    if (napi_create_array_with_length(env, PINGGY_INTERN_SLOTS, &strings) != napi_ok ||
+        napi_create_reference(env, strings, 1, &table->strings) != napi_ok)
+    {
+        free(table);
+        return NULL;
+    }
+    instance->interns = table;
+    return table;
+}
+
+napi_status pinggy_string_intern(napi_env env, const char *data, size_t length, napi_value *result)
+{
+    if (length == NAPI_AUTO_LENGTH)
+    {
+        length = strlen(data);
+    }
+    PinggyInternTable *table = length <= PINGGY_INTERN_MAX_LENGTH ? intern_table(env) : NULL;
+    if (table == NULL)
+    {
+        return pinggy_string_create(env, data, length, result);
+    }
+
+    uint32_t hash = intern_hash(data, length);
+    uint32_t index = hash & (PINGGY_INTERN_SLOTS - 1);
+    InternSlot *slot = &table->slots[index];
+
+    napi_value strings;
+    napi_status status = napi_get_reference_value(env, table->strings, &strings);
+    if (status != napi_ok)
+    {
+        return pinggy_string_create(env, data, length, result);
+    }
+    if (slot->bytes != NULL && slot->hash == hash && slot->length == length && memcmp(slot->bytes, data, length) == 0)
+    {
+        status = napi_get_element(env, strings, index, result);
+        if (status == napi_ok)
+        {
+            return status;
+        }
+    }
+
+    status = pinggy_string_create(env, data, length, result);
+    if (status != napi_ok)
+    {
+        return status;
+    }
+    // A failed store only costs a miss next time.
+    char *bytes = (char *)realloc(slot->bytes, length > 0 ? length : 1);
+    if (bytes == NULL)
+    {
+        return status;
+    }
+    if (napi_set_element(env, strings, index, *result) != napi_ok)
+    {
+        free(bytes);
+        slot->bytes = NULL;
+        return status;
+    }
+    memcpy(bytes, data, length);
+    slot->bytes = bytes;
+    slot->hash = hash;
+    slot->length = (uint32_t)length;
+    return status;
+}
+
+void pinggy_intern_free(napi_env env, PinggyInternTable *table)
+{
+    if (table == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < PINGGY_INTERN_SLOTS; i++)
+    {
+        free(table->slots[i].bytes);
+    }
+    napi_delete_reference(env, table->strings);
+    free(table);
+}
@@ -0,0 +1,37 @@
+#ifndef PINGGY_INTERN_H
+#define PINGGY_INTERN_H
+
+#include <node_api.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Per-env cache of short JS strings the addon creates over and over: the
+    // tunnel's URLs, bind addresses and forwarding types, repeated on every
+    // established, reconnection and forwarding event.
+    //
+    // Slots are direct-mapped by hash; a colliding string replaces the
+    // previous one. NAPI 8 cannot reference a string directly, so the
+    // strings live in a JS array the table references strongly. JS thread
+    // only.
+
+    // Longest string worth caching; longer ones are created every time.
+#define PINGGY_INTERN_MAX_LENGTH 256
+
+    typedef struct PinggyInternTable PinggyInternTable;
+
+    // Returns the cached JS string equal to `data`, creating and caching it
+    // on a miss. `length` may be NAPI_AUTO_LENGTH.
+    napi_status pinggy_string_intern(napi_env env, const char *data, size_t length, napi_value *result);
+
+    // Drops the env's table; called from the instance finalizer.
+    void pinggy_intern_free(napi_env env, PinggyInternTable *table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_INTERN_H
@@ -0,0 +1,187 @@
+#include <node_api.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../pinggy.h"
+#include "instance.h"
+#include "marshal.h"
+#include "ascii.h"
+
+// Smallest arena block, and the largest one kept once no string uses it.
+#define PINGGY_SCRATCH_MIN_SIZE 4096
+#define PINGGY_SCRATCH_KEEP_SIZE (1024 * 1024)
+
+static void string_init(PinggyString *str)
+{
+    str->data = str->inline_data;
+    str->length = 0;
+    str->storage = PINGGY_STRING_INLINE;
+    str->reserved = sizeof(str->inline_data);
+    str->inline_data[0] = '\0';
+}
+
+// Makes room for `size` bytes at the arena's top. A block in use cannot
+// move, so it only grows while no string lives in it.
+static int scratch_fit(PinggyScratch *scratch, size_t size)
+{
+    if (scratch->capacity - scratch->used >= size)
+    {
+        return 1;
+    }
+    if (scratch->live > 0)
+    {
+        return 0;
+    }
+    size_t capacity = scratch->capacity > 0 ? scratch->capacity : PINGGY_SCRATCH_MIN_SIZE;
+    while (capacity < size)
+    {
+        capacity *= 2;
+    }
+    char *base = (char *)malloc(capacity);
+    if (base == NULL)
+    {
+        return 0;
+    }
+    free(scratch->base);
+    scratch->base = base;
+    scratch->capacity = capacity;
+    scratch->used = 0;
+    return 1;
+}
+
+// Points `str` at `size` writable bytes outside its inline buffer.
+static int string_reserve(napi_env env, PinggyString *str, size_t size)
+{
+    PinggyInstance *instance = pinggy_instance_get(env);
+    if (instance != NULL && scratch_fit(&instance->scratch, size))
+    {
+        PinggyScratch *scratch = &instance->scratch;
+        str->data = scratch->base + scratch->used;
+        str->storage = PINGGY_STRING_SCRATCH;
+        scratch->used += size;
+        scratch->live++;
+    }
+    else
+    {
+        str->data = (char *)malloc(size);
+        if (str->data == NULL)
+        {
+            string_init(str);
+            return 0;
+        }
+        str->storage = PINGGY_STRING_HEAP;
+    }
+    str->reserved = size;
+    str->data[0] = '\0';
+    return 1;
+}
+
+void pinggy_string_release(napi_env env, PinggyString *str)
+{
+    if (str->storage == PINGGY_STRING_SCRATCH)
+    {
+        PinggyInstance *instance = pinggy_instance_get(env);
+        PinggyScratch *scratch = &instance->scratch;
+        if (str->data + str->reserved == scratch->base + scratch->used)
+        {
+            scratch->used -= str->reserved;
+        }
+        if (--scratch->live == 0)
+        {
+            scratch->used = 0;
+            if (scratch->capacity > PINGGY_SCRATCH_KEEP_SIZE)
+            {
+                pinggy_scratch_free(scratch);
+            }
+        }
+    }
+    else if (str->storage == PINGGY_STRING_HEAP)
+    {
+        free(str->data);
+    }
+    string_init(str);
+}
+
+napi_status pinggy_string_from_js(napi_env env, napi_value value, PinggyString *out)
+{
+    string_init(out);
+    napi_status status = napi_get_value_string_utf8(env, value, out->inline_data, sizeof(out->inline_data), &out->length);
+    // napi stops before a character that does not fit, so only a copy
+    // ending within 4 bytes of the buffer's end may have been cut short.
+    if (status != napi_ok || out->length + 4 < sizeof(out->inline_data))
+    {
+        return status;
+    }
+
+    size_t length;
+    status = napi_get_value_string_utf8(env, value, NULL, 0, &length);
+    if (status != napi_ok || length == out->length)
+    {
+        return status;
+    }
+    if (!string_reserve(env, out, length + 1))
+    {
+        return napi_generic_failure;
+    }
+    status = napi_get_value_string_utf8(env, value, out->data, length + 1, &out->length);
+    if (status != napi_ok)
+    {
+        pinggy_string_release(env, out);
+    }
+    return status;
+}
+
+int pinggy_string_from_native(napi_env env, pinggy_ref_t ref, PinggyStringGetter get, PinggyString *out)
+{
+    string_init(out);
+    pinggy_capa_t required = 0;
+    int rc = get(ref, (pinggy_capa_t)out->reserved, out->data, &required);
+    // Also retry on an exact fit, in case `required` left out the terminator.
+    if (required >= out->reserved)
+    {
+        if (!string_reserve(env, out, (size_t)required + 1))
+        {
+            return -1;
+        }
+        rc = get(ref, (pinggy_capa_t)out->reserved, out->data, &required);
+    }
+    if (rc < 0)
+    {
+        pinggy_string_release(env, out);
+        return rc;
+    }
+
+    size_t limit = out->reserved - 1;
+    if ((size_t)required < limit)
+    {
+        limit = (size_t)required;
+    }
+    out->data[out->reserved - 1] = '\0';
+    out->length = strnlen(out->data, limit);
+    return 0;
+}
+
+napi_status pinggy_string_to_js(napi_env env, const PinggyString *str, napi_value *result)
+{
+    return pinggy_string_create(env, str->data, str->length, result);
+}
+
+napi_status pinggy_string_create(napi_env env, const char *data, size_t length, napi_value *result)
+{
+    if (length == NAPI_AUTO_LENGTH)
+    {
+        length = strlen(data);
+    }
+    if (pinggy_is_ascii(data, length))
+    {
+        return napi_create_string_latin1(env, data, length, result);
+    }
+    return napi_create_string_utf8(env, data, length, result);
+}
+
+void pinggy_scratch_free(PinggyScratch *scratch)
+{
+    free(scratch->base);
+    scratch->base = NULL;
+    scratch->capacity = 0;
+    scratch->used = 0;
+}
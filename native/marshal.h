@@ -0,0 +1,76 @@
+#ifndef PINGGY_MARSHAL_H
+#define PINGGY_MARSHAL_H
+
+#include <node_api.h>
+#include <stddef.h>
+#include "../pinggy.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // String marshalling for the JS-facing wrappers. JS thread only.
+    //
+    // A string is copied once, into a buffer inside PinggyString when it is
+    // short and into the env's scratch arena otherwise. The arena keeps its
+    // memory between calls, so a wrapper does no heap allocation once the
+    // arena has grown to the env's largest string. Release strings in the
+    // reverse order they were read.
+
+#define PINGGY_STRING_INLINE_SIZE 256
+
+    typedef enum
+    {
+        PINGGY_STRING_INLINE = 0,
+        PINGGY_STRING_SCRATCH,
+        PINGGY_STRING_HEAP, // arena unavailable or busy with a larger string
+    } PinggyStringStorage;
+
+    typedef struct PinggyString
+    {
+        char *data; // NUL-terminated UTF-8
+        size_t length;
+        PinggyStringStorage storage;
+        size_t reserved; // bytes available at data
+        char inline_data[PINGGY_STRING_INLINE_SIZE];
+    } PinggyString;
+
+    // libpinggy's `*_len` getters: copy the value when it fits in the buffer
+    // and report the size it needs, terminator included.
+    typedef pinggy_const_int_t (*PinggyStringGetter)(pinggy_ref_t ref, pinggy_capa_t capacity,
+                                                     pinggy_char_p_t buffer, pinggy_capa_p_t required);
+
+    // Copies a JS string. Returns napi_string_expected for a non-string.
+    napi_status pinggy_string_from_js(napi_env env, napi_value value, PinggyString *out);
+
+    // Reads a value of `ref` through `get`. Returns the getter's negative
+    // result on failure, or -1 when out of memory; `out` needs no release
+    // then.
+    int pinggy_string_from_native(napi_env env, pinggy_ref_t ref, PinggyStringGetter get, PinggyString *out);
+
+    napi_status pinggy_string_to_js(napi_env env, const PinggyString *str, napi_value *result);
+
+    // Creates a JS string from UTF-8 text (`length` may be NAPI_AUTO_LENGTH).
+    // Pure ASCII, the usual case for URLs, tokens and JSON, is handed to V8
+    // as Latin-1, which it copies without decoding.
+    napi_status pinggy_string_create(napi_env env, const char *data, size_t length, napi_value *result);
+
+    void pinggy_string_release(napi_env env, PinggyString *str);
+
+    // Per-env arena behind PinggyString (see PinggyInstance.scratch).
+    typedef struct PinggyScratch
+    {
+        char *base;
+        size_t capacity;
+        size_t used;
+        int live; // strings currently backed by the arena
+    } PinggyScratch;
+
+    void pinggy_scratch_free(PinggyScratch *scratch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_MARSHAL_H
@@ -0,0 +1,337 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "helper_macro.h"
+#include "event.h"
+#include "promise.h"
+#include "callbacks.h"
+#include "intern.h"
+
+#define START_CB_ESTABLISHED 0x1
+#define START_CB_FAILED 0x2
+#define START_CB_DISCONNECTED 0x4
+#define START_CB_ERROR 0x8
+#define START_CB_RECONNECTED 0x10
+
+static const PinggyEventType start_events[] = {
+    PINGGY_EVENT_TUNNEL_ESTABLISHED,
+    PINGGY_EVENT_TUNNEL_FAILED,
+    PINGGY_EVENT_DISCONNECTED,
+    PINGGY_EVENT_TUNNEL_ERROR,
+    PINGGY_EVENT_RECONNECTION_COMPLETED,
+};
+
+typedef struct StartPromise
+{
+    pinggy_ref_t tunnel;
+    napi_env env;
+    napi_deferred deferred; // NULL until armed
+    int callbacks;          // START_CB_* registered by JS
+    struct StartPromise *next;
+} StartPromise;
+
+static StartPromise *g_promises = NULL;
+static uv_mutex_t g_promises_lock;
+static uv_once_t g_promises_once = UV_ONCE_INIT;
+
+static void promises_init_once(void)
+{
+    uv_mutex_init(&g_promises_lock);
+}
+
+static int start_callback_bit(PinggyEventType type)
+{
+    switch (type)
+    {
+    case PINGGY_EVENT_TUNNEL_ESTABLISHED:
+        return START_CB_ESTABLISHED;
+    case PINGGY_EVENT_TUNNEL_FAILED:
+        return START_CB_FAILED;
+    case PINGGY_EVENT_DISCONNECTED:
+        return START_CB_DISCONNECTED;
+    case PINGGY_EVENT_TUNNEL_ERROR:
+        return START_CB_ERROR;
+    case PINGGY_EVENT_RECONNECTION_COMPLETED:
+        return START_CB_RECONNECTED;
+    default:
+        return 0;
+    }
+}
+
+// Non-zero if the event settles a start promise; only unrecoverable errors do.
+static int settles_start(const PinggyEvent *event)
+{
+    if (event->type == PINGGY_EVENT_TUNNEL_ERROR)
+    {
+        return !event->flag;
+    }
+    return start_callback_bit(event->type) != 0;
+}
+
+// Rejects `deferred` with an Error carrying `text`.
+static void reject_start(napi_env env, napi_deferred deferred, const char *text)
+{
+    napi_handle_scope scope;
+    if (napi_open_handle_scope(env, &scope) != napi_ok)
+    {
+        return;
+    }
+    napi_value message, error;
+    napi_create_string_utf8(env, text, NAPI_AUTO_LENGTH, &message);
+    napi_create_error(env, NULL, message, &error);
+    napi_reject_deferred(env, deferred, error);
+    napi_close_handle_scope(env, scope);
+}
+
+// Caller holds g_promises_lock.
+static StartPromise *promise_find(pinggy_ref_t tunnel)
+{
+    for (StartPromise *it = g_promises; it != NULL; it = it->next)
+    {
+        if (it->tunnel == tunnel)
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+// Caller holds g_promises_lock.
+static StartPromise *promise_get(pinggy_ref_t tunnel)
+{
+    StartPromise *entry = promise_find(tunnel);
+    if (entry != NULL)
+    {
+        return entry;
+    }
+    entry = (StartPromise *)calloc(1, sizeof(StartPromise));
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+    entry->tunnel = tunnel;
+    entry->next = g_promises;
+    g_promises = entry;
+    return entry;
+}
+
+void tunnel_start_promise_note(pinggy_ref_t tunnel, PinggyEventType type)
+{
+    int bit = start_callback_bit(type);
+    if (bit == 0)
+    {
+        return;
+    }
+    uv_once(&g_promises_once, promises_init_once);
+    uv_mutex_lock(&g_promises_lock);
+    StartPromise *entry = promise_get(tunnel);
+    if (entry != NULL)
+    {
+        entry->callbacks |= bit;
+    }
+    uv_mutex_unlock(&g_promises_lock);
+}
+
+int tunnel_start_promise_wants(const PinggyEvent *event)
+{
+    int wants = 0;
+    if (!settles_start(event))
+    {
+        return 0;
+    }
+    uv_once(&g_promises_once, promises_init_once);
+    uv_mutex_lock(&g_promises_lock);
+    StartPromise *entry = promise_find(event->tunnel);
+    wants = entry != NULL && entry->deferred != NULL;
+    uv_mutex_unlock(&g_promises_lock);
+    return wants;
+}
+
+void tunnel_start_promise_settle(napi_env env, const PinggyEvent *event)
+{
+    if (!settles_start(event))
+    {
+        return;
+    }
+
+    napi_deferred deferred = NULL;
+    uv_once(&g_promises_once, promises_init_once);
+    uv_mutex_lock(&g_promises_lock);
+    StartPromise *entry = promise_find(event->tunnel);
+    if (entry != NULL && entry->deferred != NULL && (env == NULL || entry->env == env))
+    {
+        // The entry stays: it also remembers which callbacks JS registered.
+        env = entry->env;
+        deferred = entry->deferred;
+        entry->deferred = NULL;
+        entry->env = NULL;
+    }
+    uv_mutex_unlock(&g_promises_lock);
+    if (deferred == NULL)
+    {
+        return;
+    }
+
+    napi_handle_scope scope;
+    if (napi_open_handle_scope(env, &scope) != napi_ok)
+    {
+        return;
+    }
+
+    napi_value value;
+    // A tunnel that reconnected before it was first established is up too.
+    if (event->type == PINGGY_EVENT_TUNNEL_ESTABLISHED || event->type == PINGGY_EVENT_RECONNECTION_COMPLETED)
+    {
+        napi_create_array_with_length(env, event->num_list, &value);
+        for (pinggy_len_t i = 0; i < event->num_list; i++)
+        {
+            napi_value url;
+            pinggy_string_intern(env, event->list[i] ? event->list[i] : "", NAPI_AUTO_LENGTH, &url);
+            napi_set_element(env, value, i, url);
+        }
+        napi_resolve_deferred(env, deferred, value);
+    }
+    else
+    {
+        const char *text = event->num_strings > 0 && event->strings[0] != NULL ? event->strings[0] : "";
+        if (text[0] == '\0')
+        {
+            text = event->type == PINGGY_EVENT_TUNNEL_FAILED  ? "Tunnel failed"
+                   : event->type == PINGGY_EVENT_TUNNEL_ERROR ? "Unrecoverable tunnel error"
+                                                              : "Tunnel disconnected";
+        }
+        napi_value message;
+        napi_create_string_utf8(env, text, NAPI_AUTO_LENGTH, &message);
+        napi_create_error(env, NULL, message, &value);
+        napi_reject_deferred(env, deferred, value);
+    }
+    napi_close_handle_scope(env, scope);
+    PINGGY_DEBUG("start promise for tunnel %u settled by event %d", (unsigned)event->tunnel, (int)event->type);
+}
+
+void tunnel_start_promise_cancel(napi_env env, pinggy_ref_t tunnel, const char *reason)
+{
+    StartPromise *entry = NULL;
+    uv_once(&g_promises_once, promises_init_once);
+    uv_mutex_lock(&g_promises_lock);
+    for (StartPromise **it = &g_promises; *it != NULL; it = &(*it)->next)
+    {
+        if ((*it)->tunnel == tunnel && ((*it)->deferred == NULL || (*it)->env == env))
+        {
+            entry = *it;
+            *it = entry->next;
+            break;
+        }
+    }
+    uv_mutex_unlock(&g_promises_lock);
+    if (entry == NULL)
+    {
+        return;
+    }
+    if (entry->deferred != NULL)
+    {
+        reject_start(env, entry->deferred, reason);
+        PINGGY_DEBUG("start promise for tunnel %u rejected: %s", (unsigned)tunnel, reason);
+    }
+    free(entry);
+}
+
+// Rejects the promises still armed by an env that is going away. Whether JS
+// still runs then is up to Node; the entries are freed either way.
+static void promises_env_cleanup(void *arg)
+{
+    napi_env env = (napi_env)arg;
+    StartPromise *armed = NULL;
+    uv_mutex_lock(&g_promises_lock);
+    for (StartPromise **it = &g_promises; *it != NULL;)
+    {
+        StartPromise *entry = *it;
+        if (entry->deferred != NULL && entry->env == env)
+        {
+            *it = entry->next;
+            entry->next = armed;
+            armed = entry;
+        }
+        else
+        {
+            it = &entry->next;
+        }
+    }
+    uv_mutex_unlock(&g_promises_lock);
+    while (armed != NULL)
+    {
+        StartPromise *next = armed->next;
+        reject_start(env, armed->deferred, "Tunnel environment is shutting down");
+        free(armed);
+        armed = next;
+    }
+}
+
+// tunnelStartPromise(tunnelRef): a Promise for the tunnel's public URLs.
+// Arm it before starting the tunnel.
+napi_value TunnelStartPromise(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (tunnel ref)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected argument to be an unsigned integer (tunnel ref)");
+    pinggy_ref_t tunnel = (pinggy_ref_t)tunnel_ref;
+
+    napi_deferred deferred;
+    napi_value promise;
+    status = napi_create_promise(env, &deferred, &promise);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create promise");
+
+    uv_once(&g_promises_once, promises_init_once);
+    uv_mutex_lock(&g_promises_lock);
+    StartPromise *entry = promise_get(tunnel);
+    int armed = entry != NULL && entry->deferred == NULL;
+    int callbacks = 0;
+    if (armed)
+    {
+        entry->env = env;
+        entry->deferred = deferred;
+        callbacks = entry->callbacks;
+    }
+    uv_mutex_unlock(&g_promises_lock);
+
+    if (!armed)
+    {
+        reject_start(env, deferred, entry == NULL ? "Failed to allocate start promise" : "Tunnel already has a pending start promise");
+        return promise;
+    }
+
+    // Make libpinggy report the outcome even if JS has not asked for it.
+    for (size_t i = 0; i < sizeof(start_events) / sizeof(start_events[0]); i++)
+    {
+        if (!(callbacks & start_callback_bit(start_events[i])))
+        {
+            tunnel_set_event_trampoline(tunnel, start_events[i], NULL);
+        }
+    }
+
+    return promise;
+}
+
+napi_value InitPromise(napi_env env, napi_value exports)
+{
+    napi_value start_promise_fn;
+
+    uv_once(&g_promises_once, promises_init_once);
+    napi_add_env_cleanup_hook(env, promises_env_cleanup, env);
+
+    napi_create_function(env, NULL, 0, TunnelStartPromise, NULL, &start_promise_fn);
+    napi_set_named_property(env, exports, "tunnelStartPromise", start_promise_fn);
+
+    return exports;
+}
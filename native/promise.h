@@ -0,0 +1,45 @@
+#ifndef PINGGY_PROMISE_H
+#define PINGGY_PROMISE_H
+
+#include <node_api.h>
+#include "../pinggy.h"
+#include "event.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Start promises: a deferred per tunnel that the established (or
+    // reconnection completed), failed, disconnected and unrecoverable error
+    // callbacks settle directly, without a JS round trip. Everything else
+    // that ends a start attempt (the start call failing, a stop, polling
+    // giving up, the tunnel being freed, the env going away) rejects it
+    // through tunnel_start_promise_cancel, so an armed deferred never
+    // outlives its tunnel.
+    //
+    // The setters of those callbacks note their registration here, so
+    // tunnelStartPromise only installs its own trampolines for the ones JS
+    // has not registered.
+
+    // Records that the callback for `type` has been registered on the tunnel.
+    void tunnel_start_promise_note(pinggy_ref_t tunnel, PinggyEventType type);
+
+    // Non-zero if the event would settle an armed start promise. Any thread.
+    int tunnel_start_promise_wants(const PinggyEvent *event);
+
+    // Settles the tunnel's start promise from the event, if one is armed.
+    // Must run on the JS thread that armed it; a NULL env stands for that env.
+    void tunnel_start_promise_settle(napi_env env, const PinggyEvent *event);
+
+    // Drops the tunnel's entry, rejecting a promise `env` armed on it with
+    // `reason`. JS thread of `env` only.
+    void tunnel_start_promise_cancel(napi_env env, pinggy_ref_t tunnel, const char *reason);
+
+    napi_value InitPromise(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_PROMISE_H
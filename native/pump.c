@@ -0,0 +1,470 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "helper_macro.h"
+#include "event.h"
+#include "pump.h"
+#include "wake.h"
+#include "batch.h"
+#include "instance.h"
+
+#ifdef _WIN32
+#define PINGGY_THREAD_LOCAL __declspec(thread)
+#else
+#define PINGGY_THREAD_LOCAL __thread
+#endif
+
+static PINGGY_THREAD_LOCAL TunnelDriver *g_current_driver = NULL;
+
+/*
+ * Process-wide registry of running pumps, keyed by tunnel ref. Workers load the
+ * same shared object, so lookups and updates are serialized by one mutex.
+ */
+static TunnelDriver *g_drivers = NULL;
+static uv_mutex_t g_drivers_lock;
+static uv_once_t g_drivers_once = UV_ONCE_INIT;
+
+static void drivers_lock_init(void)
+{
+    uv_mutex_init(&g_drivers_lock);
+}
+
+static void registry_add(TunnelDriver *driver)
+{
+    uv_once(&g_drivers_once, drivers_lock_init);
+    uv_mutex_lock(&g_drivers_lock);
+    driver->next = g_drivers;
+    g_drivers = driver;
+    uv_mutex_unlock(&g_drivers_lock);
+}
+
+static void registry_remove(TunnelDriver *driver)
+{
+    uv_once(&g_drivers_once, drivers_lock_init);
+    uv_mutex_lock(&g_drivers_lock);
+    for (TunnelDriver **it = &g_drivers; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == driver)
+        {
+            *it = driver->next;
+            break;
+        }
+    }
+    uv_mutex_unlock(&g_drivers_lock);
+}
+
+static TunnelDriver *registry_find(pinggy_ref_t tunnel)
+{
+    TunnelDriver *found = NULL;
+    uv_once(&g_drivers_once, drivers_lock_init);
+    uv_mutex_lock(&g_drivers_lock);
+    for (TunnelDriver *it = g_drivers; it != NULL; it = it->next)
+    {
+        if (it->tunnel == tunnel)
+        {
+            found = it;
+            break;
+        }
+    }
+    uv_mutex_unlock(&g_drivers_lock);
+    return found;
+}
+
+TunnelDriver *tunnel_driver_current(void)
+{
+    return g_current_driver;
+}
+
+
+int tunnel_driver_exists(pinggy_ref_t tunnel)
+{
+    return registry_find(tunnel) != NULL;
+}
+
+void tunnel_driver_register(TunnelDriver *driver)
+{
+    registry_add(driver);
+}
+
+void tunnel_driver_request_stop(TunnelDriver *driver)
+{
+    uv_mutex_lock(&driver->lock);
+    driver->stop_requested = 1;
+    uv_cond_signal(&driver->pump_cond);
+    uv_mutex_unlock(&driver->lock);
+    tunnel_wake(driver->tunnel);
+}
+
+void tunnel_driver_post(TunnelDriver *driver, PinggyEvent *event)
+{
+    napi_status status = napi_call_threadsafe_function(driver->tsfn, event, napi_tsfn_nonblocking);
+    if (status != napi_ok)
+    {
+        // The env is going away; nobody is left to receive events.
+        free(event);
+        tunnel_driver_request_stop(driver);
+    }
+}
+
+TunnelDriver *tunnel_driver_acquire(pinggy_ref_t tunnel)
+{
+    TunnelDriver *driver = registry_find(tunnel);
+    if (driver == NULL || driver == g_current_driver)
+    {
+        return NULL;
+    }
+
+    uv_mutex_lock(&driver->lock);
+    driver->js_waiters++;
+    if (driver->in_resume)
+    {
+        tunnel_wake(tunnel);
+    }
+    while (driver->in_resume || driver->js_active)
+    {
+        uv_cond_wait(&driver->js_cond, &driver->lock);
+    }
+    driver->js_waiters--;
+    driver->js_active = 1;
+    uv_mutex_unlock(&driver->lock);
+
+    return driver;
+}
+
+void tunnel_driver_release(TunnelDriver *driver)
+{
+    if (driver == NULL)
+    {
+        return;
+    }
+
+    uv_mutex_lock(&driver->lock);
+    driver->js_active = 0;
+    uv_cond_broadcast(&driver->js_cond);
+    uv_cond_signal(&driver->pump_cond);
+    uv_mutex_unlock(&driver->lock);
+}
+
+int tunnel_driver_step(TunnelDriver *driver, int timeout_ms, int wait_for_js)
+{
+    uv_mutex_lock(&driver->lock);
+    // Let a waiting JS call in before going back into libpinggy.
+    while (wait_for_js && !driver->stop_requested && (driver->js_active || driver->js_waiters > 0))
+    {
+        uv_cond_wait(&driver->pump_cond, &driver->lock);
+    }
+    if (driver->stop_requested)
+    {
+        uv_mutex_unlock(&driver->lock);
+        return 0;
+    }
+    if (driver->js_active || driver->js_waiters > 0)
+    {
+        uv_mutex_unlock(&driver->lock);
+        return -1;
+    }
+    driver->in_resume = 1;
+    uv_mutex_unlock(&driver->lock);
+
+    TunnelDriver *previous = g_current_driver;
+    PinggyInstance *previous_instance = pinggy_instance_enter(driver->instance);
+    g_current_driver = driver;
+    pinggy_bool_t active = tunnel_wake_resume_timeout(driver->tunnel, (pinggy_int32_t)timeout_ms);
+    g_current_driver = previous;
+    pinggy_instance_enter(previous_instance);
+
+    // One item per resume for batched tunnels, however many events it produced.
+    if (pinggy_event_batch_claim_flush(driver->tunnel))
+    {
+        PinggyEvent *flush = (PinggyEvent *)calloc(1, sizeof(PinggyEvent));
+        if (flush != NULL)
+        {
+            flush->type = PINGGY_EVENT_BATCH_FLUSH;
+            flush->tunnel = driver->tunnel;
+            tunnel_driver_post(driver, flush);
+        }
+    }
+
+    uv_mutex_lock(&driver->lock);
+    driver->in_resume = 0;
+    if (driver->js_waiters > 0)
+    {
+        uv_cond_broadcast(&driver->js_cond);
+    }
+    if (!active)
+    {
+        driver->exit_result = pinggy_false;
+    }
+    uv_mutex_unlock(&driver->lock);
+
+    return active ? 1 : 0;
+}
+
+void tunnel_driver_exit(TunnelDriver *driver)
+{
+    PINGGY_DEBUG("driver for tunnel %u exiting, active = %d", (unsigned)driver->tunnel, (int)driver->exit_result);
+
+    // A NULL item tells the JS side that driving has stopped.
+    napi_call_threadsafe_function(driver->tsfn, NULL, napi_tsfn_nonblocking);
+    napi_release_threadsafe_function(driver->tsfn, napi_tsfn_release);
+}
+
+// Runs on the JS thread for every item queued by the driving thread.
+static void driver_call_js(napi_env env, napi_value js_callback, void *context, void *data)
+{
+    TunnelDriver *driver = (TunnelDriver *)context;
+    PinggyEvent *event = (PinggyEvent *)data;
+
+    if (env == NULL)
+    {
+        // The threadsafe function is being torn down; just drop the item.
+        free(event);
+        return;
+    }
+
+    if (event != NULL && event->type == PINGGY_EVENT_BATCH_FLUSH)
+    {
+        pinggy_event_batch_flush(env, event->tunnel);
+        free(event);
+        return;
+    }
+    if (event != NULL)
+    {
+        pinggy_event_dispatch(env, event);
+        free(event);
+        return;
+    }
+
+    if (driver->on_exit_ref == NULL)
+    {
+        return;
+    }
+
+    napi_handle_scope scope;
+    if (napi_open_handle_scope(env, &scope) != napi_ok)
+    {
+        return;
+    }
+
+    napi_value callback, undefined, argv[2];
+    if (napi_get_reference_value(env, driver->on_exit_ref, &callback) == napi_ok && callback != NULL)
+    {
+        napi_create_uint32(env, (uint32_t)driver->tunnel, &argv[0]);
+        napi_get_boolean(env, driver->exit_result, &argv[1]);
+        napi_get_undefined(env, &undefined);
+        napi_call_function(env, undefined, callback, 2, argv, NULL);
+    }
+
+    napi_close_handle_scope(env, scope);
+}
+
+// Called once the driving thread has released the threadsafe function, or when
+// the env is torn down underneath a running driver.
+static void driver_finalize(napi_env env, void *finalize_data, void *finalize_hint)
+{
+    TunnelDriver *driver = (TunnelDriver *)finalize_data;
+
+    tunnel_driver_request_stop(driver);
+    if (driver->detach != NULL)
+    {
+        driver->detach(driver);
+    }
+    registry_remove(driver);
+
+    if (driver->on_exit_ref != NULL)
+    {
+        napi_delete_reference(env, driver->on_exit_ref);
+    }
+    pinggy_instance_release(driver->instance);
+    uv_cond_destroy(&driver->js_cond);
+    uv_cond_destroy(&driver->pump_cond);
+    uv_mutex_destroy(&driver->lock);
+    free(driver);
+}
+
+napi_status tunnel_driver_create(napi_env env, pinggy_ref_t tunnel, napi_value on_exit, TunnelDriver **result)
+{
+    napi_status status;
+
+    *result = NULL;
+    if (registry_find(tunnel) != NULL)
+    {
+        return napi_invalid_arg;
+    }
+
+    TunnelDriver *driver = (TunnelDriver *)calloc(1, sizeof(TunnelDriver));
+    if (driver == NULL)
+    {
+        return napi_generic_failure;
+    }
+
+    driver->tunnel = tunnel;
+    driver->env = env;
+    driver->instance = pinggy_instance_get(env);
+    driver->timeout_ms = PINGGY_PUMP_DEFAULT_TIMEOUT_MS;
+    driver->max_timeout_ms = PINGGY_PUMP_MAX_IDLE_TIMEOUT_MS;
+    driver->exit_result = pinggy_true;
+    uv_mutex_init(&driver->lock);
+    uv_cond_init(&driver->pump_cond);
+    uv_cond_init(&driver->js_cond);
+
+    status = napi_create_reference(env, on_exit, 1, &driver->on_exit_ref);
+    if (status == napi_ok)
+    {
+        napi_value resource_name;
+        napi_create_string_utf8(env, "PinggyTunnelDriver", NAPI_AUTO_LENGTH, &resource_name);
+        status = napi_create_threadsafe_function(env, NULL, NULL, resource_name, 0, 1,
+                                                 driver, driver_finalize, driver, driver_call_js, &driver->tsfn);
+        if (status != napi_ok)
+        {
+            napi_delete_reference(env, driver->on_exit_ref);
+        }
+    }
+    if (status != napi_ok)
+    {
+        uv_cond_destroy(&driver->js_cond);
+        uv_cond_destroy(&driver->pump_cond);
+        uv_mutex_destroy(&driver->lock);
+        free(driver);
+        return status;
+    }
+
+    pinggy_instance_retain(driver->instance);
+    *result = driver;
+    return napi_ok;
+}
+
+void tunnel_driver_abort(TunnelDriver *driver)
+{
+    registry_remove(driver);
+    // Runs driver_finalize, which frees the driver.
+    napi_release_threadsafe_function(driver->tsfn, napi_tsfn_abort);
+}
+
+static void pump_thread_main(void *arg)
+{
+    TunnelDriver *driver = (TunnelDriver *)arg;
+
+    for (;;)
+    {
+        // Idle tunnels back off towards max_timeout_ms; JS calls and stops wake
+        // the thread, so a long wait does not delay them.
+        int timeout_ms = tunnel_wake_next_timeout(driver->tunnel, driver->timeout_ms, driver->max_timeout_ms);
+        if (tunnel_driver_step(driver, timeout_ms, 1) <= 0)
+        {
+            break;
+        }
+    }
+    tunnel_driver_exit(driver);
+}
+
+static void pump_detach(TunnelDriver *driver)
+{
+    if (driver->thread_started)
+    {
+        uv_thread_join(&driver->thread);
+    }
+}
+
+// tunnelStartPump(tunnelRef, onExit(tunnelRef, active), timeoutMs?)
+napi_value TunnelStartPump(napi_env env, napi_callback_info info)
+{
+    size_t argc = 3;
+    napi_value args[3];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected at least two arguments (tunnel ref, onExit callback)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected first argument to be an unsigned integer (tunnel ref)");
+
+    napi_valuetype cb_type;
+    status = napi_typeof(env, args[1], &cb_type);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to check callback type");
+    NAPI_CHECK_CONDITION_THROW(env, cb_type == napi_function, "Second argument must be a function");
+
+    int32_t timeout_ms = PINGGY_PUMP_DEFAULT_TIMEOUT_MS;
+    if (argc >= 3)
+    {
+        napi_valuetype timeout_type;
+        napi_typeof(env, args[2], &timeout_type);
+        if (timeout_type == napi_number)
+        {
+            status = napi_get_value_int32(env, args[2], &timeout_ms);
+            NAPI_CHECK_STATUS_THROW(env, status, "Expected third argument to be an integer (timeout)");
+        }
+    }
+    NAPI_CHECK_CONDITION_THROW(env, timeout_ms >= 0, "Pump timeout must not be negative");
+    NAPI_CHECK_CONDITION_THROW(env, !tunnel_driver_exists((pinggy_ref_t)tunnel_ref), "Tunnel is already driven by a pump");
+
+    TunnelDriver *driver;
+    status = tunnel_driver_create(env, (pinggy_ref_t)tunnel_ref, args[1], &driver);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create tunnel driver");
+
+    driver->timeout_ms = timeout_ms;
+    if (driver->max_timeout_ms < timeout_ms)
+    {
+        driver->max_timeout_ms = timeout_ms;
+    }
+    driver->detach = pump_detach;
+    tunnel_driver_register(driver);
+
+    if (uv_thread_create(&driver->thread, pump_thread_main, driver) != 0)
+    {
+        tunnel_driver_abort(driver);
+        NAPI_THROW_ERROR(env, "Failed to start pump thread");
+    }
+    driver->thread_started = 1;
+    PINGGY_DEBUG("pump started for tunnel %u (timeout %d ms)", (unsigned)tunnel_ref, (int)timeout_ms);
+
+    napi_value js_result;
+    napi_get_boolean(env, pinggy_true, &js_result);
+    return js_result;
+}
+
+// tunnelStopPump(tunnelRef): asks the pump to return, cutting its current resume short.
+// The tunnel itself keeps running; onExit is called with active = true.
+napi_value TunnelStopPump(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (tunnel ref)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected argument to be an unsigned integer (tunnel ref)");
+
+    TunnelDriver *driver = registry_find((pinggy_ref_t)tunnel_ref);
+    if (driver != NULL)
+    {
+        tunnel_driver_request_stop(driver);
+    }
+
+    napi_value js_result;
+    napi_get_boolean(env, driver != NULL, &js_result);
+    return js_result;
+}
+
+napi_value InitPump(napi_env env, napi_value exports)
+{
+    napi_value tunnel_start_pump_fn, tunnel_stop_pump_fn;
+
+    napi_create_function(env, NULL, 0, TunnelStartPump, NULL, &tunnel_start_pump_fn);
+    napi_set_named_property(env, exports, "tunnelStartPump", tunnel_start_pump_fn);
+
+    napi_create_function(env, NULL, 0, TunnelStopPump, NULL, &tunnel_stop_pump_fn);
+    napi_set_named_property(env, exports, "tunnelStopPump", tunnel_stop_pump_fn);
+
+    return exports;
+}
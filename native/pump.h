@@ -0,0 +1,100 @@
+#ifndef PINGGY_PUMP_H
+#define PINGGY_PUMP_H
+
+#include <node_api.h>
+#include <uv.h>
+#include "../pinggy.h"
+#include "event.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PINGGY_PUMP_DEFAULT_TIMEOUT_MS 100
+#define PINGGY_PUMP_MAX_IDLE_TIMEOUT_MS 1000
+
+    // A tunnel driven by a native thread instead of the JS thread that owns it:
+    // either a dedicated pump thread or a shared reactor thread (reactor.h).
+    //
+    // Callbacks raised by libpinggy on that thread are copied and queued to the
+    // env that owns the tunnel through a napi_threadsafe_function. libpinggy
+    // only documents pinggy_tunnel_stop as thread-safe, so every other call made
+    // from the JS thread while a tunnel is driven has to go through
+    // tunnel_driver_acquire()/tunnel_driver_release(), which keep it out of the
+    // driving thread's resume.
+    typedef struct TunnelDriver
+    {
+        pinggy_ref_t tunnel;
+        napi_env env;
+        struct PinggyInstance *instance; // bound to the driving thread during resumes
+        napi_threadsafe_function tsfn;
+        napi_ref on_exit_ref;
+        uv_thread_t thread;
+        int thread_started;
+        int timeout_ms;     // timeout while the tunnel is busy
+        int max_timeout_ms; // idle timeouts stretch up to this
+
+        // Called from the threadsafe function's finalizer; must guarantee the
+        // driving thread no longer touches the driver once it returns.
+        void (*detach)(struct TunnelDriver *driver);
+        void *host; // owned by whoever set detach
+
+        uv_mutex_t lock;
+        uv_cond_t pump_cond; // signalled when the JS thread hands the tunnel back
+        uv_cond_t js_cond;   // signalled when the pump leaves libpinggy
+        int in_resume;
+        int js_active;
+        int js_waiters;
+        int stop_requested;
+        pinggy_bool_t exit_result;
+
+        struct TunnelDriver *next;
+    } TunnelDriver;
+
+    // Driver whose resume is running on this thread, or NULL on any other thread.
+    TunnelDriver *tunnel_driver_current(void);
+
+    // Creates a driver and its threadsafe function for `tunnel`, owned by `env`.
+    // The driver is not registered yet. Fails if the tunnel is already driven.
+    napi_status tunnel_driver_create(napi_env env, pinggy_ref_t tunnel, napi_value on_exit, TunnelDriver **result);
+
+    // Makes the driver visible to tunnel_driver_acquire().
+    void tunnel_driver_register(TunnelDriver *driver);
+
+    // Undoes tunnel_driver_create() when the driver never got a thread.
+    void tunnel_driver_abort(TunnelDriver *driver);
+
+    // Returns non-zero if a driver exists for the tunnel.
+    int tunnel_driver_exists(pinggy_ref_t tunnel);
+
+    // Asks whoever drives the tunnel to let go of it.
+    void tunnel_driver_request_stop(TunnelDriver *driver);
+
+    // Runs one resume of the tunnel on the calling thread. Returns 1 to keep
+    // going, 0 once the tunnel ended or a stop was requested, and -1 when the
+    // JS thread currently holds the tunnel and `wait_for_js` is 0.
+    int tunnel_driver_step(TunnelDriver *driver, int timeout_ms, int wait_for_js);
+
+    // Reports the end of driving to JS (onExit) and drops the driving thread's
+    // hold on the threadsafe function. The driver may be freed afterwards.
+    void tunnel_driver_exit(TunnelDriver *driver);
+
+    // Queues an event (allocated by pinggy_event_clone) to the driver's env.
+    // Takes ownership of the event.
+    void tunnel_driver_post(TunnelDriver *driver, PinggyEvent *event);
+
+    // Waits until the pump (if any) is outside libpinggy and reserves the tunnel
+    // for the calling thread. Returns NULL when no pump drives the tunnel.
+    TunnelDriver *tunnel_driver_acquire(pinggy_ref_t tunnel);
+
+    // Hands the tunnel back to its pump. Accepts NULL.
+    void tunnel_driver_release(TunnelDriver *driver);
+
+    napi_value InitPump(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_PUMP_H
@@ -0,0 +1,487 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "helper_macro.h"
+#include "pump.h"
+#include "reactor.h"
+#include "wake.h"
+
+/*
+ * One lock covers every reactor, its threads' heaps and the `host`
+ * field of attached drivers. It is never held across a resume.
+ */
+static PinggyReactor *g_reactors = NULL;
+static uint32_t g_next_reactor_id = 0;
+static uv_mutex_t g_reactor_lock;
+static uv_cond_t g_reactor_cond;
+static uv_once_t g_reactor_once = UV_ONCE_INIT;
+
+static void reactor_lock_init(void)
+{
+    uv_mutex_init(&g_reactor_lock);
+    uv_cond_init(&g_reactor_cond);
+}
+
+// Caller must hold g_reactor_lock.
+static PinggyReactor *reactor_find(uint32_t id)
+{
+    for (PinggyReactor *it = g_reactors; it != NULL; it = it->next)
+    {
+        if (it->id == id)
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+// Caller must hold g_reactor_lock.
+static void reactor_unlink(PinggyReactor *reactor)
+{
+    for (PinggyReactor **it = &g_reactors; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == reactor)
+        {
+            *it = reactor->next;
+            return;
+        }
+    }
+}
+
+// Caller must hold g_reactor_lock.
+static void reactor_heap_swap(ReactorThread *rt, int a, int b)
+{
+    ReactorEntry tmp = rt->heap[a];
+    rt->heap[a] = rt->heap[b];
+    rt->heap[b] = tmp;
+}
+
+// Caller must hold g_reactor_lock.
+static void reactor_heap_sift_up(ReactorThread *rt, int i)
+{
+    while (i > 0)
+    {
+        int parent = (i - 1) / 2;
+        if (rt->heap[parent].due_ns <= rt->heap[i].due_ns)
+        {
+            return;
+        }
+        reactor_heap_swap(rt, parent, i);
+        i = parent;
+    }
+}
+
+// Caller must hold g_reactor_lock.
+static void reactor_heap_sift_down(ReactorThread *rt, int i)
+{
+    for (;;)
+    {
+        int earliest = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < rt->count && rt->heap[left].due_ns < rt->heap[earliest].due_ns)
+        {
+            earliest = left;
+        }
+        if (right < rt->count && rt->heap[right].due_ns < rt->heap[earliest].due_ns)
+        {
+            earliest = right;
+        }
+        if (earliest == i)
+        {
+            return;
+        }
+        reactor_heap_swap(rt, earliest, i);
+        i = earliest;
+    }
+}
+
+// Caller must hold g_reactor_lock and have made room for the entry.
+static void reactor_heap_push(ReactorThread *rt, ReactorEntry entry)
+{
+    rt->heap[rt->count] = entry;
+    reactor_heap_sift_up(rt, rt->count++);
+}
+
+// Caller must hold g_reactor_lock.
+static ReactorEntry reactor_heap_remove(ReactorThread *rt, int i)
+{
+    ReactorEntry removed = rt->heap[i];
+    rt->count--;
+    if (i < rt->count)
+    {
+        rt->heap[i] = rt->heap[rt->count];
+        reactor_heap_sift_down(rt, i);
+        reactor_heap_sift_up(rt, i);
+    }
+    return removed;
+}
+
+// Caller must hold g_reactor_lock.
+static int reactor_heap_find(ReactorThread *rt, pinggy_ref_t tunnel)
+{
+    for (int i = 0; i < rt->count; i++)
+    {
+        if (rt->heap[i].driver->tunnel == tunnel)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// tunnel_wake() listener: a tunnel woken while its thread sleeps or resumes
+// another one is due at once, with its backoff reset.
+static void reactor_on_wake(pinggy_ref_t tunnel)
+{
+    uv_mutex_lock(&g_reactor_lock);
+    for (PinggyReactor *reactor = g_reactors; reactor != NULL; reactor = reactor->next)
+    {
+        for (int t = 0; t < reactor->num_threads; t++)
+        {
+            ReactorThread *rt = &reactor->threads[t];
+            int i = reactor_heap_find(rt, tunnel);
+            if (i >= 0)
+            {
+                rt->heap[i].due_ns = uv_hrtime();
+                rt->heap[i].backoff_ms = rt->heap[i].driver->timeout_ms;
+                reactor_heap_sift_up(rt, i);
+                uv_cond_broadcast(&g_reactor_cond);
+                uv_mutex_unlock(&g_reactor_lock);
+                return;
+            }
+        }
+    }
+    uv_mutex_unlock(&g_reactor_lock);
+}
+
+static void reactor_thread_main(void *arg)
+{
+    ReactorThread *rt = (ReactorThread *)arg;
+    PinggyReactor *reactor = rt->reactor;
+
+    uv_mutex_lock(&g_reactor_lock);
+    for (;;)
+    {
+        while (rt->count == 0 && !reactor->closing)
+        {
+            uv_cond_wait(&g_reactor_cond, &g_reactor_lock);
+        }
+        if (rt->count == 0)
+        {
+            break;
+        }
+
+        int closing = reactor->closing;
+        uint64_t now_ns = uv_hrtime();
+        if (!closing && rt->heap[0].due_ns > now_ns)
+        {
+            // Attaching, waking a tunnel and closing all broadcast the condition.
+            uv_cond_timedwait(&g_reactor_cond, &g_reactor_lock, rt->heap[0].due_ns - now_ns);
+            continue;
+        }
+
+        ReactorEntry entry = reactor_heap_remove(rt, 0);
+        int timeout_ms = reactor->quantum_ms;
+        if (rt->count > 0)
+        {
+            uint64_t next_due_ns = rt->heap[0].due_ns;
+            uint64_t until_next_ms = next_due_ns > now_ns ? (next_due_ns - now_ns) / 1000000 : 0;
+            if (until_next_ms < (uint64_t)timeout_ms)
+            {
+                timeout_ms = (int)until_next_ms;
+            }
+        }
+        if (timeout_ms < PINGGY_REACTOR_MIN_RESUME_MS)
+        {
+            timeout_ms = PINGGY_REACTOR_MIN_RESUME_MS;
+        }
+        TunnelDriver *driver = entry.driver;
+        rt->current = driver;
+        uv_mutex_unlock(&g_reactor_lock);
+
+        // A closing reactor lets go of its tunnels without resuming them again;
+        // their onExit reports them as still active.
+        int ret = closing ? 0 : tunnel_driver_step(driver, timeout_ms, 0);
+        if (ret == 0)
+        {
+            // `host` is still set, so the driver cannot be freed under us.
+            tunnel_driver_exit(driver);
+        }
+        else if (ret < 0)
+        {
+            // The JS thread holds the tunnel; look again after a quantum.
+            entry.due_ns = uv_hrtime() + (uint64_t)reactor->quantum_ms * 1000000;
+        }
+        else if (tunnel_wake_last_idle(driver->tunnel))
+        {
+            entry.due_ns = uv_hrtime() + (uint64_t)entry.backoff_ms * 1000000;
+            entry.backoff_ms = entry.backoff_ms > driver->max_timeout_ms / 2 ? driver->max_timeout_ms : entry.backoff_ms * 2;
+        }
+        else
+        {
+            // Traffic, a callback or a wakeup: there may be more right behind it.
+            entry.due_ns = uv_hrtime();
+            entry.backoff_ms = driver->timeout_ms;
+        }
+
+        uv_mutex_lock(&g_reactor_lock);
+        rt->current = NULL;
+        if (ret == 0)
+        {
+            driver->host = NULL;
+        }
+        else
+        {
+            reactor_heap_push(rt, entry);
+        }
+        uv_cond_broadcast(&g_reactor_cond);
+    }
+    uv_mutex_unlock(&g_reactor_lock);
+}
+
+// TunnelDriver.detach for reactor-driven tunnels: runs on the owning JS thread
+// from the threadsafe function's finalizer.
+static void reactor_detach(TunnelDriver *driver)
+{
+    uv_mutex_lock(&g_reactor_lock);
+    while (driver->host != NULL)
+    {
+        ReactorThread *rt = (ReactorThread *)driver->host;
+        if (rt->current != driver)
+        {
+            int i = reactor_heap_find(rt, driver->tunnel);
+            if (i >= 0)
+            {
+                reactor_heap_remove(rt, i);
+            }
+            driver->host = NULL;
+            break;
+        }
+        uv_cond_wait(&g_reactor_cond, &g_reactor_lock);
+    }
+    uv_mutex_unlock(&g_reactor_lock);
+}
+
+// Lets go of every tunnel, joins the threads and frees the reactor. Each
+// thread hands its tunnels back (onExit with active = true) before it ends.
+static void reactor_destroy(PinggyReactor *reactor)
+{
+    uv_mutex_lock(&g_reactor_lock);
+    reactor_unlink(reactor);
+    reactor->closing = 1;
+    uv_cond_broadcast(&g_reactor_cond);
+    uv_mutex_unlock(&g_reactor_lock);
+
+    for (int t = 0; t < reactor->num_threads; t++)
+    {
+        uv_thread_join(&reactor->threads[t].thread);
+        free(reactor->threads[t].heap);
+    }
+    PINGGY_DEBUG("reactor %u destroyed", (unsigned)reactor->id);
+    free(reactor);
+}
+
+static void reactor_env_cleanup(void *arg)
+{
+    reactor_destroy((PinggyReactor *)arg);
+}
+
+// reactorCreate(threads, quantumMs?): returns the reactor id.
+napi_value ReactorCreate(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value args[2];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected at least one argument (threads)");
+
+    int32_t num_threads;
+    status = napi_get_value_int32(env, args[0], &num_threads);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected first argument to be an integer (threads)");
+    NAPI_CHECK_CONDITION_THROW(env, num_threads >= 1 && num_threads <= PINGGY_REACTOR_MAX_THREADS,
+                               "Reactor thread count out of range");
+
+    int32_t quantum_ms = PINGGY_REACTOR_DEFAULT_QUANTUM_MS;
+    if (argc >= 2)
+    {
+        napi_valuetype quantum_type;
+        napi_typeof(env, args[1], &quantum_type);
+        if (quantum_type == napi_number)
+        {
+            status = napi_get_value_int32(env, args[1], &quantum_ms);
+            NAPI_CHECK_STATUS_THROW(env, status, "Expected second argument to be an integer (quantumMs)");
+        }
+    }
+    NAPI_CHECK_CONDITION_THROW(env, quantum_ms >= 1, "Reactor quantum must be positive");
+
+    PinggyReactor *reactor = (PinggyReactor *)calloc(1, sizeof(PinggyReactor));
+    NAPI_CHECK_CONDITION_THROW(env, reactor != NULL, "Failed to allocate memory for reactor");
+
+    reactor->env = env;
+    reactor->quantum_ms = quantum_ms;
+
+    uv_once(&g_reactor_once, reactor_lock_init);
+    tunnel_wake_set_listener(reactor_on_wake);
+    uv_mutex_lock(&g_reactor_lock);
+    reactor->id = ++g_next_reactor_id;
+    reactor->next = g_reactors;
+    g_reactors = reactor;
+    uv_mutex_unlock(&g_reactor_lock);
+
+    for (int t = 0; t < num_threads; t++)
+    {
+        reactor->threads[t].reactor = reactor;
+        if (uv_thread_create(&reactor->threads[t].thread, reactor_thread_main, &reactor->threads[t]) != 0)
+        {
+            reactor_destroy(reactor);
+            NAPI_THROW_ERROR(env, "Failed to start reactor thread");
+        }
+        reactor->num_threads = t + 1;
+    }
+
+    napi_add_env_cleanup_hook(env, reactor_env_cleanup, reactor);
+    PINGGY_DEBUG("reactor %u started with %d threads, quantum %d ms", (unsigned)reactor->id, (int)num_threads, (int)quantum_ms);
+
+    napi_value js_result;
+    napi_create_uint32(env, reactor->id, &js_result);
+    return js_result;
+}
+
+// reactorAttach(reactorId, tunnelRef, onExit(tunnelRef, active)): hands a
+// started tunnel to the reactor. Detach with tunnelStopPump.
+napi_value ReactorAttach(napi_env env, napi_callback_info info)
+{
+    size_t argc = 3;
+    napi_value args[3];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 3, "Expected three arguments (reactor id, tunnel ref, onExit callback)");
+
+    uint32_t reactor_id;
+    status = napi_get_value_uint32(env, args[0], &reactor_id);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected first argument to be an unsigned integer (reactor id)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[1], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected second argument to be an unsigned integer (tunnel ref)");
+
+    napi_valuetype cb_type;
+    status = napi_typeof(env, args[2], &cb_type);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to check callback type");
+    NAPI_CHECK_CONDITION_THROW(env, cb_type == napi_function, "Third argument must be a function");
+    NAPI_CHECK_CONDITION_THROW(env, !tunnel_driver_exists((pinggy_ref_t)tunnel_ref), "Tunnel is already driven by a pump");
+
+    TunnelDriver *driver;
+    status = tunnel_driver_create(env, (pinggy_ref_t)tunnel_ref, args[2], &driver);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create tunnel driver");
+    driver->detach = reactor_detach;
+    tunnel_driver_register(driver);
+
+    uv_once(&g_reactor_once, reactor_lock_init);
+    uv_mutex_lock(&g_reactor_lock);
+    PinggyReactor *reactor = reactor_find(reactor_id);
+    ReactorThread *target = NULL;
+    if (reactor != NULL && !reactor->closing)
+    {
+        for (int t = 0; t < reactor->num_threads; t++)
+        {
+            ReactorThread *rt = &reactor->threads[t];
+            if (target == NULL || rt->count + (rt->current != NULL) < target->count + (target->current != NULL))
+            {
+                target = rt;
+            }
+        }
+        // The heap also takes back the entry of the tunnel being resumed.
+        if (target->count + (target->current != NULL) >= target->capacity)
+        {
+            int capacity = target->capacity > 0 ? target->capacity * 2 : 8;
+            ReactorEntry *heap = (ReactorEntry *)realloc(target->heap, (size_t)capacity * sizeof(ReactorEntry));
+            if (heap != NULL)
+            {
+                target->heap = heap;
+                target->capacity = capacity;
+            }
+            else
+            {
+                target = NULL;
+            }
+        }
+    }
+    if (target != NULL)
+    {
+        ReactorEntry entry = {uv_hrtime(), driver->timeout_ms, driver};
+        reactor_heap_push(target, entry);
+        driver->host = target;
+        uv_cond_broadcast(&g_reactor_cond);
+    }
+    uv_mutex_unlock(&g_reactor_lock);
+
+    if (target == NULL)
+    {
+        tunnel_driver_abort(driver);
+        NAPI_THROW_ERROR(env, reactor == NULL ? "Unknown reactor" : "Failed to attach tunnel to reactor");
+    }
+
+    napi_value js_result;
+    napi_get_boolean(env, pinggy_true, &js_result);
+    return js_result;
+}
+
+// reactorDestroy(reactorId): stops driving every attached tunnel (their onExit
+// fires with active = true) and joins the reactor threads. Must be called from
+// the thread that created the reactor.
+napi_value ReactorDestroy(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (reactor id)");
+
+    uint32_t reactor_id;
+    status = napi_get_value_uint32(env, args[0], &reactor_id);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected argument to be an unsigned integer (reactor id)");
+
+    uv_once(&g_reactor_once, reactor_lock_init);
+    uv_mutex_lock(&g_reactor_lock);
+    PinggyReactor *reactor = reactor_find(reactor_id);
+    uv_mutex_unlock(&g_reactor_lock);
+
+    if (reactor != NULL)
+    {
+        NAPI_CHECK_CONDITION_THROW(env, reactor->env == env, "Reactor belongs to another thread");
+        napi_remove_env_cleanup_hook(env, reactor_env_cleanup, reactor);
+        reactor_destroy(reactor);
+    }
+
+    napi_value js_result;
+    napi_get_boolean(env, reactor != NULL, &js_result);
+    return js_result;
+}
+
+napi_value InitReactor(napi_env env, napi_value exports)
+{
+    napi_value reactor_create_fn, reactor_attach_fn, reactor_destroy_fn;
+
+    napi_create_function(env, NULL, 0, ReactorCreate, NULL, &reactor_create_fn);
+    napi_set_named_property(env, exports, "reactorCreate", reactor_create_fn);
+
+    napi_create_function(env, NULL, 0, ReactorAttach, NULL, &reactor_attach_fn);
+    napi_set_named_property(env, exports, "reactorAttach", reactor_attach_fn);
+
+    napi_create_function(env, NULL, 0, ReactorDestroy, NULL, &reactor_destroy_fn);
+    napi_set_named_property(env, exports, "reactorDestroy", reactor_destroy_fn);
+
+    return exports;
+}
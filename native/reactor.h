@@ -0,0 +1,72 @@
+#ifndef PINGGY_REACTOR_H
+#define PINGGY_REACTOR_H
+
+#include <node_api.h>
+#include <uv.h>
+#include "../pinggy.h"
+#include "pump.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define PINGGY_REACTOR_MAX_THREADS 64
+#define PINGGY_REACTOR_DEFAULT_QUANTUM_MS 50
+#define PINGGY_REACTOR_MIN_RESUME_MS 2
+
+    // A fixed set of native threads driving many tunnels.
+    //
+    // Each attached tunnel gets a TunnelDriver (so events still reach the env
+    // that owns it) and is pinned to the least loaded thread. A thread keeps
+    // its tunnels in a min-heap of the time each is next due and sleeps until
+    // the earliest one is. It then resumes that tunnel for up to quantum_ms,
+    // less if another tunnel falls due sooner (but not below
+    // PINGGY_REACTOR_MIN_RESUME_MS, so an idle resume is still told apart from
+    // one cut short by traffic). A tunnel whose resume ended early is due
+    // again at once; one whose resume ran into its timeout backs off like a
+    // pump does: 100 ms, doubling up to 1000 ms (the driver's timeout_ms and
+    // max_timeout_ms). So an idle tunnel costs one resume, one thread wakeup
+    // to start it and one for it to end, per second, however many tunnels
+    // share the thread, and traffic for it waits up to a second. A wakeup of
+    // the tunnel (tunnel_wake: a stop, an async call completing) makes it due
+    // at once, so the worst case there is the quantum_ms resume of another
+    // tunnel in progress.
+    //
+    // Reactors are identified by a process-wide id: a tunnel owned by any
+    // worker can join a reactor created on another thread.
+    typedef struct ReactorEntry
+    {
+        uint64_t due_ns;
+        int backoff_ms; // wait after the next resume that runs into its timeout
+        TunnelDriver *driver;
+    } ReactorEntry;
+
+    typedef struct ReactorThread
+    {
+        struct PinggyReactor *reactor;
+        uv_thread_t thread;
+        ReactorEntry *heap; // ordered by due_ns
+        int count;
+        int capacity;
+        TunnelDriver *current; // driver being resumed, if any; not in the heap
+    } ReactorThread;
+
+    typedef struct PinggyReactor
+    {
+        uint32_t id;
+        napi_env env;
+        int quantum_ms;
+        int num_threads;
+        int closing;
+        ReactorThread threads[PINGGY_REACTOR_MAX_THREADS];
+        struct PinggyReactor *next;
+    } PinggyReactor;
+
+    napi_value InitReactor(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_REACTOR_H
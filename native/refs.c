@@ -0,0 +1,213 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "helper_macro.h"
+#include "pump.h"
+#include "async.h"
+#include "callbacks.h"
+#include "promise.h"
+#include "refs.h"
+
+typedef struct OwnedRef
+{
+    pinggy_ref_t ref;
+    PinggyRefKind kind;
+    napi_env env;
+    int wrapped; // an owner token exists
+
+    struct OwnedRef *next;
+} OwnedRef;
+
+static OwnedRef *g_refs = NULL;
+static uv_mutex_t g_refs_lock;
+static uv_once_t g_refs_once = UV_ONCE_INIT;
+
+static void refs_init_once(void)
+{
+    uv_mutex_init(&g_refs_lock);
+}
+
+// Caller holds g_refs_lock.
+static OwnedRef *ref_find(pinggy_ref_t ref)
+{
+    for (OwnedRef *it = g_refs; it != NULL; it = it->next)
+    {
+        if (it->ref == ref)
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+// Caller holds g_refs_lock.
+static void ref_unlink(OwnedRef *entry)
+{
+    for (OwnedRef **it = &g_refs; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == entry)
+        {
+            *it = entry->next;
+            break;
+        }
+    }
+}
+
+static void ref_free(OwnedRef *entry)
+{
+    if (entry->kind == PINGGY_REF_TUNNEL)
+    {
+        tunnel_start_promise_cancel(entry->env, entry->ref, "Tunnel freed");
+        tunnel_callbacks_release(entry->env, entry->ref);
+
+        // Keep pumps, reactors and async work out of libpinggy while the
+        // tunnel goes away; they find a dead ref on their next call.
+        TunnelDriver *driver = tunnel_driver_acquire(entry->ref);
+        if (driver == NULL)
+        {
+            tunnel_async_resume_begin(entry->ref);
+        }
+        if (pinggy_tunnel_is_active(entry->ref))
+        {
+            pinggy_tunnel_stop(entry->ref);
+        }
+        pinggy_free_ref(entry->ref);
+        if (driver == NULL)
+        {
+            tunnel_async_resume_end(entry->ref);
+        }
+        tunnel_driver_release(driver);
+    }
+    else
+    {
+        pinggy_free_ref(entry->ref);
+    }
+    PINGGY_DEBUG("freed %s ref %u", entry->kind == PINGGY_REF_TUNNEL ? "tunnel" : "config", (unsigned)entry->ref);
+    free(entry);
+}
+
+static void ref_env_cleanup(void *arg)
+{
+    OwnedRef *entry = (OwnedRef *)arg;
+    uv_mutex_lock(&g_refs_lock);
+    ref_unlink(entry);
+    uv_mutex_unlock(&g_refs_lock);
+    ref_free(entry);
+}
+
+void pinggy_ref_own(napi_env env, pinggy_ref_t ref, PinggyRefKind kind)
+{
+    if (ref == INVALID_PINGGY_REF)
+    {
+        return;
+    }
+    OwnedRef *entry = (OwnedRef *)calloc(1, sizeof(OwnedRef));
+    if (entry == NULL)
+    {
+        // The ref still works; it is only never freed.
+        return;
+    }
+    entry->ref = ref;
+    entry->kind = kind;
+    entry->env = env;
+
+    uv_once(&g_refs_once, refs_init_once);
+    uv_mutex_lock(&g_refs_lock);
+    entry->next = g_refs;
+    g_refs = entry;
+    uv_mutex_unlock(&g_refs_lock);
+
+    napi_add_env_cleanup_hook(env, ref_env_cleanup, entry);
+}
+
+int pinggy_ref_release(napi_env env, pinggy_ref_t ref)
+{
+    uv_once(&g_refs_once, refs_init_once);
+    uv_mutex_lock(&g_refs_lock);
+    OwnedRef *entry = ref_find(ref);
+    if (entry != NULL && entry->env == env)
+    {
+        ref_unlink(entry);
+    }
+    else
+    {
+        entry = NULL;
+    }
+    uv_mutex_unlock(&g_refs_lock);
+    if (entry == NULL)
+    {
+        return 0;
+    }
+    napi_remove_env_cleanup_hook(env, ref_env_cleanup, entry);
+    ref_free(entry);
+    return 1;
+}
+
+static void ref_owner_finalize(napi_env env, void *data, void *hint)
+{
+    (void)hint;
+    // The wrap carries the ref itself, not the entry, which env teardown may
+    // already have freed.
+    pinggy_ref_release(env, (pinggy_ref_t)(uintptr_t)data);
+}
+
+// refOwner(ref): returns a token object; the ref is freed once the token is
+// garbage collected. At most one token exists per ref.
+napi_value RefOwner(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (ref)");
+
+    uint32_t ref;
+    status = napi_get_value_uint32(env, args[0], &ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected argument to be an unsigned integer (ref)");
+
+    uv_once(&g_refs_once, refs_init_once);
+    uv_mutex_lock(&g_refs_lock);
+    OwnedRef *entry = ref_find((pinggy_ref_t)ref);
+    int owned = entry != NULL && entry->env == env;
+    int wrapped = owned && entry->wrapped;
+    if (owned)
+    {
+        entry->wrapped = 1;
+    }
+    uv_mutex_unlock(&g_refs_lock);
+
+    NAPI_CHECK_CONDITION_THROW(env, owned, "Ref is not owned by this thread");
+    NAPI_CHECK_CONDITION_THROW(env, !wrapped, "Ref already has an owner");
+
+    napi_value token;
+    status = napi_create_object(env, &token);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create owner object");
+    status = napi_wrap(env, token, (void *)(uintptr_t)ref, ref_owner_finalize, NULL, NULL);
+    if (status != napi_ok)
+    {
+        uv_mutex_lock(&g_refs_lock);
+        entry = ref_find((pinggy_ref_t)ref);
+        if (entry != NULL)
+        {
+            entry->wrapped = 0;
+        }
+        uv_mutex_unlock(&g_refs_lock);
+        NAPI_THROW_ERROR(env, "Failed to wrap owner object");
+    }
+    return token;
+}
+
+napi_value InitRefs(napi_env env, napi_value exports)
+{
+    napi_value owner_fn;
+
+    napi_create_function(env, NULL, 0, RefOwner, NULL, &owner_fn);
+    napi_set_named_property(env, exports, "refOwner", owner_fn);
+
+    return exports;
+}
@@ -0,0 +1,38 @@
+#ifndef PINGGY_REFS_H
+#define PINGGY_REFS_H
+
+#include <node_api.h>
+#include "../pinggy.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Ownership of the config and tunnel refs handed out to JS.
+    //
+    // Refs stay plain numbers on the JS side. Each one created by the addon is
+    // recorded against the env that created it and freed with pinggy_free_ref
+    // when the owner token returned by refOwner() is garbage collected, or
+    // when the env is torn down, whichever comes first.
+
+    typedef enum
+    {
+        PINGGY_REF_CONFIG = 0,
+        PINGGY_REF_TUNNEL,
+    } PinggyRefKind;
+
+    // Records that `env` owns `ref`. Ignores INVALID_PINGGY_REF.
+    void pinggy_ref_own(napi_env env, pinggy_ref_t ref, PinggyRefKind kind);
+
+    // Frees `ref` if `env` owns it; a tunnel is stopped and its callbacks are
+    // released first. Returns non-zero if the ref was freed. JS thread only.
+    int pinggy_ref_release(napi_env env, pinggy_ref_t ref);
+
+    napi_value InitRefs(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_REFS_H
@@ -0,0 +1,300 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "helper_macro.h"
+#include "usage.h"
+
+// JSON keys of the counters, indexed by PinggyUsageField.
+static const char *const usage_keys[PINGGY_USAGE_FIELD_COUNT] = {
+    "elapsedTime",
+    "numLiveConnections",
+    "numTotalConnections",
+    "numTotalReqBytes",
+    "numTotalResBytes",
+    "numTotalTxBytes",
+};
+
+typedef struct UsageView
+{
+    pinggy_ref_t tunnel;
+    napi_env env;
+    napi_ref view_ref;
+    double *values; // backing store of the Float64Array, kept alive by view_ref
+
+    struct UsageView *next;
+} UsageView;
+
+static UsageView *g_views = NULL;
+static uv_mutex_t g_views_lock;
+static uv_once_t g_views_once = UV_ONCE_INIT;
+
+static void views_init_once(void)
+{
+    uv_mutex_init(&g_views_lock);
+}
+
+static int usage_key_index(const char *key, size_t len)
+{
+    for (int i = 0; i < PINGGY_USAGE_FIELD_COUNT; i++)
+    {
+        if (strncmp(usage_keys[i], key, len) == 0 && usage_keys[i][len] == '\0')
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static const char *skip_space(const char *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+    {
+        p++;
+    }
+    return p;
+}
+
+int pinggy_usage_parse(const char *json, double *values)
+{
+    int found = 0;
+    unsigned int seen = 0;
+    const char *p = json;
+
+    if (json == NULL)
+    {
+        return 0;
+    }
+
+    // libpinggy sends a flat object of numbers. Every quoted token followed by
+    // a colon is taken as a key; string values fail that test and are skipped.
+    while (*p != '\0')
+    {
+        if (*p != '"')
+        {
+            p++;
+            continue;
+        }
+        const char *key = ++p;
+        while (*p != '\0' && *p != '"')
+        {
+            if (*p == '\\' && p[1] != '\0')
+            {
+                p++;
+            }
+            p++;
+        }
+        if (*p == '\0')
+        {
+            break;
+        }
+        size_t len = (size_t)(p - key);
+        p = skip_space(p + 1);
+        if (*p != ':')
+        {
+            continue;
+        }
+        p = skip_space(p + 1);
+
+        int field = usage_key_index(key, len);
+        if (field < 0)
+        {
+            continue;
+        }
+        char *end;
+        double value = strtod(p, &end);
+        if (end == p)
+        {
+            continue;
+        }
+        values[field] = value;
+        if (!(seen & (1u << field)))
+        {
+            seen |= 1u << field;
+            found++;
+        }
+        p = end;
+    }
+    return found;
+}
+
+// Caller holds g_views_lock.
+static UsageView *view_find(pinggy_ref_t tunnel)
+{
+    for (UsageView *it = g_views; it != NULL; it = it->next)
+    {
+        if (it->tunnel == tunnel)
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+// Caller holds g_views_lock.
+static void view_unlink(UsageView *view)
+{
+    for (UsageView **it = &g_views; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == view)
+        {
+            *it = view->next;
+            break;
+        }
+    }
+}
+
+int tunnel_usage_view_bound(pinggy_ref_t tunnel)
+{
+    int bound;
+    uv_once(&g_views_once, views_init_once);
+    uv_mutex_lock(&g_views_lock);
+    bound = view_find(tunnel) != NULL;
+    uv_mutex_unlock(&g_views_lock);
+    return bound;
+}
+
+int tunnel_usage_view_store(napi_env env, pinggy_ref_t tunnel, const double *values)
+{
+    int stored = 0;
+    uv_once(&g_views_once, views_init_once);
+    uv_mutex_lock(&g_views_lock);
+    UsageView *view = view_find(tunnel);
+    if (view != NULL && view->env == env)
+    {
+        // Only this env's JS thread reads the view, and it is running us.
+        memcpy(view->values, values, PINGGY_USAGE_FIELD_COUNT * sizeof(double));
+        stored = 1;
+    }
+    uv_mutex_unlock(&g_views_lock);
+    return stored;
+}
+
+static void view_env_cleanup(void *arg)
+{
+    UsageView *view = (UsageView *)arg;
+    uv_mutex_lock(&g_views_lock);
+    view_unlink(view);
+    uv_mutex_unlock(&g_views_lock);
+    napi_delete_reference(view->env, view->view_ref);
+    free(view);
+}
+
+void tunnel_usage_view_release(napi_env env, pinggy_ref_t tunnel)
+{
+    uv_once(&g_views_once, views_init_once);
+    uv_mutex_lock(&g_views_lock);
+    UsageView *view = view_find(tunnel);
+    if (view != NULL && view->env == env)
+    {
+        view_unlink(view);
+    }
+    else
+    {
+        view = NULL;
+    }
+    uv_mutex_unlock(&g_views_lock);
+    if (view == NULL)
+    {
+        return;
+    }
+    napi_remove_env_cleanup_hook(env, view_env_cleanup, view);
+    napi_delete_reference(env, view->view_ref);
+    free(view);
+}
+
+// tunnelSetUsageView(tunnelRef, Float64Array | null)
+napi_value TunnelSetUsageView(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value args[2];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (tunnel ref, view)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected first argument to be an unsigned integer (tunnel ref)");
+
+    napi_valuetype view_type;
+    status = napi_typeof(env, args[1], &view_type);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to check view type");
+
+    UsageView *view = NULL;
+    if (view_type != napi_null && view_type != napi_undefined)
+    {
+        bool is_typedarray = false;
+        napi_typedarray_type array_type;
+        size_t length = 0;
+        void *data = NULL;
+
+        napi_is_typedarray(env, args[1], &is_typedarray);
+        NAPI_CHECK_CONDITION_THROW(env, is_typedarray, "Second argument must be a Float64Array or null");
+        status = napi_get_typedarray_info(env, args[1], &array_type, &length, &data, NULL, NULL);
+        NAPI_CHECK_STATUS_THROW(env, status, "Failed to read usage view");
+        NAPI_CHECK_CONDITION_THROW(env, array_type == napi_float64_array && length >= PINGGY_USAGE_FIELD_COUNT,
+                                   "Usage view must be a Float64Array with room for every usage counter");
+
+        view = (UsageView *)calloc(1, sizeof(UsageView));
+        NAPI_CHECK_CONDITION_THROW(env, view != NULL, "Failed to allocate memory for UsageView");
+        view->tunnel = (pinggy_ref_t)tunnel_ref;
+        view->env = env;
+        view->values = (double *)data;
+        status = napi_create_reference(env, args[1], 1, &view->view_ref);
+        NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Unable to create reference", free(view));
+    }
+
+    uv_once(&g_views_once, views_init_once);
+    uv_mutex_lock(&g_views_lock);
+    UsageView *previous = view_find((pinggy_ref_t)tunnel_ref);
+    if (previous != NULL && previous->env != env)
+    {
+        uv_mutex_unlock(&g_views_lock);
+        if (view != NULL)
+        {
+            napi_delete_reference(env, view->view_ref);
+            free(view);
+        }
+        NAPI_THROW_ERROR(env, "Tunnel usage is mirrored by another thread");
+    }
+    if (previous != NULL)
+    {
+        view_unlink(previous);
+    }
+    if (view != NULL)
+    {
+        view->next = g_views;
+        g_views = view;
+    }
+    uv_mutex_unlock(&g_views_lock);
+
+    if (previous != NULL)
+    {
+        napi_remove_env_cleanup_hook(env, view_env_cleanup, previous);
+        napi_delete_reference(env, previous->view_ref);
+        free(previous);
+    }
+    if (view != NULL)
+    {
+        napi_add_env_cleanup_hook(env, view_env_cleanup, view);
+    }
+
+    napi_value js_result;
+    napi_get_boolean(env, view != NULL, &js_result);
+    return js_result;
+}
+
+napi_value InitUsage(napi_env env, napi_value exports)
+{
+    napi_value set_view_fn;
+
+    napi_create_function(env, NULL, 0, TunnelSetUsageView, NULL, &set_view_fn);
+    napi_set_named_property(env, exports, "tunnelSetUsageView", set_view_fn);
+
+    return exports;
+}
@@ -0,0 +1,52 @@
+#ifndef PINGGY_USAGE_H
+#define PINGGY_USAGE_H
+
+#include <node_api.h>
+#include "../pinggy.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Binary usage updates.
+    //
+    // A tunnel with a usage view (a Float64Array bound by tunnelSetUsageView)
+    // gets its usage JSON parsed in the trampoline into fixed slots. On the JS
+    // thread the values are written into the view and the usage callback
+    // receives null instead of the JSON text.
+
+    // Slot of each counter in the view, in the order of TunnelUsageType.
+    typedef enum
+    {
+        PINGGY_USAGE_ELAPSED_TIME = 0,
+        PINGGY_USAGE_NUM_LIVE_CONNECTIONS,
+        PINGGY_USAGE_NUM_TOTAL_CONNECTIONS,
+        PINGGY_USAGE_NUM_TOTAL_REQ_BYTES,
+        PINGGY_USAGE_NUM_TOTAL_RES_BYTES,
+        PINGGY_USAGE_NUM_TOTAL_TX_BYTES,
+        PINGGY_USAGE_FIELD_COUNT
+    } PinggyUsageField;
+
+    // Parses the counters of a usage JSON object into `values`, leaving the
+    // slots of missing keys untouched. Returns the number of distinct counters
+    // found.
+    int pinggy_usage_parse(const char *json, double *values);
+
+    // Non-zero if the tunnel has a usage view. Any thread.
+    int tunnel_usage_view_bound(pinggy_ref_t tunnel);
+
+    // Copies PINGGY_USAGE_FIELD_COUNT values into the tunnel's usage view.
+    // Returns non-zero if `env` owns a view for the tunnel. JS thread only.
+    int tunnel_usage_view_store(napi_env env, pinggy_ref_t tunnel, const double *values);
+
+    // Unbinds the tunnel's usage view, if `env` owns it.
+    void tunnel_usage_view_release(napi_env env, pinggy_ref_t tunnel);
+
+    napi_value InitUsage(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_USAGE_H
@@ -0,0 +1,577 @@
+#include <node_api.h>
+#include <uv.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "../pinggy.h"
+#include "debug.h"
+#include "helper_macro.h"
+#include "wake.h"
+#include "excep.h"
+#include "instance.h"
+
+// A wait is made of up to PINGGY_WAKE_SLICES pinggy_tunnel_resume_timeout
+// calls, none shorter than PINGGY_WAKE_SLICE_MS, and a wakeup is noticed
+// between two of them. See wake.h for what that costs an idle tunnel.
+#ifndef PINGGY_WAKE_SLICE_MS
+#define PINGGY_WAKE_SLICE_MS 50
+#endif
+#ifndef PINGGY_WAKE_SLICES
+#define PINGGY_WAKE_SLICES 4
+#endif
+
+typedef struct WakeSlot
+{
+    pinggy_ref_t tunnel;
+    int waiting;
+    int pending; // wakeup requested and not yet consumed by a wait
+    int woken;   // the current wait was cut short by a wakeup
+
+    uint64_t created_ns;
+    uint64_t wait_start_ns;
+    int32_t wait_timeout_ms;
+    int last_idle; // the last resume ran into its timeout
+    uint64_t resumes;
+    uint64_t idle_resumes;
+    uint64_t wakeups;
+
+    struct WakeSlot *next;
+} WakeSlot;
+
+// A word of shared memory (an Int32Array bound by tunnelSetWakeFlag) that
+// other threads set to non-zero to wake the tunnel without the addon.
+typedef struct WakeFlag
+{
+    pinggy_ref_t tunnel;
+    napi_env env;
+    napi_ref flag_ref;
+    int32_t *word; // backing store of the Int32Array, kept alive by flag_ref
+
+    struct WakeFlag *next;
+} WakeFlag;
+
+static WakeSlot *g_slots = NULL;
+static WakeFlag *g_flags = NULL;
+static void (*g_wake_listener)(pinggy_ref_t tunnel) = NULL;
+static uv_mutex_t g_slots_lock;
+static uv_once_t g_wake_once = UV_ONCE_INIT;
+
+static void wake_init_once(void)
+{
+    uv_mutex_init(&g_slots_lock);
+}
+
+// Caller must hold g_slots_lock.
+static WakeSlot *slot_find(pinggy_ref_t tunnel)
+{
+    for (WakeSlot *it = g_slots; it != NULL; it = it->next)
+    {
+        if (it->tunnel == tunnel)
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+// Caller must hold g_slots_lock.
+static void slot_remove(WakeSlot *slot)
+{
+    for (WakeSlot **it = &g_slots; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == slot)
+        {
+            *it = slot->next;
+            free(slot);
+            return;
+        }
+    }
+}
+
+// Caller must hold g_slots_lock.
+static WakeFlag *flag_find(pinggy_ref_t tunnel)
+{
+    for (WakeFlag *it = g_flags; it != NULL; it = it->next)
+    {
+        if (it->tunnel == tunnel)
+        {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+// Caller must hold g_slots_lock.
+static void flag_unlink(WakeFlag *flag)
+{
+    for (WakeFlag **it = &g_flags; *it != NULL; it = &(*it)->next)
+    {
+        if (*it == flag)
+        {
+            *it = flag->next;
+            return;
+        }
+    }
+}
+
+// Consumes a wakeup requested through tunnel_wake() or the shared flag.
+// Caller must hold g_slots_lock.
+static int slot_take_wakeup(WakeSlot *slot)
+{
+    int pending = slot->pending;
+    slot->pending = 0;
+
+    WakeFlag *flag = flag_find(slot->tunnel);
+    if (flag != NULL && PINGGY_ATOMIC_LOAD32(flag->word) != 0)
+    {
+        PINGGY_ATOMIC_STORE32(flag->word, 0);
+        slot->wakeups++;
+        pending = 1;
+    }
+    return pending;
+}
+
+int tunnel_wake_begin(pinggy_ref_t tunnel)
+{
+    return tunnel_wake_begin_timeout(tunnel, -1);
+}
+
+int tunnel_wake_begin_timeout(pinggy_ref_t tunnel, pinggy_int32_t timeout)
+{
+    int pending = 0;
+
+    // Exceptions raised during the resume belong to this tunnel.
+    pinggy_exception_attribute(tunnel);
+
+    uv_once(&g_wake_once, wake_init_once);
+    uv_mutex_lock(&g_slots_lock);
+
+    WakeSlot *slot = slot_find(tunnel);
+    if (slot == NULL)
+    {
+        slot = (WakeSlot *)calloc(1, sizeof(WakeSlot));
+        if (slot != NULL)
+        {
+            slot->tunnel = tunnel;
+            slot->created_ns = uv_hrtime();
+            slot->next = g_slots;
+            g_slots = slot;
+        }
+    }
+    if (slot != NULL)
+    {
+        slot->waiting = 1;
+        pending = slot_take_wakeup(slot);
+        slot->woken = pending;
+        slot->wait_start_ns = uv_hrtime();
+        slot->wait_timeout_ms = pending ? 0 : timeout;
+    }
+
+    uv_mutex_unlock(&g_slots_lock);
+    return pending;
+}
+
+pinggy_bool_t tunnel_wake_end(pinggy_ref_t tunnel, pinggy_bool_t ret)
+{
+    pinggy_exception_attribute(INVALID_PINGGY_REF);
+
+    uv_once(&g_wake_once, wake_init_once);
+    uv_mutex_lock(&g_slots_lock);
+
+    WakeSlot *slot = slot_find(tunnel);
+    if (slot != NULL)
+    {
+        uint64_t waited_ms = (uv_hrtime() - slot->wait_start_ns) / 1000000;
+        slot->last_idle = !slot->woken && slot->wait_timeout_ms > 0 && waited_ms + 1 >= (uint64_t)slot->wait_timeout_ms;
+        slot->resumes++;
+        if (slot->last_idle)
+        {
+            slot->idle_resumes++;
+        }
+        slot->waiting = 0;
+        slot->woken = 0;
+        if (!ret)
+        {
+            // The tunnel is done; nothing will resume it again.
+            slot_remove(slot);
+        }
+    }
+
+    uv_mutex_unlock(&g_slots_lock);
+    return ret;
+}
+
+// After a slice that ran into its timeout: non-zero if a wakeup arrived
+// during it and the wait should end. Otherwise counts the slice, as another
+// slice follows and tunnel_wake_end() only counts the last one.
+static int slice_end(pinggy_ref_t tunnel)
+{
+    int requested = 0;
+
+    uv_mutex_lock(&g_slots_lock);
+    WakeSlot *slot = slot_find(tunnel);
+    if (slot != NULL)
+    {
+        if (slot_take_wakeup(slot))
+        {
+            slot->woken = 1;
+            requested = 1;
+        }
+        else
+        {
+            slot->resumes++;
+            slot->idle_resumes++;
+        }
+    }
+    uv_mutex_unlock(&g_slots_lock);
+    return requested;
+}
+
+pinggy_bool_t tunnel_wake_resume_timeout(pinggy_ref_t tunnel, pinggy_int32_t timeout)
+{
+    if (tunnel_wake_begin_timeout(tunnel, timeout))
+    {
+        timeout = 0;
+    }
+
+    // libpinggy does not expose what it waits on, so a wakeup cannot
+    // interrupt the wait itself; it is picked up between slices instead.
+    // Slices grow with the timeout, so a tunnel that backed off to a long
+    // timeout also wakes less often.
+    pinggy_int32_t slice_ms = timeout / PINGGY_WAKE_SLICES;
+    if (slice_ms < PINGGY_WAKE_SLICE_MS)
+    {
+        slice_ms = PINGGY_WAKE_SLICE_MS;
+    }
+    uint64_t deadline_ns = uv_hrtime() + (uint64_t)(timeout > 0 ? timeout : 0) * 1000000;
+    pinggy_bool_t ret;
+    for (;;)
+    {
+        pinggy_int32_t slice = timeout;
+        if (timeout < 0 || timeout > slice_ms)
+        {
+            slice = slice_ms;
+        }
+        if (timeout > 0)
+        {
+            uint64_t now_ns = uv_hrtime();
+            uint64_t left_ms = now_ns < deadline_ns ? (deadline_ns - now_ns) / 1000000 : 0;
+            if ((uint64_t)slice > left_ms)
+            {
+                slice = (pinggy_int32_t)left_ms;
+            }
+        }
+
+        uint64_t slice_start_ns = uv_hrtime();
+        ret = pinggy_tunnel_resume_timeout(tunnel, slice);
+        uint64_t sliced_ms = (uv_hrtime() - slice_start_ns) / 1000000;
+
+        // Stop on an error, on activity (the slice returned before its
+        // timeout), once less than a millisecond of the timeout is left, or
+        // when woken.
+        if (!ret || slice == 0 || sliced_ms + 1 < (uint64_t)slice ||
+            (timeout > 0 && uv_hrtime() + 1000000 > deadline_ns) || slice_end(tunnel))
+        {
+            break;
+        }
+    }
+    return tunnel_wake_end(tunnel, ret);
+}
+
+int tunnel_wake(pinggy_ref_t tunnel)
+{
+    int found = 0;
+
+    uv_once(&g_wake_once, wake_init_once);
+    uv_mutex_lock(&g_slots_lock);
+
+    WakeSlot *slot = slot_find(tunnel);
+    if (slot != NULL)
+    {
+        // A thread inside tunnel_wake_resume_timeout sees this after its
+        // current slice; anyone else on their next resume.
+        found = 1;
+        slot->wakeups++;
+        slot->last_idle = 0;
+        slot->pending = 1;
+    }
+    void (*listener)(pinggy_ref_t tunnel) = g_wake_listener;
+
+    uv_mutex_unlock(&g_slots_lock);
+    PINGGY_DEBUG("wake tunnel %u, found = %d", (unsigned)tunnel, found);
+    if (listener != NULL)
+    {
+        listener(tunnel);
+    }
+    return found;
+}
+
+void tunnel_wake_set_listener(void (*listener)(pinggy_ref_t tunnel))
+{
+    uv_once(&g_wake_once, wake_init_once);
+    uv_mutex_lock(&g_slots_lock);
+    g_wake_listener = listener;
+    uv_mutex_unlock(&g_slots_lock);
+}
+
+static void flag_env_cleanup(void *arg)
+{
+    WakeFlag *flag = (WakeFlag *)arg;
+    uv_mutex_lock(&g_slots_lock);
+    flag_unlink(flag);
+    uv_mutex_unlock(&g_slots_lock);
+    napi_delete_reference(flag->env, flag->flag_ref);
+    free(flag);
+}
+
+void tunnel_wake_flag_release(napi_env env, pinggy_ref_t tunnel)
+{
+    uv_once(&g_wake_once, wake_init_once);
+    uv_mutex_lock(&g_slots_lock);
+    WakeFlag *flag = flag_find(tunnel);
+    if (flag != NULL && flag->env == env)
+    {
+        flag_unlink(flag);
+    }
+    else
+    {
+        flag = NULL;
+    }
+    uv_mutex_unlock(&g_slots_lock);
+    if (flag == NULL)
+    {
+        return;
+    }
+    napi_remove_env_cleanup_hook(env, flag_env_cleanup, flag);
+    napi_delete_reference(env, flag->flag_ref);
+    free(flag);
+}
+
+int tunnel_wake_get_stats(pinggy_ref_t tunnel, TunnelWakeStats *stats)
+{
+    int found = 0;
+
+    uv_once(&g_wake_once, wake_init_once);
+    uv_mutex_lock(&g_slots_lock);
+
+    WakeSlot *slot = slot_find(tunnel);
+    if (slot != NULL)
+    {
+        found = 1;
+        stats->resumes = slot->resumes;
+        stats->idle_resumes = slot->idle_resumes;
+        stats->wakeups = slot->wakeups;
+        stats->uptime_ms = (uv_hrtime() - slot->created_ns) / 1000000;
+        stats->last_timeout_ms = slot->wait_timeout_ms;
+    }
+
+    uv_mutex_unlock(&g_slots_lock);
+    return found;
+}
+
+pinggy_int32_t tunnel_wake_next_timeout(pinggy_ref_t tunnel, pinggy_int32_t min_ms, pinggy_int32_t max_ms)
+{
+    pinggy_int32_t next = min_ms;
+
+    uv_once(&g_wake_once, wake_init_once);
+    uv_mutex_lock(&g_slots_lock);
+
+    WakeSlot *slot = slot_find(tunnel);
+    if (slot != NULL && slot->last_idle && !slot->pending)
+    {
+        int32_t last = slot->wait_timeout_ms > min_ms ? slot->wait_timeout_ms : min_ms;
+        next = last > max_ms / 2 ? max_ms : last * 2;
+    }
+
+    uv_mutex_unlock(&g_slots_lock);
+    return next < min_ms ? min_ms : next;
+}
+
+int tunnel_wake_last_idle(pinggy_ref_t tunnel)
+{
+    int idle = 0;
+
+    uv_once(&g_wake_once, wake_init_once);
+    uv_mutex_lock(&g_slots_lock);
+
+    WakeSlot *slot = slot_find(tunnel);
+    if (slot != NULL)
+    {
+        idle = slot->last_idle && !slot->pending;
+    }
+
+    uv_mutex_unlock(&g_slots_lock);
+    return idle;
+}
+
+// tunnelWakeup(tunnelRef): ends the current resume of the tunnel early.
+napi_value TunnelWakeup(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (tunnel ref)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected argument to be an unsigned integer (tunnel ref)");
+
+    int found = tunnel_wake((pinggy_ref_t)tunnel_ref);
+
+    napi_value js_result;
+    napi_get_boolean(env, found, &js_result);
+    return js_result;
+}
+
+// tunnelSetWakeFlag(tunnelRef, Int32Array | null): binds the word that wakes the tunnel.
+napi_value TunnelSetWakeFlag(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value args[2];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 2, "Expected two arguments (tunnel ref, flag)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected first argument to be an unsigned integer (tunnel ref)");
+
+    napi_valuetype flag_type;
+    status = napi_typeof(env, args[1], &flag_type);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to check flag type");
+
+    tunnel_wake_flag_release(env, (pinggy_ref_t)tunnel_ref);
+    if (flag_type == napi_null || flag_type == napi_undefined)
+    {
+        napi_value js_result;
+        napi_get_boolean(env, false, &js_result);
+        return js_result;
+    }
+
+    bool is_typedarray = false;
+    napi_typedarray_type array_type;
+    size_t length = 0;
+    void *data = NULL;
+
+    napi_is_typedarray(env, args[1], &is_typedarray);
+    NAPI_CHECK_CONDITION_THROW(env, is_typedarray, "Second argument must be an Int32Array or null");
+    status = napi_get_typedarray_info(env, args[1], &array_type, &length, &data, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to read wake flag");
+    NAPI_CHECK_CONDITION_THROW(env, array_type == napi_int32_array && length >= 1, "Wake flag must be a non-empty Int32Array");
+
+    WakeFlag *flag = (WakeFlag *)calloc(1, sizeof(WakeFlag));
+    NAPI_CHECK_CONDITION_THROW(env, flag != NULL, "Failed to allocate memory for WakeFlag");
+    flag->tunnel = (pinggy_ref_t)tunnel_ref;
+    flag->env = env;
+    flag->word = (int32_t *)data;
+    status = napi_create_reference(env, args[1], 1, &flag->flag_ref);
+    NAPI_CHECK_STATUS_THROW_CLEANUP(env, status, "Unable to create reference", free(flag));
+
+    uv_mutex_lock(&g_slots_lock);
+    WakeFlag *previous = flag_find(flag->tunnel);
+    if (previous != NULL)
+    {
+        uv_mutex_unlock(&g_slots_lock);
+        napi_delete_reference(env, flag->flag_ref);
+        free(flag);
+        NAPI_THROW_ERROR(env, "Tunnel wake flag is bound by another thread");
+    }
+    flag->next = g_flags;
+    g_flags = flag;
+    uv_mutex_unlock(&g_slots_lock);
+    napi_add_env_cleanup_hook(env, flag_env_cleanup, flag);
+
+    napi_value js_result;
+    napi_get_boolean(env, true, &js_result);
+    return js_result;
+}
+
+// tunnelNextResumeTimeout(tunnelRef, minMs, maxMs): adaptive idle timeout.
+napi_value TunnelNextResumeTimeout(napi_env env, napi_callback_info info)
+{
+    size_t argc = 3;
+    napi_value args[3];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 3, "Expected three arguments (tunnel ref, min timeout, max timeout)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected first argument to be an unsigned integer (tunnel ref)");
+
+    int32_t min_ms, max_ms;
+    status = napi_get_value_int32(env, args[1], &min_ms);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected second argument to be an integer (min timeout)");
+    status = napi_get_value_int32(env, args[2], &max_ms);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected third argument to be an integer (max timeout)");
+    NAPI_CHECK_CONDITION_THROW(env, min_ms >= 0 && max_ms >= min_ms, "Invalid timeout range");
+
+    napi_value js_result;
+    napi_create_int32(env, tunnel_wake_next_timeout((pinggy_ref_t)tunnel_ref, min_ms, max_ms), &js_result);
+    return js_result;
+}
+
+// tunnelGetWakeStats(tunnelRef): scheduling counters, or null for an unknown tunnel.
+napi_value TunnelGetWakeStats(napi_env env, napi_callback_info info)
+{
+    size_t argc = 1;
+    napi_value args[1];
+    napi_status status;
+
+    status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected one argument (tunnel ref)");
+
+    uint32_t tunnel_ref;
+    status = napi_get_value_uint32(env, args[0], &tunnel_ref);
+    NAPI_CHECK_STATUS_THROW(env, status, "Expected argument to be an unsigned integer (tunnel ref)");
+
+    TunnelWakeStats stats;
+    napi_value js_result;
+    if (!tunnel_wake_get_stats((pinggy_ref_t)tunnel_ref, &stats))
+    {
+        napi_get_null(env, &js_result);
+        return js_result;
+    }
+
+    napi_value value;
+    status = napi_create_object(env, &js_result);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create object");
+    napi_create_double(env, (double)stats.resumes, &value);
+    napi_set_named_property(env, js_result, "resumes", value);
+    napi_create_double(env, (double)stats.idle_resumes, &value);
+    napi_set_named_property(env, js_result, "idleResumes", value);
+    napi_create_double(env, (double)stats.wakeups, &value);
+    napi_set_named_property(env, js_result, "wakeups", value);
+    napi_create_double(env, (double)stats.uptime_ms, &value);
+    napi_set_named_property(env, js_result, "uptimeMs", value);
+    napi_create_int32(env, stats.last_timeout_ms, &value);
+    napi_set_named_property(env, js_result, "lastTimeoutMs", value);
+
+    return js_result;
+}
+
+napi_value InitWake(napi_env env, napi_value exports)
+{
+    napi_value tunnel_wakeup_fn, tunnel_set_wake_flag_fn, tunnel_next_resume_timeout_fn, tunnel_get_wake_stats_fn;
+
+    napi_create_function(env, NULL, 0, TunnelWakeup, NULL, &tunnel_wakeup_fn);
+    napi_set_named_property(env, exports, "tunnelWakeup", tunnel_wakeup_fn);
+
+    napi_create_function(env, NULL, 0, TunnelSetWakeFlag, NULL, &tunnel_set_wake_flag_fn);
+    napi_set_named_property(env, exports, "tunnelSetWakeFlag", tunnel_set_wake_flag_fn);
+
+    napi_create_function(env, NULL, 0, TunnelNextResumeTimeout, NULL, &tunnel_next_resume_timeout_fn);
+    napi_set_named_property(env, exports, "tunnelNextResumeTimeout", tunnel_next_resume_timeout_fn);
+
+    napi_create_function(env, NULL, 0, TunnelGetWakeStats, NULL, &tunnel_get_wake_stats_fn);
+    napi_set_named_property(env, exports, "tunnelGetWakeStats", tunnel_get_wake_stats_fn);
+
+    return exports;
+}
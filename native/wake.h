@@ -0,0 +1,90 @@
+#ifndef PINGGY_WAKE_H
+#define PINGGY_WAKE_H
+
+#include <node_api.h>
+#include <stdint.h>
+#include "../pinggy.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // Wakeups for threads blocked in pinggy_tunnel_resume*.
+    //
+    // libpinggy does not expose the descriptors it waits on, so nothing can
+    // interrupt a wait in progress. tunnel_wake_resume_timeout() waits in
+    // slices instead and returns after the slice during which a wakeup
+    // arrived. A wait of T ms is split into slices of max(T / 4, 50) ms, so
+    // each slice is a thread wakeup and the slice length bounds the latency
+    // of a wakeup. With the 100-1000 ms timeouts of the JS poll loop and the
+    // pump:
+    //   - an idle tunnel backed off to 1000 ms wakes 4 times a second, and a
+    //     wakeup is noticed within 250 ms;
+    //   - at 200 ms or less (recent traffic) slices are 50 ms, so a wakeup is
+    //     noticed within 50 ms.
+    // A wakeup that arrives while nobody is waiting is remembered and makes
+    // the next resume return immediately.
+    //
+    // Besides tunnel_wake(), a tunnel can be woken through a word of shared
+    // memory bound with tunnelSetWakeFlag: any thread that can see the
+    // SharedArrayBuffer sets it to non-zero, without needing the addon.
+
+    // Registers the calling thread as waiting on the tunnel. Returns non-zero if
+    // a wakeup is already pending, in which case the caller should not block.
+    int tunnel_wake_begin(pinggy_ref_t tunnel);
+
+    // Same, recording the timeout the caller is about to wait with.
+    int tunnel_wake_begin_timeout(pinggy_ref_t tunnel, pinggy_int32_t timeout);
+
+    // Unregisters the calling thread. `ret` is the result of the resume call
+    // and is returned as is.
+    pinggy_bool_t tunnel_wake_end(pinggy_ref_t tunnel, pinggy_bool_t ret);
+
+    // pinggy_tunnel_resume_timeout that can be cut short by tunnel_wake().
+    pinggy_bool_t tunnel_wake_resume_timeout(pinggy_ref_t tunnel, pinggy_int32_t timeout);
+
+    // Marks a wakeup as pending: the resume currently running for the tunnel
+    // returns after its current slice, or the next one returns immediately.
+    // Safe to call from any thread. Returns non-zero if a thread has ever
+    // resumed the tunnel.
+    int tunnel_wake(pinggy_ref_t tunnel);
+
+    // Has every tunnel_wake() call `listener` afterwards, on the waking thread
+    // (which may hold a driver or claim lock, but not the wake lock). For
+    // threads that drive a tunnel without always sitting in its resume and so
+    // have to be told about a wakeup.
+    void tunnel_wake_set_listener(void (*listener)(pinggy_ref_t tunnel));
+
+    // Drops the wake flag `env` bound for the tunnel, if any.
+    void tunnel_wake_flag_release(napi_env env, pinggy_ref_t tunnel);
+
+    // Per-tunnel scheduling counters, kept for as long as the tunnel is resumed.
+    typedef struct
+    {
+        uint64_t resumes;      // returns from pinggy_tunnel_resume*, one per slice, i.e. thread wakeups
+        uint64_t idle_resumes; // those that ran into their timeout with no wakeup pending
+        uint64_t wakeups;      // tunnel_wake() calls
+        uint64_t uptime_ms;    // since the tunnel was first resumed
+        int32_t last_timeout_ms;
+    } TunnelWakeStats;
+
+    // Fills `stats` and returns non-zero if the tunnel has ever been resumed.
+    int tunnel_wake_get_stats(pinggy_ref_t tunnel, TunnelWakeStats *stats);
+
+    // Timeout for the next resume: `min_ms` after a resume that returned early
+    // (traffic, a callback or a wakeup), doubling up to `max_ms` while resumes
+    // keep running into their timeout.
+    pinggy_int32_t tunnel_wake_next_timeout(pinggy_ref_t tunnel, pinggy_int32_t min_ms, pinggy_int32_t max_ms);
+
+    // Non-zero if the tunnel's last resume ran into its timeout and no wakeup
+    // is pending since, i.e. the tunnel had nothing to do.
+    int tunnel_wake_last_idle(pinggy_ref_t tunnel);
+
+    napi_value InitWake(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_WAKE_H
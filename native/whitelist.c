@@ -0,0 +1,577 @@
+#include <node_api.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "helper_macro.h"
+#include "marshal.h"
+#include "whitelist.h"
+
+// An address and prefix length. Addresses of both families are kept
+// left-aligned in 128 bits (IPv4 in the top 32 bits of `hi`), so a prefix
+// length counts bits from the top for either.
+typedef struct
+{
+    uint64_t hi;
+    uint64_t lo;
+    uint8_t length;
+    uint8_t v6;
+} IpPrefix;
+
+// Longest entry as written: a full IPv6 address with its prefix length.
+#define IP_PREFIX_TEXT_MAX (sizeof("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff/128") - 1)
+
+static int decimal(const char *s, size_t n, unsigned max_digits, unsigned *out)
+{
+    // No leading zeros, as in the whitelist's documented formats.
+    if (n == 0 || n > max_digits || (n > 1 && s[0] == '0'))
+    {
+        return 0;
+    }
+    unsigned value = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        if (s[i] < '0' || s[i] > '9')
+        {
+            return 0;
+        }
+        value = value * 10 + (unsigned)(s[i] - '0');
+    }
+    *out = value;
+    return 1;
+}
+
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+static int parse_ipv4(const char *s, size_t n, uint32_t *out)
+{
+    uint32_t addr = 0;
+    size_t start = 0;
+    for (int octet = 0; octet < 4; octet++)
+    {
+        size_t end = start;
+        while (end < n && s[end] != '.')
+        {
+            end++;
+        }
+        unsigned value;
+        if ((octet < 3) != (end < n) || !decimal(s + start, end - start, 3, &value) || value > 255)
+        {
+            return 0;
+        }
+        addr = addr << 8 | value;
+        start = end + 1;
+    }
+    *out = addr;
+    return 1;
+}
+
+// Accepts "::" shortening and a trailing dotted IPv4 address.
+static int parse_ipv6(const char *s, size_t n, uint64_t *hi, uint64_t *lo)
+{
+    uint16_t groups[8];
+    int count = 0;
+    int gap = -1; // groups before the "::", if there is one
+    size_t i = 0;
+
+    if (n >= 2 && s[0] == ':' && s[1] == ':')
+    {
+        gap = 0;
+        i = 2;
+    }
+    while (i < n)
+    {
+        size_t end = i;
+        while (end < n && s[end] != ':' && s[end] != '.')
+        {
+            end++;
+        }
+        if (end < n && s[end] == '.')
+        {
+            uint32_t v4;
+            if (count > 6 || !parse_ipv4(s + i, n - i, &v4))
+            {
+                return 0;
+            }
+            groups[count++] = (uint16_t)(v4 >> 16);
+            groups[count++] = (uint16_t)v4;
+            break;
+        }
+        if (count == 8 || end == i || end - i > 4)
+        {
+            return 0;
+        }
+        unsigned value = 0;
+        for (; i < end; i++)
+        {
+            int digit = hex_digit(s[i]);
+            if (digit < 0)
+            {
+                return 0;
+            }
+            value = value << 4 | (unsigned)digit;
+        }
+        groups[count++] = (uint16_t)value;
+        if (i == n)
+        {
+            break;
+        }
+        // Skip the ':'; a second one marks the gap, a last one is invalid.
+        if (++i == n)
+        {
+            return 0;
+        }
+        if (s[i] == ':')
+        {
+            if (gap >= 0)
+            {
+                return 0;
+            }
+            gap = count;
+            i++;
+        }
+    }
+    if (gap < 0 ? count != 8 : count > 7)
+    {
+        return 0;
+    }
+
+    uint16_t full[8] = {0};
+    if (gap < 0)
+    {
+        memcpy(full, groups, sizeof(full));
+    }
+    else
+    {
+        memcpy(full, groups, (size_t)gap * sizeof(uint16_t));
+        memcpy(full + 8 - (count - gap), groups + gap, (size_t)(count - gap) * sizeof(uint16_t));
+    }
+    *hi = (uint64_t)full[0] << 48 | (uint64_t)full[1] << 32 | (uint64_t)full[2] << 16 | full[3];
+    *lo = (uint64_t)full[4] << 48 | (uint64_t)full[5] << 32 | (uint64_t)full[6] << 16 | full[7];
+    return 1;
+}
+
+// Clears the bits past the prefix length.
+static void prefix_mask(IpPrefix *p)
+{
+    if (p->length <= 64)
+    {
+        p->hi = p->length == 0 ? 0 : p->hi & (~0ULL << (64 - p->length));
+        p->lo = 0;
+    }
+    else if (p->length < 128)
+    {
+        p->lo &= ~0ULL << (128 - p->length);
+    }
+}
+
+static int parse_prefix(const char *s, size_t n, IpPrefix *out)
+{
+    const char *slash = (const char *)memchr(s, '/', n);
+    size_t addr_length = slash != NULL ? (size_t)(slash - s) : n;
+    unsigned max;
+    if (memchr(s, ':', addr_length) != NULL)
+    {
+        if (!parse_ipv6(s, addr_length, &out->hi, &out->lo))
+        {
+            return 0;
+        }
+        out->v6 = 1;
+        max = 128;
+    }
+    else
+    {
+        uint32_t v4;
+        if (!parse_ipv4(s, addr_length, &v4))
+        {
+            return 0;
+        }
+        out->hi = (uint64_t)v4 << 32;
+        out->lo = 0;
+        out->v6 = 0;
+        max = 32;
+    }
+
+    unsigned length = max;
+    if (slash != NULL && (!decimal(slash + 1, n - addr_length - 1, 3, &length) || length > max))
+    {
+        return 0;
+    }
+    out->length = (uint8_t)length;
+    prefix_mask(out);
+    return 1;
+}
+
+// Bytes of the sort key, least significant first: prefix length, `lo`,
+// `hi`, then the family. Sorted on it, prefixes are in address order with
+// a shorter prefix ahead of the longer ones at the same address.
+#define PREFIX_KEY_BYTES 18
+
+static unsigned prefix_key_byte(const IpPrefix *p, unsigned byte)
+{
+    if (byte == 0)
+        return p->length;
+    if (byte <= 8)
+        return (unsigned)(p->lo >> (8 * (byte - 1))) & 0xff;
+    if (byte <= 16)
+        return (unsigned)(p->hi >> (8 * (byte - 9))) & 0xff;
+    return p->v6;
+}
+
+// LSD radix sort, linear in the number of prefixes. Key bytes every prefix
+// shares are skipped, which for IPv4 leaves at most five passes. Returns 0
+// if out of memory.
+static int prefix_sort(IpPrefix *items, size_t count)
+{
+    if (count < 2)
+    {
+        return 1;
+    }
+    size_t(*counts)[256] = (size_t(*)[256])calloc(PREFIX_KEY_BYTES, sizeof(*counts));
+    IpPrefix *scratch = (IpPrefix *)malloc(count * sizeof(IpPrefix));
+    if (counts == NULL || scratch == NULL)
+    {
+        free(counts);
+        free(scratch);
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        for (unsigned byte = 0; byte < PREFIX_KEY_BYTES; byte++)
+        {
+            counts[byte][prefix_key_byte(&items[i], byte)]++;
+        }
+    }
+
+    IpPrefix *src = items;
+    IpPrefix *dst = scratch;
+    for (unsigned byte = 0; byte < PREFIX_KEY_BYTES; byte++)
+    {
+        size_t *bucket = counts[byte];
+        if (bucket[prefix_key_byte(&src[0], byte)] == count)
+        {
+            continue;
+        }
+        size_t offset = 0;
+        for (unsigned value = 0; value < 256; value++)
+        {
+            size_t n = bucket[value];
+            bucket[value] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            dst[bucket[prefix_key_byte(&src[i], byte)]++] = src[i];
+        }
+        IpPrefix *swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if (src != items)
+    {
+        memcpy(items, src, count * sizeof(IpPrefix));
+    }
+    free(counts);
+    free(scratch);
+    return 1;
+}
+
+static int prefix_covers(const IpPrefix *outer, const IpPrefix *inner)
+{
+    if (outer->v6 != inner->v6 || outer->length > inner->length)
+    {
+        return 0;
+    }
+    IpPrefix masked = *inner;
+    masked.length = outer->length;
+    prefix_mask(&masked);
+    return masked.hi == outer->hi && masked.lo == outer->lo;
+}
+
+// Turns `first` into its parent if `second` is its sibling: the same
+// prefix with the last bit set.
+static int prefix_merge(IpPrefix *first, const IpPrefix *second)
+{
+    if (first->v6 != second->v6 || first->length != second->length || first->length == 0)
+    {
+        return 0;
+    }
+    unsigned bit = first->length - 1u;
+    uint64_t hi = first->hi;
+    uint64_t lo = first->lo;
+    if (bit < 64)
+    {
+        hi |= 1ULL << (63 - bit);
+    }
+    else
+    {
+        lo |= 1ULL << (127 - bit);
+    }
+    if ((hi == first->hi && lo == first->lo) || hi != second->hi || lo != second->lo)
+    {
+        return 0;
+    }
+    first->length--;
+    return 1;
+}
+
+static char *write_decimal(char *out, unsigned value)
+{
+    char digits[3];
+    int n = 0;
+    do
+    {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0)
+    {
+        *out++ = digits[--n];
+    }
+    return out;
+}
+
+static char *write_hex(char *out, unsigned value)
+{
+    static const char digits[] = "0123456789abcdef";
+    int shift = 12;
+    while (shift > 0 && (value >> shift) == 0)
+    {
+        shift -= 4;
+    }
+    for (; shift >= 0; shift -= 4)
+    {
+        *out++ = digits[(value >> shift) & 0xf];
+    }
+    return out;
+}
+
+static char *write_ipv4(char *out, uint32_t addr)
+{
+    for (int shift = 24; shift >= 0; shift -= 8)
+    {
+        out = write_decimal(out, (addr >> shift) & 0xff);
+        if (shift > 0)
+        {
+            *out++ = '.';
+        }
+    }
+    return out;
+}
+
+// Writes the prefix as text, in the RFC 5952 form for IPv6.
+static char *write_prefix(char *out, const IpPrefix *p)
+{
+    if (!p->v6)
+    {
+        out = write_ipv4(out, (uint32_t)(p->hi >> 32));
+    }
+    else if (p->hi == 0 && (p->lo >> 32) == 0xffff)
+    {
+        // IPv4-mapped, written with the IPv4 address in dotted form.
+        memcpy(out, "::ffff:", 7);
+        out = write_ipv4(out + 7, (uint32_t)p->lo);
+    }
+    else
+    {
+        unsigned groups[8];
+        for (int i = 0; i < 4; i++)
+        {
+            groups[i] = (unsigned)(p->hi >> (48 - 16 * i)) & 0xffff;
+            groups[4 + i] = (unsigned)(p->lo >> (48 - 16 * i)) & 0xffff;
+        }
+        // The first longest run of two or more zero groups becomes "::".
+        int gap = -1, gap_length = 1;
+        for (int i = 0; i < 8;)
+        {
+            int run = 0;
+            while (i + run < 8 && groups[i + run] == 0)
+            {
+                run++;
+            }
+            if (run > gap_length)
+            {
+                gap = i;
+                gap_length = run;
+            }
+            i += run > 0 ? run : 1;
+        }
+        for (int i = 0; i < 8; i++)
+        {
+            if (i == gap)
+            {
+                *out++ = ':';
+                *out++ = ':';
+                i += gap_length - 1;
+                continue;
+            }
+            if (i > 0 && i != gap + gap_length)
+            {
+                *out++ = ':';
+            }
+            out = write_hex(out, groups[i]);
+        }
+    }
+    if (p->length < (p->v6 ? 128 : 32))
+    {
+        *out++ = '/';
+        out = write_decimal(out, p->length);
+    }
+    return out;
+}
+
+// Number of comma-separated entries in `length` bytes.
+static size_t entry_count(const char *entries, size_t length)
+{
+    if (length == 0)
+    {
+        return 0;
+    }
+    size_t count = 1;
+    for (const char *c = entries; (c = (const char *)memchr(c, ',', (size_t)(entries + length - c))) != NULL; c++)
+    {
+        count++;
+    }
+    return count;
+}
+
+int pinggy_ip_list_compile(const char *entries, size_t length, char **json, PinggyIpListError *error)
+{
+    size_t capacity = entry_count(entries, length);
+    IpPrefix *prefixes = (IpPrefix *)malloc((capacity > 0 ? capacity : 1) * sizeof(IpPrefix));
+    if (prefixes == NULL)
+    {
+        return -2;
+    }
+
+    size_t count = 0;
+    for (size_t start = 0; count < capacity; count++)
+    {
+        const char *comma = (const char *)memchr(entries + start, ',', length - start);
+        size_t end = comma != NULL ? (size_t)(comma - entries) : length;
+        if (!parse_prefix(entries + start, end - start, &prefixes[count]))
+        {
+            error->index = count;
+            error->offset = start;
+            error->length = end - start;
+            free(prefixes);
+            return -1;
+        }
+        start = end + 1;
+    }
+
+    // In address order, with a shorter prefix ahead of those it covers, a
+    // prefix can only be covered by or merge with the last one kept.
+    if (!prefix_sort(prefixes, count))
+    {
+        free(prefixes);
+        return -2;
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (kept > 0 && prefix_covers(&prefixes[kept - 1], &prefixes[i]))
+        {
+            continue;
+        }
+        prefixes[kept++] = prefixes[i];
+        while (kept >= 2 && prefix_merge(&prefixes[kept - 2], &prefixes[kept - 1]))
+        {
+            kept--;
+        }
+    }
+
+    // Each prefix is written quoted, with a separating comma.
+    char *text = (char *)malloc(kept * (IP_PREFIX_TEXT_MAX + 3) + 3);
+    if (text == NULL)
+    {
+        free(prefixes);
+        return -2;
+    }
+    char *out = text;
+    *out++ = '[';
+    for (size_t i = 0; i < kept; i++)
+    {
+        if (i > 0)
+        {
+            *out++ = ',';
+        }
+        *out++ = '"';
+        out = write_prefix(out, &prefixes[i]);
+        *out++ = '"';
+    }
+    *out++ = ']';
+    *out = '\0';
+
+    free(prefixes);
+    *json = text;
+    return (int)kept;
+}
+
+// ipWhiteListCompile(entries, count?): the smallest JSON whitelist covering
+// the same addresses as the comma-separated `entries`, ready for
+// configSetIpWhiteList. Throws naming the first entry that is not an IP
+// address or CIDR prefix. With `count`, the number of entries that were
+// joined, also throws if an entry held a comma of its own.
+static napi_value IpWhiteListCompile(napi_env env, napi_callback_info info)
+{
+    size_t argc = 2;
+    napi_value args[2];
+    napi_status status = napi_get_cb_info(env, info, &argc, args, NULL, NULL);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to parse arguments");
+    NAPI_CHECK_CONDITION_THROW(env, argc >= 1, "Expected arguments (entries, count?)");
+
+    PinggyString entries;
+    status = pinggy_string_from_js(env, args[0], &entries);
+    NAPI_CHECK_STATUS_THROW(env, status, "Invalid entries argument");
+
+    uint32_t expected;
+    if (argc >= 2 && napi_get_value_uint32(env, args[1], &expected) == napi_ok &&
+        entry_count(entries.data, entries.length) != expected)
+    {
+        pinggy_string_release(env, &entries);
+        napi_throw_error(env, NULL, "Invalid IP address list: an entry contains ','");
+        return NULL;
+    }
+
+    char *json = NULL;
+    PinggyIpListError error;
+    int count = pinggy_ip_list_compile(entries.data, entries.length, &json, &error);
+    if (count == -1)
+    {
+        char message[200];
+        int shown = error.length > 64 ? 64 : (int)error.length;
+        snprintf(message, sizeof(message), "Invalid IP address at index %zu: %.*s%s", error.index, shown,
+                 entries.data + error.offset, error.length > 64 ? "..." : "");
+        pinggy_string_release(env, &entries);
+        napi_throw_error(env, NULL, message);
+        return NULL;
+    }
+    pinggy_string_release(env, &entries);
+    NAPI_CHECK_CONDITION_THROW(env, count >= 0, "Out of memory compiling whitelist");
+
+    napi_value result;
+    status = pinggy_string_create(env, json, NAPI_AUTO_LENGTH, &result);
+    free(json);
+    NAPI_CHECK_STATUS_THROW(env, status, "Failed to create whitelist string");
+    return result;
+}
+
+napi_value InitWhitelist(napi_env env, napi_value exports)
+{
+    napi_value compile_fn;
+
+    napi_create_function(env, NULL, 0, IpWhiteListCompile, NULL, &compile_fn);
+    napi_set_named_property(env, exports, "ipWhiteListCompile", compile_fn);
+
+    return exports;
+}
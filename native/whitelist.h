@@ -0,0 +1,41 @@
+#ifndef PINGGY_WHITELIST_H
+#define PINGGY_WHITELIST_H
+
+#include <node_api.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // IP whitelist compiler.
+    //
+    // Takes the entries of an IP whitelist (IPv4 or IPv6 addresses, with or
+    // without a /prefix length), masks off host bits, drops duplicates and
+    // prefixes covered by others, and merges sibling prefixes until no two
+    // can be joined. The result covers exactly the addresses the entries do
+    // and is written as the JSON array pinggy_config_set_ip_white_list
+    // takes, with full-length prefixes as plain addresses.
+
+    // Where the first invalid entry sits in the input.
+    typedef struct
+    {
+        size_t index;  // position in the list
+        size_t offset; // first byte of the entry
+        size_t length; // bytes in the entry
+    } PinggyIpListError;
+
+    // Compiles `length` bytes of comma-separated entries; an empty input is
+    // an empty list. On success stores a malloc'ed, NUL-terminated JSON array
+    // in `*json` and returns the number of prefixes in it. Returns -1 with
+    // `*error` filled in if an entry is invalid, -2 if out of memory.
+    int pinggy_ip_list_compile(const char *entries, size_t length, char **json, PinggyIpListError *error);
+
+    napi_value InitWhitelist(napi_env env, napi_value exports);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PINGGY_WHITELIST_H
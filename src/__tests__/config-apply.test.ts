@@ -0,0 +1,244 @@
+import { describe, beforeEach, test, expect, jest } from "@jest/globals";
+import { Config } from "../bindings/config";
+import { PinggyError } from "../bindings/exception";
+import { TunnelConfigurationV1 } from "../tunnelConfiguration";
+import { TunnelInstance } from "../tunnel-instance";
+import { TunnelStateCode } from "../types";
+
+// Reactor-driven instances run in process; the worker must never be loaded.
+jest.mock("../worker/tunnel-worker-manager", () => ({ TunnelWorkerManager: {} }));
+
+// Field order of the mocked addon; Config has to look indices up in it.
+const FIELD_KEYS = [
+  "serverAddress", "sniServerName", "token", "forwardings", "argument",
+  "ipWhiteList", "basicAuths", "bearerTokenAuths", "headerModification",
+  "localServerTls", "webdebuggerAddr", "advancedParsing", "force", "ssl",
+  "insecure", "httpsOnly", "allowPreflight", "xForwardedFor", "reverseProxy",
+  "originalRequestUrl", "autoReconnect", "webdebugger", "reconnectInterval",
+  "maxReconnectAttempts",
+] as const;
+
+const TOKEN = "token-0123456789";
+
+/**
+ * An addon with configApply, configSnapshot and ipWhiteListCompile, backed by
+ * a plain object per config, so values round-trip like they do through
+ * libpinggy. Setters and getters are left out: Config must not need them.
+ */
+function createMockAddon() {
+  const configs = new Map<number, Record<string, unknown>>();
+  let nextRef = 1;
+  let lastException: string | null = null;
+
+  const addon = {
+    configs,
+    configFieldKeys: FIELD_KEYS,
+    createConfig: jest.fn(() => {
+      configs.set(nextRef, {});
+      return nextRef++;
+    }),
+    getLastException: jest.fn(() => {
+      const ex = lastException;
+      lastException = null;
+      return ex;
+    }),
+    configApply: jest.fn((ref: number, ...fieldsAndValues: unknown[]) => {
+      const fields = configs.get(ref)!;
+      for (let i = 0; i < fieldsAndValues.length; i += 2) {
+        const key = FIELD_KEYS[fieldsAndValues[i] as number];
+        const value = fieldsAndValues[i + 1];
+        if (key === "serverAddress" && value === "rejected.example:443") {
+          lastException = "ConfigError  invalid server address";
+          return key;
+        }
+        fields[key] = value;
+      }
+      return undefined;
+    }),
+    configSnapshot: jest.fn((ref: number) => {
+      const fields = configs.get(ref)!;
+      const snapshot: Record<string, unknown> = {};
+      for (const key of FIELD_KEYS) {
+        const value = fields[key];
+        if (key === "reconnectInterval" || key === "maxReconnectAttempts") snapshot[key] = value ?? 0;
+        else if (["serverAddress", "sniServerName", "token", "forwardings", "argument", "ipWhiteList",
+          "basicAuths", "bearerTokenAuths", "headerModification", "localServerTls", "webdebuggerAddr"].includes(key)) {
+          snapshot[key] = value ?? null;
+        } else snapshot[key] = value ?? false;
+      }
+      return snapshot;
+    }),
+    // Stands in for the native compiler: sorts and drops duplicates.
+    ipWhiteListCompile: jest.fn((entries: string, count?: number) => {
+      const list = entries ? entries.split(",") : [];
+      if (count !== undefined && list.length !== count) throw new Error("Invalid IP address list: an entry contains ','");
+      const invalid = list.findIndex((entry) => !/^[0-9a-f:.]+(\/\d+)?$/i.test(entry));
+      if (invalid >= 0) throw new Error(`Invalid IP address at index ${invalid}: ${list[invalid]}`);
+      return JSON.stringify([...new Set(list)].sort());
+    }),
+  };
+  return addon;
+}
+
+describe("Config with configApply and configSnapshot", () => {
+  let addon: ReturnType<typeof createMockAddon>;
+
+  beforeEach(() => {
+    addon = createMockAddon();
+  });
+
+  function createConfig(options: TunnelConfigurationV1 = {}): Config {
+    return new Config(addon as any, { forwarding: "localhost:3000", ...options });
+  }
+
+  test("applies every field in a single call", () => {
+    createConfig({
+      token: TOKEN,
+      ipWhitelist: ["10.0.0.1"],
+      basicAuth: [{ username: "u", password: "p" }],
+      httpsOnly: true,
+    });
+    expect(addon.configApply).toHaveBeenCalledTimes(1);
+    const args = addon.configApply.mock.calls[0].slice(1);
+    for (let i = 0; i < args.length; i += 2) {
+      expect(typeof args[i]).toBe("number");
+      // Lists and objects cross as JSON text.
+      expect(["string", "boolean", "number"]).toContain(typeof args[i + 1]);
+    }
+    expect(addon.configs.get(1)!.basicAuths).toBe('[{"username":"u","password":"p"}]');
+  });
+
+  test("round-trips the options through configSnapshot", () => {
+    const config = createConfig({
+      token: TOKEN,
+      serverAddress: "t.example:443",
+      ipWhitelist: ["10.0.0.2", "10.0.0.1"],
+      basicAuth: [{ username: "u", password: "p" }],
+      bearerTokenAuth: ["k1", "k2"],
+      headerModification: [{ key: "X-A", type: "add", value: ["1"] }],
+      xForwardedFor: true,
+      reconnectInterval: 5,
+    });
+
+    const snapshot = config.getSnapshot();
+    expect(addon.configSnapshot).toHaveBeenCalledTimes(1);
+    expect(snapshot.token).toBe(TOKEN);
+    expect(snapshot.serverAddress).toBe("t.example:443");
+    expect(snapshot.forwarding).toBe("localhost:3000");
+    expect(snapshot.ipWhiteList).toEqual(["10.0.0.1", "10.0.0.2"]);
+    expect(snapshot.basicAuth).toEqual([{ username: "u", password: "p" }]);
+    expect(snapshot.bearerTokenAuth).toEqual(["k1", "k2"]);
+    expect(snapshot.headerModification).toEqual([{ key: "X-A", type: "add", value: ["1"] }]);
+    expect(snapshot.xForwardedFor).toBe(true);
+    expect(snapshot.httpsOnly).toBe(false);
+    expect(snapshot.reconnectInterval).toBe(5);
+  });
+
+  test("reads unset lists as empty", () => {
+    const snapshot = createConfig().getSnapshot();
+    expect(snapshot.ipWhiteList).toEqual([]);
+    expect(snapshot.bearerTokenAuth).toEqual([]);
+    expect(snapshot.basicAuth).toBeNull();
+  });
+
+  test("sends the whitelist through the native compiler", () => {
+    createConfig({ ipWhitelist: ["10.0.0.2", "10.0.0.1", "10.0.0.1"] });
+    expect(addon.ipWhiteListCompile).toHaveBeenCalledWith("10.0.0.2,10.0.0.1,10.0.0.1", 3);
+    expect(addon.configs.get(1)!.ipWhiteList).toBe('["10.0.0.1","10.0.0.2"]');
+  });
+
+  test("reports an invalid whitelist entry as a PinggyError", () => {
+    expect(() => createConfig({ ipWhitelist: ["10.0.0.1", "nope"] })).toThrow(PinggyError);
+    expect(() => createConfig({ ipWhitelist: ["10.0.0.1", "nope"] })).toThrow("Invalid IP address at index 1: nope");
+  });
+
+  test("names an entry holding a comma by its own index", () => {
+    expect(() => createConfig({ ipWhitelist: ["10.0.0.1", "10.0.0.2,10.0.0.3"] }))
+      .toThrow("Invalid IP address at index 1: 10.0.0.2,10.0.0.3");
+  });
+
+  test("throws the exception libpinggy raised for the failing field", () => {
+    expect(() => createConfig({ serverAddress: "rejected.example:443" })).toThrow(PinggyError);
+    expect(() => createConfig({ serverAddress: "rejected.example:443" })).toThrow("invalid server address");
+  });
+});
+
+describe("Config.update", () => {
+  let addon: ReturnType<typeof createMockAddon>;
+  let config: Config;
+
+  beforeEach(() => {
+    addon = createMockAddon();
+    config = new Config(addon as any, {
+      forwarding: "localhost:3000",
+      ipWhitelist: ["10.0.0.1"],
+      bearerTokenAuth: ["k1"],
+    });
+    addon.configApply.mockClear();
+  });
+
+  test("sets only the options that differ", () => {
+    const changed = config.update({ bearerTokenAuth: ["k1"], httpsOnly: true });
+    expect(changed).toEqual(["httpsOnly"]);
+    expect(addon.configApply).toHaveBeenCalledTimes(1);
+    expect(addon.configApply.mock.calls[0]).toEqual([1, FIELD_KEYS.indexOf("httpsOnly"), true]);
+  });
+
+  test("compares the whitelist after compiling it", () => {
+    expect(config.update({ ipWhitelist: ["10.0.0.1", "10.0.0.1"] })).toEqual([]);
+    expect(addon.configApply).not.toHaveBeenCalled();
+
+    expect(config.update({ ipWhitelist: ["10.0.0.2"] })).toEqual(["ipWhitelist"]);
+    expect(config.getSnapshot().ipWhiteList).toEqual(["10.0.0.2"]);
+  });
+
+  test("leaves the config alone when an option is invalid", () => {
+    expect(() => config.update({ basicAuth: [{ username: "", password: "p" }] })).toThrow();
+    expect(addon.configApply).not.toHaveBeenCalled();
+  });
+});
+
+describe("TunnelInstance.updateConfig", () => {
+  let addon: ReturnType<typeof createMockAddon> & { state: TunnelStateCode; getTunnelState: jest.Mock<(ref: number) => TunnelStateCode> };
+  let instance: TunnelInstance;
+
+  beforeEach(async () => {
+    const base = createMockAddon();
+    addon = Object.assign(base, {
+      state: TunnelStateCode.Initial,
+      initExceptionHandling: jest.fn(),
+      tunnelInitiate: jest.fn(() => 100),
+      startTunnelUsageUpdate: jest.fn(),
+      getTunnelState: jest.fn<(ref: number) => TunnelStateCode>(() => addon.state),
+    });
+    instance = await TunnelInstance.create(
+      { forwarding: "localhost:3000", token: TOKEN, serverAddress: "t.example:443", optional: { reactor: 1 } },
+      undefined,
+      addon as any,
+    );
+    addon.configApply.mockClear();
+  });
+
+  test("applies changes to a tunnel that has not connected yet", async () => {
+    const result = await instance.updateConfig({ httpsOnly: true, xForwardedFor: false });
+    expect(result).toEqual({ httpsOnly: "applied", xForwardedFor: "unchanged" });
+    expect(addon.configs.get(1)!.httpsOnly).toBe(true);
+  });
+
+  test("reads the tunnel state in the same call as the update", async () => {
+    addon.state = TunnelStateCode.Connected;
+    expect(await instance.updateConfig({ httpsOnly: true })).toEqual({ httpsOnly: "reconnect" });
+    expect(addon.getTunnelState).toHaveBeenCalledTimes(1);
+    expect(addon.getTunnelState).toHaveBeenCalledWith(100);
+  });
+
+  test("rejects an invalid option and changes nothing", async () => {
+    await expect(instance.updateConfig({ ipWhitelist: ["nope"] })).rejects.toThrow("Invalid IP address at index 0: nope");
+    expect(addon.configApply).not.toHaveBeenCalled();
+  });
+
+  test("needs the native addon for a reactor-driven tunnel", async () => {
+    await expect(TunnelInstance.create({ forwarding: "localhost:3000", optional: { reactor: 1 } }))
+      .rejects.toThrow("needs the native addon");
+  });
+});
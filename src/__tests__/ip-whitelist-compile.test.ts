@@ -0,0 +1,55 @@
+import { describe, test, expect } from "@jest/globals";
+import fs from "fs";
+import path from "path";
+
+// Runs against the built addon; skipped until `npm run build-native` has produced it.
+const addonPath = path.join(__dirname, "../../lib/addon.node");
+const describeWithAddon = fs.existsSync(addonPath) ? describe : describe.skip;
+
+describeWithAddon("ipWhiteListCompile", () => {
+  const addon = fs.existsSync(addonPath) ? require(addonPath) : null;
+
+  function compile(entries: string[]): string[] {
+    return JSON.parse(addon.ipWhiteListCompile(entries.join(","), entries.length));
+  }
+
+  test("merges sibling prefixes", () => {
+    expect(compile(["10.0.0.0/25", "10.0.0.128/25"])).toEqual(["10.0.0.0/24"]);
+    expect(compile(["192.168.1.0/24", "192.168.0.0/24", "192.168.2.0/23"])).toEqual(["192.168.0.0/22"]);
+  });
+
+  test("drops duplicates and covered prefixes", () => {
+    expect(compile(["10.0.0.1", "10.0.0.1"])).toEqual(["10.0.0.1"]);
+    expect(compile(["10.0.0.0/8", "10.1.2.3"])).toEqual(["10.0.0.0/8"]);
+    expect(compile(["::/0", "2001:db8::1"])).toEqual(["::/0"]);
+  });
+
+  test("masks host bits and writes full-length prefixes as addresses", () => {
+    expect(compile(["10.0.0.5/24"])).toEqual(["10.0.0.0/24"]);
+    expect(compile(["1.2.3.4/32"])).toEqual(["1.2.3.4"]);
+    expect(compile(["2001:db8::1/64"])).toEqual(["2001:db8::/64"]);
+  });
+
+  test("writes IPv6 in canonical form", () => {
+    expect(compile(["2001:0DB8:0000:0000::/48"])).toEqual(["2001:db8::/48"]);
+    expect(compile(["2001:db8::/33", "2001:db8:8000::/33"])).toEqual(["2001:db8::/32"]);
+    expect(compile(["fe80::1", "fe80::0"])).toEqual(["fe80::/127"]);
+  });
+
+  test("keeps IPv4 and IPv6 apart", () => {
+    expect(compile(["2001:db8::/32", "2001:db8:1::/48", "10.0.0.0/24"])).toEqual(["10.0.0.0/24", "2001:db8::/32"]);
+  });
+
+  test("compiles an empty list", () => {
+    expect(compile([])).toEqual([]);
+  });
+
+  test("names the first invalid entry", () => {
+    expect(() => compile(["1.2.3.4", "zz"])).toThrow("Invalid IP address at index 1: zz");
+    expect(() => compile(["10.0.0.0/33"])).toThrow("Invalid IP address at index 0: 10.0.0.0/33");
+  });
+
+  test("rejects an entry holding a comma when given the count", () => {
+    expect(() => addon.ipWhiteListCompile("1.2.3.4,5.6.7.8", 1)).toThrow("an entry contains ','");
+  });
+});
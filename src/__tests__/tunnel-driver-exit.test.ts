@@ -0,0 +1,60 @@
+import { describe, beforeEach, test, expect, jest } from "@jest/globals";
+import { Tunnel } from "../bindings/tunnel";
+import { TunnelConfiguration } from "../tunnelConfiguration";
+
+type OnExit = (tunnelRef: number, active: boolean) => void;
+
+function createMockAddon() {
+  const attached: { onExit: OnExit | null } = { onExit: null };
+  return {
+    attached,
+    tunnelInitiate: jest.fn(() => 7),
+    getLastException: jest.fn(() => null),
+    reactorAttach: jest.fn((_reactorId: number, _ref: number, onExit: OnExit) => {
+      attached.onExit = onExit;
+      return true;
+    }),
+    // Ends the poll loop after its first resume.
+    tunnelResumeWithTimeout: jest.fn((_ref: number, _timeout: number) => false),
+    tunnelReleaseCallbacks: jest.fn(),
+  };
+}
+
+describe("Tunnel driven by a reactor", () => {
+  let addon: ReturnType<typeof createMockAddon>;
+  let tunnel: Tunnel;
+  let pollingError: jest.Mock<(error: Error) => void>;
+
+  beforeEach(() => {
+    addon = createMockAddon();
+    tunnel = new Tunnel(addon as any, 1, new TunnelConfiguration({ optional: { reactor: 3 } }));
+    pollingError = jest.fn<(error: Error) => void>();
+    tunnel.setPollingErrorCallback(pollingError);
+    (tunnel as any).pollStart();
+  });
+
+  test("is handed to the reactor instead of being polled", () => {
+    expect(addon.reactorAttach).toHaveBeenCalledWith(3, 7, expect.any(Function));
+    expect(addon.tunnelResumeWithTimeout).not.toHaveBeenCalled();
+  });
+
+  test("falls back to polling when released while still running", () => {
+    addon.attached.onExit!(7, true);
+    expect(addon.tunnelResumeWithTimeout).toHaveBeenCalledWith(7, 100);
+  });
+
+  test("reports a tunnel that ended while driven", () => {
+    addon.attached.onExit!(7, false);
+    expect(addon.tunnelResumeWithTimeout).not.toHaveBeenCalled();
+    expect(pollingError).toHaveBeenCalledTimes(1);
+    expect(addon.tunnelReleaseCallbacks).toHaveBeenCalledWith(7, "Tunnel error detected during polling.");
+  });
+
+  test("stays stopped when released after an intentional stop", () => {
+    (tunnel as any).intentionallyStopped = true;
+    addon.attached.onExit!(7, true);
+    expect(addon.tunnelResumeWithTimeout).not.toHaveBeenCalled();
+    expect(pollingError).not.toHaveBeenCalled();
+    expect(addon.tunnelReleaseCallbacks).toHaveBeenCalledTimes(1);
+  });
+});
@@ -0,0 +1,82 @@
+import { describe, beforeEach, afterEach, test, expect, jest } from "@jest/globals";
+import { Tunnel } from "../bindings/tunnel";
+import { TunnelConfiguration } from "../tunnelConfiguration";
+import { NativeEventType } from "../types";
+import { Logger } from "../utils/logger";
+
+type BatchCallback = (tunnelRef: number, events: [NativeEventType, ...any[]][]) => void;
+
+/** An addon that hands the tunnel's batch callback and usage view to the test. */
+function createMockAddon() {
+  const attached: { batch: BatchCallback | null; view: Float64Array | null } = { batch: null, view: null };
+  return {
+    attached,
+    tunnelInitiate: jest.fn(() => 7),
+    getLastException: jest.fn(() => null),
+    startTunnelUsageUpdate: jest.fn(),
+    tunnelSetUsageView: jest.fn((_ref: number, view: Float64Array | null) => {
+      attached.view = view;
+      return true;
+    }),
+    tunnelSetEventBatchCallback: jest.fn((_ref: number, callback: BatchCallback | null) => {
+      attached.batch = callback;
+      return true;
+    }),
+  };
+}
+
+describe("Tunnel event batches", () => {
+  let addon: ReturnType<typeof createMockAddon>;
+  let tunnel: Tunnel;
+  let liveConnections: number[];
+
+  beforeEach(() => {
+    addon = createMockAddon();
+    tunnel = new Tunnel(addon as any, 1, new TunnelConfiguration({}));
+    liveConnections = [];
+    // The callback gets the same usage object each time; keep what it held then.
+    tunnel.setUsageUpdateCallback((usage) => liveConnections.push(usage.numLiveConnections));
+    (tunnel as any).setupCallbacks();
+  });
+
+  afterEach(() => {
+    jest.restoreAllMocks();
+  });
+
+  test("replaces the per-event callbacks", () => {
+    expect(addon.tunnelSetEventBatchCallback).toHaveBeenCalledWith(7, expect.any(Function));
+    expect(addon.attached.batch).not.toBeNull();
+  });
+
+  test("gives each JSON usage update of a batch its own values", () => {
+    addon.attached.batch!(7, [
+      [NativeEventType.UsageUpdate, 7, JSON.stringify({ numLiveConnections: 1, numTotalConnections: 1 })],
+      [NativeEventType.UsageUpdate, 7, JSON.stringify({ numLiveConnections: 3, numTotalConnections: 4 })],
+    ]);
+    expect(liveConnections).toEqual([1, 3]);
+    expect((tunnel as any)._latestUsage.numTotalConnections).toBe(4);
+  });
+
+  test("reads a null usage update from the usage view", () => {
+    addon.attached.view!.set([1500, 2, 9, 100, 200, 300]);
+    addon.attached.batch!(7, [[NativeEventType.UsageUpdate, 7, null]]);
+    expect(liveConnections).toEqual([2]);
+    expect((tunnel as any)._latestUsage).toMatchObject({ elapsedTime: 1500, numTotalConnections: 9, numTotalTxBytes: 300 });
+  });
+
+  test("delivers the rest of a batch after a handler throws", () => {
+    const reconnected = jest.fn<(urls: string[]) => void>();
+    tunnel.setReconnectionCompletedCallback(reconnected);
+    const info = Logger.info.bind(Logger);
+    jest.spyOn(Logger, "info").mockImplementation((message: string) => {
+      if (message.startsWith("Tunnel reconnecting")) throw new Error("handler failed");
+      info(message);
+    });
+
+    addon.attached.batch!(7, [
+      [NativeEventType.Reconnecting, 7, 1],
+      [NativeEventType.ReconnectionCompleted, 7, ["https://a.example"]],
+    ]);
+    expect(reconnected).toHaveBeenCalledWith(["https://a.example"]);
+  });
+});
@@ -0,0 +1,64 @@
+import { describe, beforeEach, test, expect, jest } from "@jest/globals";
+import { Tunnel } from "../bindings/tunnel";
+import { PinggyError } from "../bindings/exception";
+import { TunnelConfiguration } from "../tunnelConfiguration";
+import { TunnelStatus } from "../types";
+
+/**
+ * An addon whose start promise the test settles. The tunnel runs on a native
+ * pump, so start() never enters the JS poll loop.
+ */
+function createMockAddon() {
+  const established: { resolve: (urls: string[]) => void; reject: (error: Error) => void } = {
+    resolve: () => {},
+    reject: () => {},
+  };
+  return {
+    established,
+    tunnelInitiate: jest.fn(() => 7),
+    getLastException: jest.fn(() => null),
+    tunnelSetEventBatchCallback: jest.fn(() => true),
+    tunnelStartPromise: jest.fn((_ref: number) => new Promise<string[]>((resolve, reject) => {
+      established.resolve = resolve;
+      established.reject = reject;
+    })),
+    tunnelStartAsync: jest.fn(async (_ref: number) => true),
+    tunnelStartPump: jest.fn((_ref: number, _onExit: (ref: number, active: boolean) => void) => true),
+  };
+}
+
+describe("Tunnel.start with a native start promise", () => {
+  let addon: ReturnType<typeof createMockAddon>;
+  let tunnel: Tunnel;
+
+  beforeEach(() => {
+    addon = createMockAddon();
+    tunnel = new Tunnel(addon as any, 1, new TunnelConfiguration({ optional: { nativePump: true } }));
+  });
+
+  test("resolves with the URLs the promise settles with", async () => {
+    const started = tunnel.start();
+    addon.established.resolve(["https://a.example", "http://a.example"]);
+
+    await expect(started).resolves.toEqual(["https://a.example", "http://a.example"]);
+    expect(tunnel.status).toBe(TunnelStatus.LIVE);
+    expect(addon.tunnelStartPromise).toHaveBeenCalledWith(7);
+    expect(addon.tunnelStartPump).toHaveBeenCalledWith(7, expect.any(Function));
+  });
+
+  test("turns a rejection into a PinggyError and closes the tunnel", async () => {
+    const started = tunnel.start();
+    addon.established.reject(new Error("authentication failed"));
+
+    await expect(started).rejects.toThrow(PinggyError);
+    await expect(started).rejects.toThrow("authentication failed");
+    expect(tunnel.status).toBe(TunnelStatus.CLOSED);
+  });
+
+  test("fails without waiting when the tunnel cannot connect", async () => {
+    addon.tunnelStartAsync.mockResolvedValue(false);
+
+    await expect(tunnel.start()).rejects.toThrow("Tunnel connection failed.");
+    expect(addon.tunnelStartPump).not.toHaveBeenCalled();
+  });
+});
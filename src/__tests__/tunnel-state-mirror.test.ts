@@ -0,0 +1,90 @@
+import { describe, beforeEach, test, expect } from "@jest/globals";
+import { TunnelStateMirror } from "../worker/tunnel-state-mirror";
+import { TunnelStatus, TunnelUsageType } from "../types";
+
+const usage: TunnelUsageType = {
+  elapsedTime: 12,
+  numLiveConnections: 3,
+  numTotalConnections: 7,
+  numTotalReqBytes: 1234567890123,
+  numTotalResBytes: 5,
+  numTotalTxBytes: 6.5,
+};
+
+describe("TunnelStateMirror", () => {
+  let writer: TunnelStateMirror;
+  let reader: TunnelStateMirror;
+
+  beforeEach(() => {
+    // Worker and main thread each wrap the same buffer.
+    writer = TunnelStateMirror.create()!;
+    reader = new TunnelStateMirror(writer.buffer);
+  });
+
+  test("reads nothing before the first publish", () => {
+    expect(reader.status()).toBeNull();
+    expect(reader.isActive()).toBeNull();
+    expect(reader.urls()).toBeNull();
+    expect(reader.latestUsage()).toBeNull();
+  });
+
+  test("reads back what was published", () => {
+    writer.publish(TunnelStatus.LIVE, true, ["http://a.example", "https://a.example"], usage);
+    expect(reader.status()).toBe(TunnelStatus.LIVE);
+    expect(reader.isActive()).toBe(true);
+    expect(reader.urls()).toEqual(["http://a.example", "https://a.example"]);
+    expect(reader.latestUsage()).toEqual(usage);
+  });
+
+  test("keeps the last usage when published without one", () => {
+    writer.publish(TunnelStatus.LIVE, true, [], usage);
+    writer.publish(TunnelStatus.CLOSED, false, [], null);
+    expect(reader.status()).toBe(TunnelStatus.CLOSED);
+    expect(reader.isActive()).toBe(false);
+    expect(reader.urls()).toEqual([]);
+    expect(reader.latestUsage()).toEqual(usage);
+  });
+
+  test("picks up changed URLs and hands out copies", () => {
+    writer.publish(TunnelStatus.LIVE, true, ["http://a.example"], null);
+    const first = reader.urls()!;
+    first.push("mutated");
+    expect(reader.urls()).toEqual(["http://a.example"]);
+
+    writer.publish(TunnelStatus.LIVE, true, ["http://b.example"], null);
+    expect(reader.urls()).toEqual(["http://b.example"]);
+  });
+
+  test("gives up on URLs that do not fit", () => {
+    writer.publish(TunnelStatus.LIVE, true, ["x".repeat(5000)], null);
+    expect(reader.urls()).toBeNull();
+    expect(reader.status()).toBe(TunnelStatus.LIVE);
+  });
+
+  test("returns null while a write is in progress", () => {
+    writer.publish(TunnelStatus.LIVE, true, [], usage);
+    const header = new Int32Array(writer.buffer, 0, 1);
+    // An odd sequence number: the writer is between its two stores.
+    Atomics.add(header, 0, 1);
+    expect(reader.status()).toBeNull();
+    expect(reader.latestUsage()).toBeNull();
+
+    Atomics.add(header, 0, 1);
+    expect(reader.status()).toBe(TunnelStatus.LIVE);
+  });
+
+  test("moves the sequence number by two per publish", () => {
+    const header = new Int32Array(writer.buffer, 0, 1);
+    writer.publish(TunnelStatus.LIVE, true, [], null);
+    writer.publish(TunnelStatus.LIVE, true, [], null);
+    expect(Atomics.load(header, 0)).toBe(4);
+  });
+
+  test("carries a wake request to the word the worker binds", () => {
+    expect(reader.wakeFlag[0]).toBe(0);
+    reader.requestWake();
+    expect(writer.wakeFlag[0]).toBe(1);
+    // The wake word is not part of the published state.
+    expect(writer.status()).toBeNull();
+  });
+});
@@ -0,0 +1,81 @@
+import { describe, beforeEach, test, expect, jest } from "@jest/globals";
+import { Tunnel } from "../bindings/tunnel";
+import { TunnelConfiguration } from "../tunnelConfiguration";
+import { TunnelWakeStats } from "../types";
+
+/** Just enough addon for a Tunnel that is never started. */
+function createMockAddon() {
+  const stats: TunnelWakeStats = { resumes: 0, idleResumes: 0, wakeups: 0, uptimeMs: 0, lastTimeoutMs: 100 };
+  return {
+    stats,
+    tunnelInitiate: jest.fn(() => 7),
+    getLastException: jest.fn(() => null),
+    tunnelGetWakeStats: jest.fn((_ref: number): TunnelWakeStats | null => ({ ...stats })),
+    tunnelNextResumeTimeout: jest.fn((_ref: number, minMs: number, _maxMs: number) => minMs),
+  };
+}
+
+describe("Tunnel.getWakeStats", () => {
+  let addon: ReturnType<typeof createMockAddon>;
+  let tunnel: Tunnel;
+
+  beforeEach(() => {
+    addon = createMockAddon();
+    tunnel = new Tunnel(addon as any, 1, new TunnelConfiguration({}));
+  });
+
+  test("reports the wakeup rate since the previous call", () => {
+    // An idle tunnel at the 1000 ms ceiling: four slices per wait.
+    Object.assign(addon.stats, { resumes: 40, idleResumes: 40, uptimeMs: 10000, lastTimeoutMs: 1000 });
+    expect(tunnel.getWakeStats()).toEqual({
+      resumes: 40,
+      idleResumes: 40,
+      wakeups: 0,
+      uptimeMs: 10000,
+      lastTimeoutMs: 1000,
+      wakeupsPerSecond: 4,
+    });
+
+    // Busy for the next two seconds.
+    Object.assign(addon.stats, { resumes: 100, uptimeMs: 12000, lastTimeoutMs: 100 });
+    expect(tunnel.getWakeStats()!.wakeupsPerSecond).toBe(30);
+    expect(addon.tunnelGetWakeStats).toHaveBeenCalledWith(7);
+  });
+
+  test("reports no rate when no time has passed", () => {
+    expect(tunnel.getWakeStats()!.wakeupsPerSecond).toBe(0);
+  });
+
+  test("returns null for a tunnel that was never resumed", () => {
+    addon.tunnelGetWakeStats.mockReturnValue(null);
+    expect(tunnel.getWakeStats()).toBeNull();
+  });
+
+  test("returns null when the addon keeps no stats", () => {
+    const bare: Partial<ReturnType<typeof createMockAddon>> = { ...addon };
+    delete bare.tunnelGetWakeStats;
+    expect(new Tunnel(bare as any, 1, new TunnelConfiguration({})).getWakeStats()).toBeNull();
+  });
+});
+
+describe("Tunnel resume timeout", () => {
+  let addon: ReturnType<typeof createMockAddon>;
+  let tunnel: Tunnel;
+
+  beforeEach(() => {
+    addon = createMockAddon();
+    tunnel = new Tunnel(addon as any, 1, new TunnelConfiguration({}));
+  });
+
+  test("lets the addon back an idle tunnel off between 100 ms and 1 s", () => {
+    addon.tunnelNextResumeTimeout.mockReturnValue(400);
+    expect((tunnel as any).nextPollTimeout()).toBe(400);
+    expect(addon.tunnelNextResumeTimeout).toHaveBeenCalledWith(7, 100, 1000);
+  });
+
+  test("stays at the minimum while connections are live", () => {
+    (tunnel as any)._latestUsage.updateFromArray(new Float64Array([5, 2, 2, 0, 0, 0]));
+    expect((tunnel as any).nextPollTimeout()).toBe(100);
+    expect(addon.tunnelNextResumeTimeout).not.toHaveBeenCalled();
+  });
+});
@@ -1,8 +1,62 @@
 import { Logger } from "../utils/logger.js";
-import { PinggyNative, Config as IConfig } from "../types.js";
-import { TunnelConfiguration, TunnelConfigurationV1 } from "../tunnelConfiguration.js";
+import { PinggyNative, Config as IConfig, NativeConfigOptions, NativeConfigSnapshot } from "../types.js";
+import { BasicAuthItem, ConfigUpdate, HeaderModification, TunnelConfiguration, TunnelConfigurationV1 } from "../tunnelConfiguration.js";
 import { PinggyError } from "./exception.js";
 
+/** Index of each key in an addon's configFieldKeys, built once per addon. */
+const fieldIndexCache = new WeakMap<readonly string[], Map<string, number>>();
+
+function configFieldIndex(keys: readonly string[]): Map<string, number> {
+  let index = fieldIndexCache.get(keys);
+  if (!index) {
+    index = new Map(keys.map((key, i) => [key, i]));
+    fieldIndexCache.set(keys, index);
+  }
+  return index;
+}
+
+/** Parses a list field read as JSON text; null if it is unset or unreadable. */
+function parseJsonList<T>(raw: string | null, label: string): T[] | null {
+  if (!raw) return null;
+  try {
+    const parsed = JSON.parse(raw);
+    return Array.isArray(parsed) ? parsed : [];
+  } catch (e) {
+    Logger.error(`Error parsing ${label} configuration:`, e as Error);
+    return null;
+  }
+}
+
+/**
+ * Every field of a native config, in the shapes the individual getters of
+ * {@link Config} return. See {@link Config.getSnapshot}.
+ * @internal
+ */
+export type ConfigSnapshot = {
+  serverAddress: string | null;
+  sniServerName: string | null;
+  token: string | null;
+  argument: string | null;
+  /** Forwarding rules as JSON text. */
+  forwarding: string | null;
+  localServerTls: string | null;
+  webdebuggerAddr: string | null;
+  ipWhiteList: string[];
+  basicAuth: BasicAuthItem[] | null;
+  bearerTokenAuth: string[];
+  headerModification: HeaderModification[] | null;
+  force: boolean | null;
+  ssl: boolean | null;
+  httpsOnly: boolean | null;
+  allowPreflight: boolean | null;
+  xForwardedFor: boolean | null;
+  reverseProxy: boolean | null;
+  originalRequestUrl: boolean | null;
+  autoReconnect: boolean | null;
+  reconnectInterval: number | null;
+  maxReconnectAttempts: number | null;
+};
+
 /**
  * Represents the configuration for a Pinggy tunnel.
  * Handles setting up and managing tunnel options and arguments for the native addon.
@@ -15,6 +69,8 @@ export class Config implements IConfig {
   public configRef: number;
   /** Native addon instance. */
   private addon: PinggyNative;
+  /** Keeps the native config alive; it is freed once this object is collected. */
+  private owner: object | null = null;
 
   /**
    * Creates a new Config instance and initializes it with the provided options.
@@ -23,7 +79,29 @@ export class Config implements IConfig {
    */
   constructor(addon: PinggyNative, options: TunnelConfigurationV1) {
     this.addon = addon;
-    this.configRef = this.initialize(new TunnelConfiguration(options));
+    const config = new TunnelConfiguration(options);
+    const templateRef = config.optional?.configTemplate;
+    this.configRef =
+      templateRef && typeof addon.configClone === "function"
+        ? this.initializeFromTemplate(templateRef, config)
+        : this.initialize(config);
+  }
+
+  /**
+   * Native forwarding value for the options: the rules as JSON text, or the
+   * single simplified rule.
+   * @throws {Error} If the options have no forwarding.
+   */
+  private static nativeForwardings(options: TunnelConfiguration): string {
+    const forwardingFormat = options.getForwardingKind();
+    if (forwardingFormat === "array") {
+      return options.getForwardingObjects() as string;
+    } else if (forwardingFormat === "string") {
+      // A single simplified rule; set_forwardings reads it like add_forwarding_simple.
+      return options.getForwardingPrimary() || "localhost:80";
+    }
+    Logger.error("Forwarding configuration missing after validation.");
+    throw new Error("Forwarding configuration missing.");
   }
 
   /**
@@ -36,6 +114,9 @@ export class Config implements IConfig {
     try {
       const configRef = this.addon.createConfig();
       Logger.info(`Created config with reference: ${configRef}`);
+      if (configRef && typeof this.addon.refOwner === "function") {
+        this.owner = this.addon.refOwner(configRef);
+      }
 
       if (!configRef) {
         const lastEx = this.addon.getLastException();
@@ -50,299 +131,43 @@ export class Config implements IConfig {
         }
       }
 
-      // Handle validation errors
+      // Handle validation errors; an addon that compiles the whitelist checks its entries itself
       try {
-        options.validate();
+        options.validate(typeof this.addon.ipWhiteListCompile !== "function");
       } catch (validationError) {
         throw validationError instanceof PinggyError ? validationError : new Error(String(validationError));
       }
 
-      if (options.token) {
-        try {
-          this.addon.configSetToken(configRef, options.token);
-          Logger.info("Token set successfully");
-        } catch (e) {
-          const lastEx = this.addon.getLastException();
-          if (lastEx) {
-            const pinggyError = new PinggyError(lastEx);
-            Logger.error("Error setting token:", pinggyError);
-            throw pinggyError;
-          } else {
-            Logger.error("Error setting token:", e instanceof Error ? e : new Error(String(e)));
-            throw e;
-          }
-        }
-      }
+      // Configure forwarding
+      const forwardings = Config.nativeForwardings(options);
 
       // Apply user-defined values or set defaults
-      const serverAddress = options.serverAddress || "a.pinggy.io:443";
-      const sniServerName = options.getSniServerName();
-      const ssl = options.getSsl() ?? true; // Default to true if not specified
-
-      // Set argument if provided
-      if (options.getAdditionalArguments()?.trim()) {
-        const argument = options.getAdditionalArguments()!.trim();
-        Logger.info(`Setting config argument: ${argument}`);
-        this.addon.configSetArgument(configRef, argument);
-      }
-
-      this.safeSet(
-        ()=>{
-           this.addon.configSetServerAddress(configRef, serverAddress);
-        },
-        "Server address configuration",
-        `Server address set to: ${serverAddress}`
-      )
-     
-
-      this.safeSet(
-        () => {
-          if (sniServerName) {
-            this.addon.configSetSniServerName(configRef, sniServerName);
-          }
-        },
-        "SNI server name configuration",
-        sniServerName ? `SNI server name set to: ${sniServerName}` : undefined
-      );
-
-      this.safeSet(
-        () => {
-          if(options.webDebugger){
-            this.addon.configSetWebdebuggerAddr(configRef, options.webDebugger);
-            this.addon.configSetWebdebugger(configRef, true);
-          }
-        },
-        "Web Debugger configuration",
-        options.webDebugger ? `Web Debugger address set to: ${options.webDebugger}` : undefined
-      )
-
-      this.safeSet(
-        () => {
-          if (options.httpsOnly !== undefined) {
-            this.addon.configSetHttpsOnly(configRef, options.httpsOnly as boolean);
-          }
-        },
-        "HTTPS-only configuration",
-        options.httpsOnly !== undefined ? `HTTPS-only configuration set to: ${options.httpsOnly}` : undefined
-      );
-
-      // set allow preflight
-      this.safeSet(
-        () => {
-          if (options.allowPreflight !== undefined) {
-            this.addon.configSetAllowPreflight(configRef, options.allowPreflight as boolean);
-          }
-        },
-        "Allow-Preflight configuration",
-        options.allowPreflight !== undefined ? `Allow-Preflight configuration set to: ${options.allowPreflight}` : undefined
-      );
-
-      // set xff
-      this.safeSet(
-        () => {
-          if (options.xForwardedFor !== undefined) {
-            this.addon.configSetXForwardedFor(configRef, options.xForwardedFor as boolean);
-          }
-        },
-        "X-Forwarded-For configuration",
-        options.xForwardedFor !== undefined ? `X-Forwarded-For configuration set to: ${options.xForwardedFor}` : undefined
-      );
-
-      // set original request url
-      this.safeSet(
-        () => {
-          if (options.originalRequestUrl !== undefined) {
-            this.addon.configSetOriginalRequestUrl(configRef, options.originalRequestUrl as boolean);
-          }
-        },
-        "Original-Request-URL configuration",
-        options.originalRequestUrl !== undefined ? `Original-Request-URL configuration set to: ${options.originalRequestUrl}` : undefined
-      );
-
-      // set no reverse proxy
-      this.safeSet(
-        () => {
-          if (options.reverseProxy !== undefined) {
-            this.addon.configSetReverseProxy(configRef, options.reverseProxy as boolean);
-          }
-        },
-        "No-Reverse-Proxy configuration",
-        options.reverseProxy !== undefined ? `No-Reverse-Proxy configuration set to: ${options.reverseProxy}` : undefined
-      );
-
-      // Set IP whitelist if provided
-      this.safeSet(
-        () => {
-          if (options.ipWhitelist && options.ipWhitelist.length > 0) {
-            const ipWhitelist = JSON.stringify(options.ipWhitelist);
-            this.addon.configSetIpWhiteList(configRef, ipWhitelist);
-          }
-        },
-        "IP whitelist configuration",
-        options.ipWhitelist && options.ipWhitelist.length > 0
-          ? `IP whitelist set to: ${JSON.stringify(options.ipWhitelist)}`
-          : undefined
-      );
-
-      // Set basic auth if provided (array of {username,password})
-      this.safeSet(
-        () => {
-          if (options.basicAuth && options.basicAuth.length > 0) {
-            this.addon.configSetBasicAuths(configRef, JSON.stringify(options.basicAuth));
-          }
-        },
-        "Basic auth configuration",
-        options.basicAuth && options.basicAuth.length > 0
-          ? `Basic auth set to: ${JSON.stringify(options.basicAuth)}`
-          : undefined
-      );
-
-      // Set bearer token if provided
-      this.safeSet(
-        () => {
-          if (options.bearerTokenAuth && options.bearerTokenAuth?.length > 0) {
-            this.addon.configSetBearerTokenAuths(configRef, JSON.stringify(options.bearerTokenAuth));
-          }
-        },
-        "Bearer auth configuration",
-        options.bearerTokenAuth && options.bearerTokenAuth?.length > 0
-          ? `Bearer auth set to: ${JSON.stringify(options.bearerTokenAuth)}`
-          : undefined
-      );
-
-      // Set header modifications if provided
-      this.safeSet(
-        () => {
-          if (options.headerModification && options.headerModification?.length > 0) {
-            this.addon.configSetHeaderModification(configRef, JSON.stringify(options.headerModification));
-          }
-        },
-        "Header modification configuration",
-        options.headerModification && options.headerModification?.length > 0
-          ? `Header modification set to: ${JSON.stringify(options.headerModification)}`
-          : undefined
-      );
-
-      // Set SSL configuration
-      this.safeSet(
-        () => {
-          this.addon.configSetSSL(configRef, ssl);
-        },
-        "SSL configuration",
-        `SSL configuration set to: ${ssl}`
-      );
-
-      // Set local server TLS configuration (may be derived)
-      this.safeSet(
-        () => {
-          if (options.getLocalServerTls()) {
-            this.addon.configSetLocalServerTls(configRef, options.getLocalServerTls() as string);
-          }
-        },
-        "Local server TLS configuration",
-        options.getLocalServerTls()
-          ? `Local server TLS configuration set to: ${options.getLocalServerTls()}`
-          : undefined
-      );
-
-      // Set auto-reconnect options
-      this.safeSet(
-        () => {
-          if (options.autoReconnect !== undefined) {
-            this.addon.configSetAutoReconnect(configRef, options.autoReconnect as boolean);
-          }
-        },
-        "Auto-reconnect configuration",
-        options.autoReconnect !== undefined
-          ? `Auto-reconnect set to: ${options.autoReconnect}`
-          : undefined
-      );
-
-      // Set reconnect interval if provided
-      this.safeSet(
-        () => {
-          if (options.reconnectInterval !== undefined) {
-            this.addon.configSetReconnectInterval(configRef, options.reconnectInterval as number);
-          }
-        },
-        "Reconnect interval configuration",
-        options.reconnectInterval !== undefined
-          ? `Reconnect interval set to: ${options.reconnectInterval}`
-          : undefined
-      );
-
-      // Set max reconnect attempts if provided
-      this.safeSet(
-        () => {
-          if (options.maxReconnectAttempts !== undefined) {
-            this.addon.configSetMaxReconnectAttempts(configRef, options.maxReconnectAttempts as number);
-          }
-        },
-        "Max reconnect attempts configuration",
-        options.maxReconnectAttempts !== undefined
-          ? `Max reconnect attempts set to: ${options.maxReconnectAttempts}`
-          : undefined
-      );
-
-      // Set force configuration if provided
-      if (options.force !== undefined) {
-        try {
-          this.addon.configSetForce(configRef, options.force);
-          Logger.info(`Force configuration set to: ${options.force}`);
-        } catch (e) {
-          const lastEx = this.addon.getLastException();
-          if (lastEx) {
-            const pinggyError = new PinggyError(lastEx);
-            Logger.error("Error setting force configuration:", pinggyError);
-            throw pinggyError;
-          } else {
-            if (e instanceof Error) {
-              Logger.error("Error setting force configuration:", e);
-            } else {
-              Logger.error(
-                "Error setting force configuration:",
-                new Error(String(e))
-              );
-            }
-            throw e;
-          }
-        }
-      }
-
-      // Configure forwarding 
-      try {
-        const forwardingFormat = options.getForwardingKind();
-        let forwardTo = options.getForwardingPrimary() || "localhost:80";
-        if (forwardingFormat === "array" && options.getForwardingObjects) {
-          const forwardingData = options.getForwardingObjects();
-          if (forwardingData !== null) {
-            this.addon.configSetForwardings(configRef, forwardingData);
-            Logger.info(`Configured forwardings (array): ${JSON.stringify(forwardingData)}`);
-          }
-
-        } else if (forwardingFormat === "string") {
-          this.addon.configAddForwardingSimple(configRef, forwardTo);
-          Logger.info(`Configured forwarding (string): ${forwardTo}`);
-
-        } else {
-          Logger.error("Forwarding configuration missing after validation.");
-          throw new Error("Forwarding configuration missing.");
-        }
-      } catch (e) {
-        const lastEx = this.addon.getLastException();
-        if (lastEx) {
-          const pinggyError = new PinggyError(lastEx);
-          Logger.error("Error setting forwarding:", pinggyError);
-          throw pinggyError;
-        } else {
-          if (e instanceof Error) {
-            Logger.error("Error setting forwarding:", e);
-          } else {
-            Logger.error("Error setting forwarding:", new Error(String(e)));
-          }
-          throw e;
-        }
-      }
+      const argument = options.getAdditionalArguments()?.trim();
+      const fields: NativeConfigOptions = {
+        token: options.token || undefined,
+        argument: argument || undefined,
+        serverAddress: options.serverAddress || "a.pinggy.io:443",
+        sniServerName: options.getSniServerName() || undefined,
+        webdebuggerAddr: options.webDebugger || undefined,
+        webdebugger: options.webDebugger ? true : undefined,
+        httpsOnly: options.httpsOnly,
+        allowPreflight: options.allowPreflight,
+        xForwardedFor: options.xForwardedFor,
+        originalRequestUrl: options.originalRequestUrl,
+        reverseProxy: options.reverseProxy,
+        ipWhiteList: options.ipWhitelist?.length ? this.compileIpWhiteList(options.ipWhitelist) : undefined,
+        basicAuths: options.basicAuth?.length ? options.basicAuth : undefined,
+        bearerTokenAuths: options.bearerTokenAuth?.length ? options.bearerTokenAuth : undefined,
+        headerModification: options.headerModification?.length ? options.headerModification : undefined,
+        ssl: options.getSsl() ?? true, // Default to true if not specified
+        localServerTls: options.getLocalServerTls() || undefined,
+        autoReconnect: options.autoReconnect,
+        reconnectInterval: options.reconnectInterval,
+        maxReconnectAttempts: options.maxReconnectAttempts,
+        force: options.force,
+        forwardings,
+      };
+      this.applyFields(configRef, fields);
 
       Logger.info("Configurations applied successfully.");
       return configRef;
@@ -352,30 +177,211 @@ export class Config implements IConfig {
   }
 
   /**
-   * Run a setter action with uniform error handling .
-   * @param action - zero-arg function that performs the native call
-   * @param label - label used in logs/errors
-   * @param successMsg - optional success log message
+   * Clones the native config of a config template and sets only the
+   * fields a derived config may change. The options were validated when
+   * they were derived.
+   * @private
+   * @param {number} templateRef - The template's native config.
+   * @param {TunnelConfiguration} options - The derived tunnel configuration options.
+   * @returns {number} The reference to the new native config object.
    */
-  private safeSet(action: () => void, label: string, successMsg?: string): void {
-    // Call the native action (it won't throw)
-    action();
-
-    // Always check addon’s last exception after the call
+  private initializeFromTemplate(templateRef: number, options: TunnelConfiguration): number {
+    const configRef = this.addon.configClone(templateRef);
+    if (typeof this.addon.refOwner === "function") {
+      this.owner = this.addon.refOwner(configRef);
+    }
     const lastEx = this.addon.getLastException();
-    if (
-      lastEx !== null &&
-      lastEx !== undefined &&
-      !(typeof lastEx === "string" && lastEx.trim().length === 0)
-    ) {
-      const pinggyError = new PinggyError(lastEx as any);
-      Logger.error(`Error setting ${label}:`, pinggyError);
+    if (lastEx) {
+      const pinggyError = new PinggyError(lastEx);
+      Logger.error("Failed to clone config template:", pinggyError);
       throw pinggyError;
     }
+    Logger.info(`Cloned config ${configRef} from template ${templateRef}`);
+
+    this.applyFields(configRef, {
+      token: options.token || undefined,
+      // "" clears a TLS name the template's forwarding implied.
+      localServerTls: options.getLocalServerTls() ?? "",
+      forwardings: Config.nativeForwardings(options),
+    });
+    return configRef;
+  }
+
+  /**
+   * The IP whitelist as configApply takes it: compiled by the addon into the
+   * smallest list of prefixes covering the same addresses when it can, the
+   * entries as given otherwise.
+   * @param {string[]} entries - IP addresses and CIDR prefixes.
+   * @returns {string | string[]} The compiled list as JSON text, or the entries.
+   * @throws {PinggyError} If an entry is not an IP address or CIDR prefix.
+   */
+  private compileIpWhiteList(entries: string[]): string | string[] {
+    if (typeof this.addon.ipWhiteListCompile !== "function") return entries;
+    try {
+      return this.addon.ipWhiteListCompile(entries.join(","), entries.length);
+    } catch (e) {
+      const index = entries.findIndex((entry) => entry.includes(","));
+      const message = index >= 0 ? `Invalid IP address at index ${index}: ${entries[index]}` : (e as Error).message;
+      throw new PinggyError(`Validation failed:\n- ${message}`);
+    }
+  }
 
-    if (successMsg) {
-      Logger.info(successMsg);
+  /**
+   * Sets the given fields on the native config, with a single configApply
+   * call when the addon has it.
+   * @param configRef - reference to the native config
+   * @param fields - fields to set; undefined ones are left alone
+   */
+  private applyFields(configRef: number, fields: NativeConfigOptions): void {
+    const toNative = (value: unknown) =>
+      value !== null && typeof value === "object" ? JSON.stringify(value) : value;
+    let failed: string | undefined;
+    let lastEx: string | null = null;
+    if (typeof this.addon.configApply === "function" && this.addon.configFieldKeys) {
+      // Fields go by index, so the addon never has to look a property up by name.
+      const index = configFieldIndex(this.addon.configFieldKeys);
+      const args: unknown[] = [];
+      for (const key in fields) {
+        const value = fields[key as keyof NativeConfigOptions];
+        if (value === undefined || value === null) continue;
+        const position = index.get(key);
+        if (position === undefined) throw new Error(`Unknown config field: ${key}`);
+        args.push(position, toNative(value));
+      }
+      failed = this.addon.configApply(configRef, ...args);
+      if (failed !== undefined) lastEx = this.addon.getLastException();
+    } else {
+      // Addons built before configApply: one setter call per field.
+      for (const [key, value] of Object.entries(fields)) {
+        if (value === undefined || value === null) continue;
+        const setter = key === "ssl" ? "configSetSSL" : `configSet${key[0].toUpperCase()}${key.slice(1)}`;
+        (this.addon as any)[setter](configRef, toNative(value));
+        lastEx = this.addon.getLastException();
+        if (lastEx !== null) {
+          failed = key;
+          break;
+        }
+      }
+    }
+
+    if (failed !== undefined) {
+      const pinggyError = lastEx ? new PinggyError(lastEx) : new Error(`Failed to set ${failed}`);
+      Logger.error(`Error setting ${failed} configuration:`, pinggyError);
+      throw pinggyError;
+    }
+    for (const [key, value] of Object.entries(fields)) {
+      if (value !== undefined && value !== null && key !== "token") {
+        Logger.info(`${key} set to: ${typeof value === "object" ? JSON.stringify(value) : value}`);
+      }
+    }
+  }
+
+  /**
+   * Reads every field of the config at once: with a single addon call when
+   * the addon has configSnapshot, one getter per field otherwise.
+   * @returns {ConfigSnapshot} The fields; those that cannot be read are null (lists empty).
+   */
+  public getSnapshot(): ConfigSnapshot {
+    let raw: NativeConfigSnapshot | null = null;
+    if (this.configRef && typeof this.addon.configSnapshot === "function") {
+      try {
+        raw = this.addon.configSnapshot(this.configRef);
+      } catch (e) {
+        Logger.error("Error reading config snapshot:", e as Error);
+      }
+    }
+
+    if (!raw) {
+      return {
+        serverAddress: this.getServerAddress(),
+        sniServerName: this.getSniServerName(),
+        token: this.getToken(),
+        argument: this.getArgument(),
+        forwarding: this.getForwarding(),
+        localServerTls: this.getLocalServerTls(),
+        webdebuggerAddr: this.getWebdebuggerAddr(),
+        ipWhiteList: this.getIpWhiteList(),
+        basicAuth: this.getBasicAuth() as unknown as BasicAuthItem[] | null,
+        bearerTokenAuth: this.getBearerTokenAuth(),
+        headerModification: this.getHeaderModification() as unknown as HeaderModification[] | null,
+        force: this.getForce(),
+        ssl: this.getTunnelSsl(),
+        httpsOnly: this.getHttpsOnly(),
+        allowPreflight: this.getAllowPreflight(),
+        xForwardedFor: this.getXForwardedFor(),
+        reverseProxy: this.getNoReverseProxy(),
+        originalRequestUrl: this.getOriginalRequestUrl(),
+        autoReconnect: this.getAutoReconnect(),
+        reconnectInterval: this.getReconnectInterval(),
+        maxReconnectAttempts: this.getMaxReconnectAttempts(),
+      };
+    }
+
+    return {
+      serverAddress: raw.serverAddress,
+      sniServerName: raw.sniServerName,
+      token: raw.token,
+      argument: raw.argument,
+      forwarding: raw.forwardings,
+      localServerTls: raw.localServerTls,
+      webdebuggerAddr: raw.webdebuggerAddr,
+      ipWhiteList: parseJsonList<string>(raw.ipWhiteList, "IP whitelist") ?? [],
+      basicAuth: parseJsonList<BasicAuthItem>(raw.basicAuths, "Basic Auth"),
+      bearerTokenAuth: parseJsonList<string>(raw.bearerTokenAuths, "Bearer Token Auth") ?? [],
+      headerModification: parseJsonList<HeaderModification>(raw.headerModification, "Header Modification"),
+      force: raw.force,
+      ssl: raw.ssl,
+      httpsOnly: raw.httpsOnly,
+      allowPreflight: raw.allowPreflight,
+      xForwardedFor: raw.xForwardedFor,
+      reverseProxy: raw.reverseProxy,
+      originalRequestUrl: raw.originalRequestUrl,
+      autoReconnect: raw.autoReconnect,
+      reconnectInterval: raw.reconnectInterval,
+      maxReconnectAttempts: raw.maxReconnectAttempts,
+    };
+  }
+
+  /**
+   * Sets the given options on the native config, skipping those that already
+   * hold the same value, with a single addon call for the rest.
+   * @param {ConfigUpdate} update - The options to change; undefined ones are left alone.
+   * @returns {(keyof ConfigUpdate)[]} The options that changed.
+   * @throws {PinggyError} If an option is invalid or libpinggy rejects it.
+   */
+  public update(update: ConfigUpdate): (keyof ConfigUpdate)[] {
+    new TunnelConfiguration(update).validate(typeof this.addon.ipWhiteListCompile !== "function");
+    const current = this.getSnapshot();
+    const options: [keyof ConfigUpdate, keyof NativeConfigOptions, unknown][] = [
+      ["ipWhitelist", "ipWhiteList", current.ipWhiteList],
+      ["basicAuth", "basicAuths", current.basicAuth ?? []],
+      ["bearerTokenAuth", "bearerTokenAuths", current.bearerTokenAuth],
+      ["headerModification", "headerModification", current.headerModification ?? []],
+      ["xForwardedFor", "xForwardedFor", current.xForwardedFor],
+      ["httpsOnly", "httpsOnly", current.httpsOnly],
+      ["originalRequestUrl", "originalRequestUrl", current.originalRequestUrl],
+      ["allowPreflight", "allowPreflight", current.allowPreflight],
+      ["reverseProxy", "reverseProxy", current.reverseProxy],
+    ];
+
+    const fields: NativeConfigOptions = {};
+    const changed: (keyof ConfigUpdate)[] = [];
+    for (const [option, field, value] of options) {
+      let next: unknown = update[option];
+      if (next === undefined) continue;
+      if (option === "ipWhitelist") {
+        // Compiled first, so it compares equal to the compiled list libpinggy holds.
+        next = this.compileIpWhiteList(next as string[]);
+      }
+      // Compared as JSON, which also covers the lists read back from libpinggy.
+      if ((typeof next === "string" ? next : JSON.stringify(next)) === JSON.stringify(value)) continue;
+      (fields as Record<string, unknown>)[field] = next;
+      changed.push(option);
+    }
+    if (changed.length > 0) {
+      this.applyFields(this.configRef, fields);
     }
+    return changed;
   }
 
   /**
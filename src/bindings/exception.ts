@@ -1,4 +1,4 @@
-import { PinggyNative } from "../types.js";
+import { NativeExceptionRecord, PinggyNative } from "../types.js";
 
 /**
  * Custom error class for Pinggy-related errors.
@@ -14,13 +14,20 @@ export class PinggyError extends Error {
   }
 }
 
+// libpinggy keeps a single exception handler per process; install it once
+// per loaded addon rather than once per tunnel or template.
+const exceptionHandlingAddons = new WeakSet<PinggyNative>();
+
 /**
  * Initializes exception handling for the Pinggy native addon.
+ * Calls after the first for the same addon do nothing.
  * @param {PinggyNative} addon - The native addon instance.
  * @returns {void}
  */
 export function initExceptionHandling(addon: PinggyNative): void {
+  if (exceptionHandlingAddons.has(addon)) return;
   addon.initExceptionHandling();
+  exceptionHandlingAddons.add(addon);
 }
 
 /**
@@ -37,3 +44,16 @@ export function getLastException(addon: PinggyNative): string {
   }
   return exception;
 }
+
+/**
+ * Retrieves the recent exceptions recorded by the Pinggy native addon.
+ * @param {PinggyNative} addon - The native addon instance.
+ * @param {number} [afterSequence] - Only return exceptions recorded after this sequence number.
+ * @returns {NativeExceptionRecord[]} The exceptions, oldest first; empty if the addon does not keep a history.
+ */
+export function getExceptionHistory(addon: PinggyNative, afterSequence?: number): NativeExceptionRecord[] {
+  if (typeof addon.getExceptionHistory !== "function") {
+    return [];
+  }
+  return addon.getExceptionHistory(afterSequence);
+}
@@ -1,6 +1,9 @@
 import { TunnelUsageType } from "../types.js";
 
 export class TunnelUsage implements TunnelUsageType {
+  /** Number of counters in a native usage view, see {@link updateFromArray}. */
+  static readonly FIELD_COUNT = 6;
+
   elapsedTime: number;
   numLiveConnections: number;
   numTotalConnections: number;
@@ -26,4 +29,17 @@ export class TunnelUsage implements TunnelUsageType {
       }
     }
   }
+
+  /**
+   * Copy the counters out of a usage view filled by the native addon,
+   * laid out in the order of the fields above.
+   */
+  updateFromArray(values: Float64Array) {
+    this.elapsedTime = values[0];
+    this.numLiveConnections = values[1];
+    this.numTotalConnections = values[2];
+    this.numTotalReqBytes = values[3];
+    this.numTotalResBytes = values[4];
+    this.numTotalTxBytes = values[5];
+  }
 }
@@ -4,6 +4,8 @@ import {
   Tunnel as ITunnel,
   TunnelStatus,
   TunnelUsageType,
+  TunnelWakeStats,
+  NativeEventType,
   tunnelStateToString,
   TunnelState,
   tunnelStateToStatus,
@@ -13,6 +15,14 @@ import { TunnelUsage } from "./tunnel-usage.js";
 import { TunnelConfiguration } from "../tunnelConfiguration.js";
 import { AdditionalForwardingManager } from "../utils/additionalForwardingManager.js";
 
+/** Resume timeout while the tunnel is busy. */
+const POLL_TIMEOUT_MIN_MS = 100;
+/**
+ * Upper bound for an idle tunnel's resume timeout. Pending RPCs end the resume
+ * early through `tunnelWakeup` or the worker's wake flag.
+ */
+const POLL_TIMEOUT_MAX_MS = 1000;
+
 type Task = () => void;
 class FunctionQueue {
   private queue: Task[] = [];
@@ -45,6 +55,11 @@ interface TunnelOperationConfig<T> {
   skipInitCheck?: boolean;
 }
 
+interface TunnelAsyncOperationConfig<T>
+  extends Omit<TunnelOperationConfig<T>, "operation"> {
+  operation: () => Promise<T>;
+}
+
 /**
  * Represents a Pinggy tunnel instance, managing its lifecycle and forwarding.
  * Handles authentication, forwarding, and additional tunnel operations via the native addon.
@@ -61,11 +76,15 @@ export class Tunnel implements ITunnel {
   /** Whether primary forwarding is complete. */
   public primaryForwardingDone: boolean;
 
-  /** Current status of the tunnel. */
-  public status: TunnelStatus;
+  private _status: TunnelStatus = TunnelStatus.IDLE;
 
   private readonly addon: PinggyNative;
   private readonly pinggyOptions: TunnelConfiguration;
+  /** Keeps the native tunnel alive; it is freed once this object is collected. */
+  private owner: object | null = null;
+  /** Native exception generation counter; undefined until first needed. */
+  private exceptionGeneration: Int32Array | null | undefined = undefined;
+  private seenExceptionGeneration = 0;
 
   private tunnelEstablished: Promise<void>;
   private resolveTunnelEstablished: (() => void) | null = null;
@@ -74,9 +93,13 @@ export class Tunnel implements ITunnel {
     new AdditionalForwardingManager();
   private _urls: string[] = [];
   private intentionallyStopped: boolean = false; // Track intentional stops
+  /** Set once start() leaves its outcome to the native start promise. */
+  private nativeStart: boolean = false;
   private functionQueue: FunctionQueue;
   private _latestUsage: TunnelUsage = new TunnelUsage();
+  private _usageView: Float64Array | null = null;
   private webDebuggerPort: number = 0;
+  private lastWakeStats: TunnelWakeStats | null = null;
 
   // user provided callbacks
   private onUsageUpdateCallback: ((usage: TunnelUsage) => void) | null = null;
@@ -109,6 +132,7 @@ export class Tunnel implements ITunnel {
     null;
   private onPollingErrorCallback: ((error: Error) => void) | null = null;
   private onCleanupCompleteCallback: (() => void) | null = null;
+  private onStatusChangeCallback: ((status: TunnelStatus) => void) | null = null;
 
   /**
    * Creates a new Tunnel instance and initializes it with the provided config reference.
@@ -133,6 +157,8 @@ export class Tunnel implements ITunnel {
       this.resolveTunnelEstablished = resolve;
       this.rejectTunnelEstablished = reject;
     });
+    // start() may report a failure without awaiting this promise.
+    this.tunnelEstablished.catch(() => {});
   }
 
   private resolveTunnelStart(): void {
@@ -160,7 +186,7 @@ export class Tunnel implements ITunnel {
     const result = config.operation();
 
     // Always check addon’s last exception after the call
-    const lastEx = this.addon.getLastException();
+    const lastEx = this.takeLastException();
     if (
       lastEx !== null &&
       lastEx !== undefined &&
@@ -181,6 +207,64 @@ export class Tunnel implements ITunnel {
     return result;
   }
 
+  // Async counterpart of executeAddonOperation: exceptions raised while the
+  // operation was in flight are only visible once its promise settles.
+  private async executeAddonOperationAsync<T>(
+    config: TunnelAsyncOperationConfig<T>,
+  ): Promise<T> {
+    if (!config.skipInitCheck) {
+      this.ensureTunnelInitialized();
+    }
+
+    let result: T;
+    try {
+      result = await config.operation();
+    } catch (e: any) {
+      const lastEx = this.takeLastException();
+      const error = lastEx
+        ? new PinggyError(lastEx)
+        : e?.code === "ERR_PINGGY_EXCEPTION"
+          ? new PinggyError(e.message)
+          : e;
+      Logger.error(`Error ${config.operationName}:`, error);
+      throw error;
+    }
+
+    const lastEx = this.takeLastException();
+    if (lastEx) {
+      const pinggyError = new PinggyError(lastEx);
+      Logger.error(`Error ${config.operationName}:`, pinggyError);
+      throw pinggyError;
+    }
+
+    if (config.successMessage) {
+      Logger.info(config.successMessage);
+    }
+
+    if (config.logResult) {
+      config.logResult(result);
+    }
+    return result;
+  }
+
+  // Skips the native call while the exception generation has not moved.
+  private takeLastException(): string | null {
+    if (this.exceptionGeneration === undefined) {
+      this.exceptionGeneration =
+        typeof this.addon.getExceptionGenerationView === "function"
+          ? this.addon.getExceptionGenerationView()
+          : null;
+    }
+    if (this.exceptionGeneration) {
+      const generation = Atomics.load(this.exceptionGeneration, 0);
+      if (generation === this.seenExceptionGeneration) {
+        return null;
+      }
+      this.seenExceptionGeneration = generation;
+    }
+    return this.addon.getLastException(this.tunnelRef || undefined);
+  }
+
   private initialize(configRef: number): number {
     const value = this.executeAddonOperation<number>({
       operationName: "tunnelInitiate",
@@ -190,6 +274,9 @@ export class Tunnel implements ITunnel {
         Logger.info(`Tunnel initiated with reference: ${tunnelRef}`),
       skipInitCheck: true,
     });
+    if (value && typeof this.addon.refOwner === "function") {
+      this.owner = this.addon.refOwner(value);
+    }
     return value;
   }
 
@@ -200,9 +287,16 @@ export class Tunnel implements ITunnel {
   }
 
   private setupCallbacks(): void {
+    // Let the addon parse usage updates into a view instead of handing us JSON.
+    if (typeof this.addon.tunnelSetUsageView === "function") {
+      this._usageView = new Float64Array(TunnelUsage.FIELD_COUNT);
+      this.addon.tunnelSetUsageView(this.tunnelRef, this._usageView);
+    }
+
     const callbackConfigs = [
       {
         setter: "tunnelSetAdditionalForwardingSucceededCallback",
+        event: NativeEventType.AdditionalForwardingSucceeded,
         callback: (
           tunnelRef: number,
           bindAddr: string,
@@ -231,6 +325,7 @@ export class Tunnel implements ITunnel {
       },
       {
         setter: "tunnelSetAdditionalForwardingFailedCallback",
+        event: NativeEventType.AdditionalForwardingFailed,
         callback: (
           tunnelRef: number,
           bindAddress: string,
@@ -266,6 +361,7 @@ export class Tunnel implements ITunnel {
       },
       {
         setter: "tunnelSetOnDisconnectedCallback",
+        event: NativeEventType.Disconnected,
         callback: (tunnelRef: number, error: string, messages: string[]) => {
           Logger.info(`Tunnel disconnected: error: ${error}`);
           // Clear any pending additional forwarding promises since tunnel is disconnected
@@ -277,7 +373,7 @@ export class Tunnel implements ITunnel {
             // ignore
           }
           // Always reject if the tunnel was not yet established.
-          if (!this.primaryForwardingDone) {
+          if (!this.primaryForwardingDone && !this.nativeStart) {
             this.status = TunnelStatus.CLOSED;
             this.rejectTunnelStart(
               new PinggyError(
@@ -299,6 +395,7 @@ export class Tunnel implements ITunnel {
       },
       {
         setter: "tunnelSetOnTunnelErrorCallback",
+        event: NativeEventType.TunnelError,
         callback: (
           tunnelRef: number,
           errorNo: number,
@@ -312,11 +409,13 @@ export class Tunnel implements ITunnel {
           if (!recoverable) {
             // Fatal error — reject if not yet established, update status either way
             this.status = TunnelStatus.CLOSED;
-            this.rejectTunnelStart(
-              new PinggyError(
-                `Unrecoverable tunnel error (${errorNo}): ${error}`,
-              ),
-            );
+            if (!this.nativeStart) {
+              this.rejectTunnelStart(
+                new PinggyError(
+                  `Unrecoverable tunnel error (${errorNo}): ${error}`,
+                ),
+              );
+            }
           }
           if (this.onTunnelErrorCallback) {
             try {
@@ -329,6 +428,7 @@ export class Tunnel implements ITunnel {
       },
       {
         setter: "tunnelSetEstablishedCallback",
+        event: NativeEventType.TunnelEstablished,
         callback: (tunnelRef: number, urls: string[]) => {
           if (!this.resolveTunnelEstablished && !this.rejectTunnelEstablished) {
             // Promise already settled; this is a reconnect fire — handle via reconnect callback.
@@ -337,31 +437,37 @@ export class Tunnel implements ITunnel {
             return;
           }
           Logger.info(`Tunnel established: ${tunnelRef}, ${urls.join(", ")}`);
-          this.primaryForwardingDone = true;
           this._urls = urls;
-          this.status = TunnelStatus.LIVE;
-
-          this.resolveTunnelStart();
+          if (!this.nativeStart) {
+            this.primaryForwardingDone = true;
+            this.status = TunnelStatus.LIVE;
+            this.resolveTunnelStart();
+          }
           this.onTunnelEstablishedCallback?.("Tunnel established", urls);
         },
       },
       {
         setter: "tunnelSetOnTunnelFailedCallback",
+        event: NativeEventType.TunnelFailed,
         callback: (tunnelRef: number, errorMessage: string) => {
           this.status = TunnelStatus.CLOSED;
-          this.rejectTunnelStart(new PinggyError(errorMessage));
+          if (!this.nativeStart) {
+            this.rejectTunnelStart(new PinggyError(errorMessage));
+          }
           Logger.error(`Tunnel failed: ${tunnelRef}, error: ${errorMessage}`);
           this.onTunnelEstablishedCallback?.(`Tunnel failed: ${errorMessage}`);
         },
       },
       {
         setter: "tunnelSetOnUsageUpdateCallback",
-        callback: (tunnelRef: number, usageJson: string) => {
+        event: NativeEventType.UsageUpdate,
+        callback: (tunnelRef: number, usageJson: string | null) => {
           this.handleUsageUpdate(usageJson);
         },
       },
       {
         setter: "tunnelSetOnTunnelForwardingChangedCallback",
+        event: NativeEventType.ForwardingsChanged,
         callback: (tunnelRef: number, address?: string[]) => {
           Logger.info(`Tunnel forwarding changed:, ${address}`);
           this.onForwardingChangedCallback?.(
@@ -372,6 +478,7 @@ export class Tunnel implements ITunnel {
       },
       {
         setter: "tunnelSetOnWillReconnectCallback",
+        event: NativeEventType.WillReconnect,
         callback: (tunnelRef: number, error: string, messages: string[]) => {
           Logger.info(`Tunnel will reconnect: error: ${error}`);
           if (this.onWillReconnectCallback) {
@@ -385,6 +492,7 @@ export class Tunnel implements ITunnel {
       },
       {
         setter: "tunnelSetOnReconnectingCallback",
+        event: NativeEventType.Reconnecting,
         callback: (tunnelRef: number, retryCnt: number) => {
           Logger.info(`Tunnel reconnecting attempt: ${retryCnt}`);
           if (this.onReconnectingCallback) {
@@ -398,14 +506,17 @@ export class Tunnel implements ITunnel {
       },
       {
         setter: "tunnelSetOnReconnectionCompletedCallback",
+        event: NativeEventType.ReconnectionCompleted,
         callback: (tunnelRef: number, urls: string[]) => {
           Logger.info(`Tunnel reconnection completed: ${urls.join(", ")}`);
           this._urls = urls;
 
           if (this.resolveTunnelEstablished) {
-            this.primaryForwardingDone = true;
-            this.status = TunnelStatus.LIVE;
-            this.resolveTunnelStart();
+            if (!this.nativeStart) {
+              this.primaryForwardingDone = true;
+              this.status = TunnelStatus.LIVE;
+              this.resolveTunnelStart();
+            }
             this.onTunnelEstablishedCallback?.("Tunnel established", urls);
           }
 
@@ -423,6 +534,7 @@ export class Tunnel implements ITunnel {
       },
       {
         setter: "tunnelSetOnReconnectionFailedCallback",
+        event: NativeEventType.ReconnectionFailed,
         callback: (tunnelRef: number, retryCnt: number) => {
           Logger.error(`Tunnel reconnection failed after ${retryCnt} attempts`);
           if (this.onReconnectionFailedCallback) {
@@ -439,20 +551,43 @@ export class Tunnel implements ITunnel {
       },
     ];
 
+    // Prefer one call per resume carrying every event over one call per event.
+    if (typeof this.addon.tunnelSetEventBatchCallback === "function") {
+      const handlers: Array<(...args: any[]) => void> = [];
+      callbackConfigs.forEach(({ event, callback }) => {
+        handlers[event] = callback as (...args: any[]) => void;
+      });
+      this.addon.tunnelSetEventBatchCallback(this.tunnelRef, (_ref, events) => {
+        for (const [type, ...args] of events) {
+          try {
+            handlers[type]?.(...args);
+          } catch (cbErr) {
+            Logger.error(`Error handling native event ${type}:`, cbErr as Error);
+          }
+        }
+      });
+      return;
+    }
+
     // Set all callbacks
     callbackConfigs.forEach(({ setter, callback }) => {
       (this.addon as any)[setter](this.tunnelRef, callback);
     });
   }
 
-  private handleUsageUpdate(usageJson: string): void {
-    if (!usageJson) {
+  private handleUsageUpdate(usageJson: string | null): void {
+    if (!usageJson && !this._usageView) {
       // Debug log
       return;
     }
 
     try {
-      this._latestUsage.updateFromJSON(usageJson);
+      if (usageJson) {
+        this._latestUsage.updateFromJSON(usageJson);
+      } else {
+        // null: the addon already wrote the counters into the usage view.
+        this._latestUsage.updateFromArray(this._usageView!);
+      }
       if (this.onUsageUpdateCallback) {
         this.onUsageUpdateCallback(this._latestUsage);
       }
@@ -467,12 +602,26 @@ export class Tunnel implements ITunnel {
    * @throws {PinggyError|Error} If tunnel connection or forwarding fails.
    */
   public async start(): Promise<string[]> {
-    return this.executeAddonOperation({
+    return this.executeAddonOperationAsync({
       operation: async () => {
         this.status = TunnelStatus.STARTING;
         this.setupCallbacks();
 
-        const connected = this.addon.tunnelStartNonBlocking(this.tunnelRef);
+        // Settled natively by the tunnel's callbacks and rejected by anything
+        // else that ends this attempt; the callbacks below then leave
+        // tunnelEstablished to it.
+        const nativeEstablished =
+          typeof this.addon.tunnelStartPromise === "function"
+            ? this.addon.tunnelStartPromise(this.tunnelRef)
+            : null;
+        this.nativeStart = nativeEstablished !== null;
+        nativeEstablished?.catch(() => {});
+
+        // Connecting resolves DNS and opens the socket; keep that off the JS thread.
+        const connected =
+          typeof this.addon.tunnelStartAsync === "function"
+            ? await this.addon.tunnelStartAsync(this.tunnelRef)
+            : this.addon.tunnelStartNonBlocking(this.tunnelRef);
         if (!connected) {
           throw new Error("Tunnel connection failed.");
         }
@@ -481,8 +630,25 @@ export class Tunnel implements ITunnel {
         this.pollStart();
 
         // Wait for tunnel to be established (which includes forwarding URLs)
-        await this.tunnelEstablished;
-        return this._urls;
+        if (!nativeEstablished) {
+          await this.tunnelEstablished;
+          return this._urls;
+        }
+
+        let urls: string[];
+        try {
+          urls = await nativeEstablished;
+        } catch (e: any) {
+          const error = new PinggyError(e?.message ?? String(e));
+          this.status = TunnelStatus.CLOSED;
+          this.rejectTunnelStart(error);
+          throw error;
+        }
+        this.primaryForwardingDone = true;
+        this._urls = urls;
+        this.status = TunnelStatus.LIVE;
+        this.resolveTunnelStart();
+        return urls;
       },
       operationName: "starting tunnel",
     });
@@ -499,7 +665,10 @@ export class Tunnel implements ITunnel {
           ? e
           : new Error(String(e));
 
-      this.rejectTunnelStart(error);
+      // With a native start promise, releasing the callbacks below rejects it.
+      if (!this.nativeStart) {
+        this.rejectTunnelStart(error);
+      }
 
       if (!this.intentionallyStopped) {
         this.notifyPollingError(error);
@@ -513,12 +682,18 @@ export class Tunnel implements ITunnel {
       } catch(cbErr) {
         Logger.error("Error in onCleanupCompleteCallback:", cbErr as Error);
       };
+
+      // Nothing polls the tunnel any more; let go of the native callback block.
+      if (typeof this.addon.tunnelReleaseCallbacks === "function") {
+        this.addon.tunnelReleaseCallbacks(this.tunnelRef, error.message);
+        this._usageView = null;
+      }
     };
 
     const poll = (): void => {
       try {
         
-        if (!this.addon.tunnelResumeWithTimeout(this.tunnelRef, 100)) {
+        if (!this.addon.tunnelResumeWithTimeout(this.tunnelRef, this.nextPollTimeout())) {
           handlePollError(new Error("Tunnel error detected during polling."));
           return;
         }
@@ -529,9 +704,62 @@ export class Tunnel implements ITunnel {
       }
       setImmediate(poll);
     };
+
+    const onDriverExit = (_ref: number, active: boolean): void => {
+      if (!active || this.intentionallyStopped) {
+        handlePollError(new Error("Tunnel error detected during polling."));
+        return;
+      }
+      // Released while still running, e.g. because its reactor was closed:
+      // keep the tunnel going from this thread.
+      Logger.info("Tunnel released by its native driver; polling it from JavaScript.");
+      poll();
+    };
+
+    const reactorId = this.pinggyOptions.optional?.reactor;
+    if (reactorId !== undefined && typeof this.addon.reactorAttach === "function") {
+      try {
+        this.addon.reactorAttach(reactorId, this.tunnelRef, onDriverExit);
+      } catch (e) {
+        handlePollError(e);
+      }
+      return;
+    }
+
+    if (
+      this.pinggyOptions.optional?.nativePump &&
+      typeof this.addon.tunnelStartPump === "function"
+    ) {
+      try {
+        this.addon.tunnelStartPump(this.tunnelRef, onDriverExit);
+      } catch (e) {
+        handlePollError(e);
+      }
+      return;
+    }
+
     poll();
   }
 
+  /**
+   * Stretches the resume timeout while the tunnel has no live connections and
+   * no queued work; snaps back to the minimum on any activity.
+   */
+  private nextPollTimeout(): number {
+    if (
+      this._latestUsage.numLiveConnections > 0 ||
+      !this.functionQueue.isEmpty() ||
+      typeof this.addon.tunnelNextResumeTimeout !== "function"
+    ) {
+      return POLL_TIMEOUT_MIN_MS;
+    }
+    return this.addon.tunnelNextResumeTimeout(
+      this.tunnelRef,
+      POLL_TIMEOUT_MIN_MS,
+      POLL_TIMEOUT_MAX_MS,
+    );
+  }
+
   private notifyPollingError(error: Error): void {
     if (this.onPollingErrorCallback) {
       try {
@@ -550,6 +778,29 @@ export class Tunnel implements ITunnel {
     this.onCleanupCompleteCallback = callback;
   }
 
+  /**
+   * Sets a callback invoked whenever {@link Tunnel#status} changes.
+   * @param {(status: TunnelStatus) => void} callback - The callback function.
+   */
+  public setStatusChangeCallback(callback: (status: TunnelStatus) => void): void {
+    this.onStatusChangeCallback = callback;
+  }
+
+  /** Current status of the tunnel. */
+  public get status(): TunnelStatus {
+    return this._status;
+  }
+
+  public set status(status: TunnelStatus) {
+    if (status === this._status) return;
+    this._status = status;
+    try {
+      this.onStatusChangeCallback?.(status);
+    } catch (cbErr) {
+      Logger.error("Error in onStatusChangeCallback:", cbErr as Error);
+    }
+  }
+
 
   /**
    * Starts web debugging for the tunnel on the specified local port.
@@ -654,10 +905,13 @@ export class Tunnel implements ITunnel {
     return this._urls;
   }
 
-  public getTunnelGreetMessage(): string[] {
-    return this.executeAddonOperation({
-      operation: () => {
-        const raw = this.addon.getTunnelGreetMessage(this.tunnelRef);
+  public async getTunnelGreetMessage(): Promise<string[]> {
+    return this.executeAddonOperationAsync({
+      operation: async () => {
+        const raw =
+          typeof this.addon.getTunnelGreetMessageAsync === "function"
+            ? await this.addon.getTunnelGreetMessageAsync(this.tunnelRef)
+            : this.addon.getTunnelGreetMessage(this.tunnelRef);
         if (!raw) return [];
         try {
           const parsedGreetMsg = JSON.parse(raw);
@@ -687,14 +941,16 @@ export class Tunnel implements ITunnel {
     });
   }
 
-  public getTunnelUsages(): string {
-    return this.executeAddonOperation({
-      operation: () => this.addon.getTunnelUsages(this.tunnelRef),
+  public async getTunnelUsages(): Promise<string> {
+    const usages = await this.executeAddonOperationAsync({
+      operation: () =>
+        typeof this.addon.getTunnelUsagesAsync === "function"
+          ? this.addon.getTunnelUsagesAsync(this.tunnelRef)
+          : Promise.resolve(this.addon.getTunnelUsages(this.tunnelRef)),
       operationName: "getting tunnel usages",
-      logResult: (usages) =>
-        Logger.info(`Tunnel usages for ${this.tunnelRef}: ${usages}`),
-      defaultValue: "",
     });
+    Logger.info(`Tunnel usages for ${this.tunnelRef}: ${usages}`);
+    return usages;
   }
 
   public getLatestUsage(): TunnelUsageType | null {
@@ -702,6 +958,23 @@ export class Tunnel implements ITunnel {
     return this._latestUsage;
   }
 
+  /**
+   * Returns the tunnel's scheduling counters, including the wakeup rate since
+   * the previous call.
+   */
+  public getWakeStats(): (TunnelWakeStats & { wakeupsPerSecond: number }) | null {
+    if (!this.tunnelRef || typeof this.addon.tunnelGetWakeStats !== "function") return null;
+    const stats = this.addon.tunnelGetWakeStats(this.tunnelRef);
+    if (!stats) return null;
+
+    const previous = this.lastWakeStats ?? { resumes: 0, uptimeMs: 0 };
+    const elapsedMs = stats.uptimeMs - previous.uptimeMs;
+    const wakeupsPerSecond =
+      elapsedMs > 0 ? ((stats.resumes - previous.resumes) * 1000) / elapsedMs : 0;
+    this.lastWakeStats = stats;
+    return { ...stats, wakeupsPerSecond };
+  }
+
   public GetTunnelState(): TunnelState {
     const state = this.addon.getTunnelState(this.tunnelRef);
     return tunnelStateToString(state);
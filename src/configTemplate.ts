@@ -0,0 +1,76 @@
+import { Config } from "./bindings/config.js";
+import { PinggyError, initExceptionHandling } from "./bindings/exception.js";
+import { ForwardingEntry, Optional, TunnelConfiguration, TunnelConfigurationV1 } from "./tunnelConfiguration.js";
+import { PinggyNative } from "./types.js";
+
+/**
+ * Fields each config derived from a {@link ConfigTemplate} may change.
+ *
+ * @group Interfaces
+ * @public
+ */
+export interface ConfigTemplateOverrides {
+  /** Token of the derived tunnel; the template's when omitted. */
+  token?: string;
+  /** Forwarding of the derived tunnel; the template's when omitted. */
+  forwarding?: string | ForwardingEntry[];
+}
+
+/**
+ * Tunnel options validated and built into a native config once, for fleets
+ * of tunnels that differ only in token or forwarding.
+ *
+ * The tunnel of a config returned by {@link ConfigTemplate#derive} starts
+ * from a copy of the template's native config, so only the overridden
+ * fields are checked and set when it is created.
+ *
+ * @group Classes
+ * @public
+ */
+export class ConfigTemplate {
+  private readonly base: TunnelConfigurationV1;
+  /** The prepared native config; freed once the template is collected. */
+  private readonly config: Config;
+
+  /** @internal */
+  constructor(addon: PinggyNative, base: TunnelConfigurationV1) {
+    initExceptionHandling(addon);
+    const optional: Optional = { ...base.optional };
+    delete optional.configTemplate;
+    this.base = { ...base, optional };
+    // Fleets usually give each tunnel its own forwarding, so the template
+    // may have none; every derived config sets it anyway.
+    this.config = new Config(addon, { ...this.base, forwarding: base.forwarding || "localhost:80" });
+  }
+
+  /**
+   * Returns tunnel options equal to the template's with the given fields
+   * replaced, to pass to {@link Pinggy#createTunnel} or {@link Pinggy#forward}.
+   *
+   * Only the overrides are validated here. The returned options keep the
+   * template alive; they may also be used with an addon that cannot clone,
+   * in which case the tunnel's config is built in full.
+   *
+   * @param overrides - The fields to change.
+   * @returns The derived tunnel options.
+   * @throws {PinggyError} If an override is invalid or neither the template nor the overrides have a forwarding.
+   */
+  public derive(overrides: ConfigTemplateOverrides = {}): TunnelConfigurationV1 {
+    new TunnelConfiguration({ token: overrides.token }).validate();
+    const forwarding = overrides.forwarding ?? this.base.forwarding;
+    if (!forwarding) {
+      throw new PinggyError("Forwarding configuration missing.");
+    }
+
+    const optional: Optional = { ...this.base.optional, configTemplate: this.config.configRef };
+    // Not enumerable, so it stays behind when the options are sent to the
+    // tunnel's worker.
+    Object.defineProperty(optional, "template", { value: this });
+    return {
+      ...this.base,
+      token: overrides.token ?? this.base.token,
+      forwarding,
+      optional,
+    };
+  }
+}
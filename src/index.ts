@@ -15,6 +15,8 @@ import { TunnelConfigurationV1, HeaderModification } from "./tunnelConfiguration
 import { TunnelInstance } from "./tunnel-instance.js";
 import { Config } from "./bindings/config.js";
 import { Tunnel } from "./bindings/tunnel.js";
+import { Reactor } from "./reactor.js";
+import { ConfigTemplate } from "./configTemplate.js";
 
 /**
  * The main Pinggy tunnel manager singleton.
@@ -25,7 +27,9 @@ import { Tunnel } from "./bindings/tunnel.js";
  */
 const pinggy = Pinggy.instance;
 
-export { pinggy, Pinggy, TunnelInstance, Config, Tunnel };
+export { pinggy, Pinggy, TunnelInstance, Config, Tunnel, Reactor, ConfigTemplate };
+export type { ReactorOptions } from "./reactor.js";
+export type { ConfigTemplateOverrides } from "./configTemplate.js";
 
 /**
  * Re-export of tunnel configuration option types and interfaces.
@@ -33,9 +37,9 @@ export { pinggy, Pinggy, TunnelInstance, Config, Tunnel };
  * @see {@link TunnelConfigurationV1}
  * @see {@link HeaderModification}
  */
-export type { TunnelConfigurationV1, HeaderModification, ForwardingEntry, BasicAuthItem, Optional, RemoteManagementConfig } from "./tunnelConfiguration.js";
+export type { TunnelConfigurationV1, HeaderModification, ForwardingEntry, BasicAuthItem, Optional, RemoteManagementConfig, ConfigUpdate, ConfigUpdateOutcome, ConfigUpdateResult } from "./tunnelConfiguration.js";
 export { TunnelType } from "./tunnelConfiguration.js"
-export type { TunnelStatus, PinggyNative, TunnelUsageType } from "./types.js";
+export type { TunnelStatus, PinggyNative, TunnelUsageType, TunnelWakeStats } from "./types.js";
 export { TunnelState, tunnelStateToString, tunnelStateToStatus } from "./types.js";
 export { LogLevel } from "./utils/logger.js"
 
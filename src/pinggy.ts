@@ -2,6 +2,8 @@ import { PinggyNative } from "./types.js";
 import { TunnelConfigurationV1, TunnelConfiguration } from "./tunnelConfiguration.js";
 import { TunnelInstance } from "./tunnel-instance.js";
 import { Logger, LogLevel } from "./utils/logger.js";
+import { Reactor, ReactorOptions } from "./reactor.js";
+import { ConfigTemplate } from "./configTemplate.js";
 import path from "path";
 import { fileURLToPath } from "url";
 import { createRequire } from "module";
@@ -62,7 +64,7 @@ export class Pinggy {
       enabled: Pinggy.debugEnabled,
       logLevel: Pinggy.logLevel,
       logFilePath: Pinggy.logFilePath,
-    });
+    }, Pinggy.addon);
 
     this.tunnels.add(tunnel);
     return tunnel;
@@ -81,6 +83,35 @@ export class Pinggy {
     return await tunnel.start().then(() => tunnel);
   }
 
+  /**
+   * Creates a native reactor that drives many tunnels from a fixed set of threads.
+   *
+   * Pass the returned reactor's `id` as `optional.reactor` in the tunnel options.
+   * Such tunnels run on the calling thread, without a worker of their own.
+   *
+   * @param options - Number of threads and scheduling quantum.
+   * @returns The created reactor.
+   * @see {@link Reactor}
+   */
+  public createReactor(options: ReactorOptions = {}): Reactor {
+    return new Reactor(Pinggy.addon, options);
+  }
+
+  /**
+   * Validates tunnel options and builds their native config once, for creating
+   * many tunnels that differ only in token or forwarding.
+   *
+   * Pass the options returned by {@link ConfigTemplate#derive} to {@link Pinggy#createTunnel}.
+   *
+   * @param base - The options shared by every derived tunnel; forwarding may be left out.
+   * @returns The created template.
+   * @throws {PinggyError} If the options are invalid.
+   * @see {@link ConfigTemplate}
+   */
+  public createConfigTemplate(base: TunnelConfigurationV1): ConfigTemplate {
+    return new ConfigTemplate(Pinggy.addon, base);
+  }
+
   /**
    * Gets all currently managed tunnel instances.
    *
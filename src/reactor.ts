@@ -0,0 +1,64 @@
+import { PinggyNative } from "./types.js";
+import { Logger } from "./utils/logger.js";
+
+/**
+ * Options for {@link Pinggy#createReactor}.
+ *
+ * @group Interfaces
+ * @public
+ */
+export interface ReactorOptions {
+  /** Number of native threads servicing the attached tunnels (default: 1, max: 64). */
+  threads?: number;
+  /**
+   * Longest time in milliseconds a thread resumes one tunnel before it turns to
+   * the next one that is due (default: 50).
+   */
+  quantumMs?: number;
+}
+
+/**
+ * A small, fixed set of native threads that drive many tunnels.
+ *
+ * Each tunnel is resumed when it is due: right away while it has traffic, and
+ * from 100 ms up to once a second as it stays idle. An idle tunnel thus costs
+ * about one resume a second however many share a thread, at the price of its
+ * traffic waiting up to that second to be picked up.
+ *
+ * Pass {@link Reactor#id} as `optional.reactor` when creating a tunnel to have
+ * it serviced by the reactor. Such a tunnel gets no worker thread: it lives on
+ * the thread that created it, the reactor's threads resume it, and its
+ * callbacks run on the creating thread. Hundreds of tunnels then cost a few
+ * native threads instead of a worker (and V8 isolate) each.
+ *
+ * @group Classes
+ * @public
+ */
+export class Reactor {
+  /** Process-wide id of the native reactor. */
+  public readonly id: number;
+  /** Number of native threads. */
+  public readonly threads: number;
+
+  private readonly addon: PinggyNative;
+  private closed = false;
+
+  /** @internal */
+  constructor(addon: PinggyNative, options: ReactorOptions = {}) {
+    this.addon = addon;
+    this.threads = options.threads ?? 1;
+    this.id = addon.reactorCreate(this.threads, options.quantumMs);
+    Logger.info(`Reactor ${this.id} started with ${this.threads} thread(s).`);
+  }
+
+  /**
+   * Stops the reactor threads. Tunnels still attached are not closed: each
+   * falls back to being polled from the thread that owns it.
+   */
+  public close(): void {
+    if (this.closed) return;
+    this.closed = true;
+    this.addon.reactorDestroy(this.id);
+    Logger.info(`Reactor ${this.id} closed.`);
+  }
+}
@@ -1,9 +1,11 @@
-import { TunnelConfiguration, TunnelConfigurationV1 } from "./tunnelConfiguration.js"
+import { ConfigUpdate, ConfigUpdateResult, TunnelConfiguration, TunnelConfigurationV1 } from "./tunnelConfiguration.js"
 import { TunnelWorkerManager } from "./worker/tunnel-worker-manager.js";
+import { InProcessTunnelHost } from "./worker/in-process-tunnel-host.js";
+import { TunnelHost } from "./worker/tunnel-host.js";
 import { Logger, LogLevel } from "./utils/logger.js"
 import { Tunnel } from "./bindings/tunnel.js";
 import { Config } from "./bindings/config.js";
-import { Callback, CallbackMap, CallbackPayloadMap, CallbackType, TunnelState, TunnelStatus, TunnelUsageType, TunnelWorkerLogConfig, workerMessageType } from "./types.js";
+import { Callback, CallbackMap, CallbackPayloadMap, CallbackType, PinggyNative, TunnelState, TunnelStatus, TunnelUsageType, TunnelWakeStats, TunnelWorkerLogConfig, workerMessageType } from "./types.js";
 
 
 
@@ -17,8 +19,9 @@ import { Callback, CallbackMap, CallbackPayloadMap, CallbackType, TunnelState, T
  * @public
  */
 export class TunnelInstance {
-  // All tunnel/config operations are delegated to a worker manager
-  private workerManager: TunnelWorkerManager
+  // All tunnel/config operations are delegated to a worker manager, or run
+  // in-process for tunnels driven by a reactor
+  private workerManager: TunnelHost
   public tunnel: Tunnel | null = null; // dynamic proxy
   public config: Config | null = null; // dynamic proxy
   private callbacks = new Map<CallbackType, Function>();
@@ -29,7 +32,7 @@ export class TunnelInstance {
    * @internal
    */
 
-  constructor(workerManager: TunnelWorkerManager) {
+  constructor(workerManager: TunnelHost) {
     // initialize worker manager
     this.workerManager = workerManager;
 
@@ -74,17 +77,27 @@ export class TunnelInstance {
   /**
    * Creates a new TunnelInstance with the specified options.
    * Internally creates a {@link TunnelWorkerManager}, {@link Config}, and {@link Tunnel}.
+   * A tunnel whose options name a reactor (`optional.reactor`) runs on the
+   * calling thread instead, with `addon`, and has no worker.
    * @param options 
    * @param logConfig 
+   * @param addon The addon loaded on the calling thread; required for reactor-driven tunnels.
    * @public
    * @returns 
    */
 
-  public static async create(options: TunnelConfigurationV1, logConfig?: TunnelWorkerLogConfig): Promise<TunnelInstance> {
+  public static async create(options: TunnelConfigurationV1, logConfig?: TunnelWorkerLogConfig, addon?: PinggyNative): Promise<TunnelInstance> {
+    const pinggyOptions = new TunnelConfiguration(options);
 
-    // If the worker fails, TunnelWorkerManager.create will throw, and the error 
-    // will be caught by the outer 'try/catch'.
-    const workerManager = await TunnelWorkerManager.create(new TunnelConfiguration(options), logConfig);
+    let workerManager: TunnelHost;
+    if (pinggyOptions.optional?.reactor !== undefined) {
+      if (!addon) throw new Error("A reactor-driven tunnel needs the native addon of the calling thread.");
+      workerManager = new InProcessTunnelHost(addon, pinggyOptions, logConfig);
+    } else {
+      // If the worker fails, TunnelWorkerManager.create will throw, and the error
+      // will be caught by the outer 'try/catch'.
+      workerManager = await TunnelWorkerManager.create(pinggyOptions, logConfig);
+    }
 
     // Now that the worker is guaranteed to be ready
     const instance = new TunnelInstance(workerManager);
@@ -145,6 +158,10 @@ export class TunnelInstance {
   /**
  * Enables or disables debug logging for the tunnel worker.
  *
+ * libpinggy's own logging is process-wide, so `enable` reaches every tunnel.
+ * A reactor-driven tunnel has no worker: `logLevel` and `logFilePath` then
+ * apply to the JS logger of the calling thread.
+ *
  * @group Utilities
  */
   public async setDebugLogging(enable: boolean, logLevel: LogLevel = LogLevel.INFO, logFilePath: string | null): Promise<void> {
@@ -165,12 +182,14 @@ export class TunnelInstance {
   /**
    * Gets the list of public URLs for the tunnel.
    *
-   * Delegates to {@link Tunnel#getUrls}.
+   * Read from the state the worker mirrors into shared memory; delegates to
+   * {@link Tunnel#getUrls} when that is unavailable.
    *
    * @returns {Promise<string[]>} The list of public tunnel URLs.
    */
   public async urls(): Promise<string[]> {
-    return await this.activeTunnel.getUrls();
+    const tunnel = this.activeTunnel;
+    return this.workerManager.state?.urls() ?? await tunnel.getUrls();
   }
 
   /**
@@ -240,13 +259,28 @@ export class TunnelInstance {
   /**
    * Get the latest usage statistics for the tunnel.
    *
-   * Delegates to {@link Tunnel#getLatestUsage}.
+   * Read from the state the worker mirrors into shared memory; delegates to
+   * {@link Tunnel#getLatestUsage} when that is unavailable.
    *
    * @returns {Promise<TunnelUsageType | null>} The latest usage statistics, or null if unavailable.
    * @throws {Error} If the tunnel is not initialized.
    */
   public async getLatestUsage(): Promise<TunnelUsageType | null> {
-    return await this.activeTunnel.getLatestUsage();
+    const tunnel = this.activeTunnel;
+    return this.workerManager.state?.latestUsage() ?? await tunnel.getLatestUsage();
+  }
+
+  /**
+   * Get the tunnel's scheduling counters: how often the thread driving it woke
+   * up, how many of those wakeups found nothing to do, and the wakeup rate since
+   * the previous call.
+   *
+   * Delegates to {@link Tunnel#getWakeStats}.
+   *
+   * @returns {Promise<(TunnelWakeStats & { wakeupsPerSecond: number }) | null>} The counters, or null before the tunnel is polled.
+   */
+  public async getWakeStats(): Promise<(TunnelWakeStats & { wakeupsPerSecond: number }) | null> {
+    return await this.activeTunnel.getWakeStats();
   }
 
   /**
@@ -387,24 +421,28 @@ export class TunnelInstance {
   /**
    * Checks if the tunnel is currently active.
    *
-   * Delegates to {@link Tunnel#tunnelIsActive}.
+   * Read from the state the worker mirrors into shared memory; delegates to
+   * {@link Tunnel#tunnelIsActive} when that is unavailable.
    *
    * @returns {Promise<boolean>} True if the tunnel is active, false otherwise.
    */
   public async isActive(): Promise<boolean> {
-    return await this.activeTunnel.tunnelIsActive();
+    const tunnel = this.activeTunnel;
+    return this.workerManager.state?.isActive() ?? await tunnel.tunnelIsActive();
   }
 
   /**
    * Gets the current status of the tunnel.
    *
-   * Returns the status from {@link Tunnel#status}.
+   * Read from the state the worker mirrors into shared memory; falls back to
+   * {@link Tunnel#getStatus} when that is unavailable.
    *
    * @returns {Promise<TunnelStatus>} The tunnel status.
    */
   public async getStatus(): Promise<TunnelStatus> {
     try{
-      return await this.activeTunnel.getStatus();
+      const tunnel = this.activeTunnel;
+      return this.workerManager.state?.status() ?? await tunnel.getStatus();
     } catch (error) {
       Logger.error(`Error getting tunnel status:", ${error}`);
       return TunnelStatus.CLOSED;
@@ -708,4 +746,25 @@ export class TunnelInstance {
     const result = await this.workerManager.call("tunnel", "", workerMessageType.GetTunnelConfig);
     return result as TunnelConfiguration | null;
   }
+
+  /**
+   * Changes options of this tunnel without recreating it.
+   *
+   * Only options whose value differs from the tunnel's native config are
+   * set. libpinggy sends these options to the server when the tunnel
+   * connects, so a change made once the tunnel has started reaches the
+   * server on its next reconnect.
+   *
+   * Delegates to {@link Config#update}.
+   *
+   * @group Configuration
+   * @param {ConfigUpdate} update - The options to change.
+   * @returns {Promise<ConfigUpdateResult>} For each option given, whether it was unchanged, applied, or waits for a reconnect.
+   * @throws {Error} If an option is invalid; nothing is changed then.
+   */
+  public async updateConfig(update: ConfigUpdate): Promise<ConfigUpdateResult> {
+    // One call reads the tunnel state and applies the update, so the outcome
+    // cannot go stale between the two.
+    return await this.workerManager.call("config", "update", workerMessageType.UpdateConfig, update);
+  }
 }
@@ -109,6 +109,23 @@ export type Optional = {
    * Used in the `pinggy-cli` to enable/disable TUI
    */
   noTui?: boolean;
+  /**
+   * Drive the tunnel from a dedicated native thread instead of polling it on the
+   * JavaScript event loop.
+   */
+  nativePump?: boolean;
+  /**
+   * Id of a reactor (see `pinggy.createReactor`) that should drive the tunnel.
+   * The tunnel then runs on the thread that creates it rather than in a worker.
+   * Takes precedence over `nativePump`.
+   */
+  reactor?: number;
+  /**
+   * Native config of the template the options were derived from; set by
+   * `ConfigTemplate.derive`, not by hand.
+   * @internal
+   */
+  configTemplate?: number;
 };
 
 export const enum TunnelType {
@@ -260,6 +277,45 @@ export type TunnelConfigurationV1 = {
   keepAliveInterval?: number;
 };
 
+/**
+ * Options of a created tunnel that `TunnelInstance.updateConfig` can change.
+ *
+ * @group Types
+ * @public
+ */
+export type ConfigUpdate = Pick<
+  TunnelConfigurationV1,
+  | "ipWhitelist"
+  | "basicAuth"
+  | "bearerTokenAuth"
+  | "headerModification"
+  | "xForwardedFor"
+  | "httpsOnly"
+  | "originalRequestUrl"
+  | "allowPreflight"
+  | "reverseProxy"
+>;
+
+/**
+ * What `TunnelInstance.updateConfig` did with one option:
+ * - `"unchanged"`: the tunnel already had this value.
+ * - `"applied"`: set before the tunnel connected, so it is in effect.
+ * - `"reconnect"`: set, but the connected session keeps the old value until
+ *   the tunnel reconnects.
+ *
+ * @group Types
+ * @public
+ */
+export type ConfigUpdateOutcome = "unchanged" | "applied" | "reconnect";
+
+/**
+ * Outcome of `TunnelInstance.updateConfig` for each option it was given.
+ *
+ * @group Types
+ * @public
+ */
+export type ConfigUpdateResult = { [K in keyof ConfigUpdate]?: ConfigUpdateOutcome };
+
 export class TunnelConfiguration implements TunnelConfigurationV1 {
   public forwarding?: string | ForwardingEntry[] | null;
   public token?: string;
@@ -417,15 +473,17 @@ export class TunnelConfiguration implements TunnelConfigurationV1 {
 
   /**
    * Validates the current configuration and throws errors if any issues are found.
+   * @param checkIpWhitelist - Check each IP whitelist entry; pass false when
+   * the native addon compiles the whitelist, which checks them itself.
    * @throws {Error} When validation fails
    */
-  validate(): void {
+  validate(checkIpWhitelist: boolean = true): void {
     const errors: string[] = [];
 
     // TODO: Validate forwarding
 
     // Validate IP whitelist
-    if (this.ipWhitelist && this.ipWhitelist.length > 0) {
+    if (checkIpWhitelist && this.ipWhitelist && this.ipWhitelist.length > 0) {
       this.ipWhitelist.forEach((ip, index) => {
         if (!this.isValidIPorCIDR(ip)) {
           errors.push(`Invalid IP address at index ${index}: ${ip}`);
@@ -8,6 +8,7 @@
  */
 
 import { LogLevel } from "./utils/logger.js";
+import type { ConfigUpdate } from "./tunnelConfiguration.js";
 
 
 
@@ -138,6 +139,37 @@ export interface PinggyNative {
   configSetWebdebuggerAddr(configRef: number, addr: string): void;
   /** Reset all forwardings for a config. */
   configResetForwardings(configRef: number): void;
+  /**
+   * Set any number of config fields in a single call. Each field is passed as
+   * its index in `configFieldKeys` followed by its value; fields are set in
+   * argument order and undefined or null values are skipped. Stops at the
+   * first field that makes libpinggy raise and returns its key (fetch the
+   * exception with getLastException); returns undefined when all fields were
+   * set. Throws for an unknown index or a value of the wrong type.
+   */
+  configApply(configRef: number, ...fieldsAndValues: unknown[]): keyof NativeConfigOptions | undefined;
+  /**
+   * Read every config field in a single call, keyed like `configFieldKeys`.
+   * List fields (whitelist, auths, header modifications, forwardings) come back
+   * as their JSON text; a string field that cannot be read is null.
+   */
+  configSnapshot(configRef: number): NativeConfigSnapshot;
+  /**
+   * Create a new config holding a copy of every field of `configRef`, owned
+   * by the calling thread. The source is only read, so a config built once
+   * may be cloned from any worker.
+   */
+  configClone(configRef: number): number;
+  /**
+   * Compile an IP whitelist into the smallest list of prefixes covering the
+   * same addresses, as the JSON text `configSetIpWhiteList` takes. `entries`
+   * are the addresses and CIDR prefixes joined with commas; pass `count`, the
+   * number joined, to have an entry holding a comma rejected. Throws naming
+   * the first invalid entry.
+   */
+  ipWhiteListCompile(entries: string, count?: number): string;
+  /** Keys of the config fields, in the order `configApply` indexes them. */
+  readonly configFieldKeys: readonly (keyof NativeConfigOptions)[];
 
   // Config getter methods
   /** Get the argument string for a config. */
@@ -195,6 +227,111 @@ export interface PinggyNative {
   tunnelResume(tunnelRef: number): boolean;
   /** Resume a tunnel with timeout */
   tunnelResumeWithTimeout(tunnelRef: number, timeout: number): boolean;
+  /** Drive a started tunnel from a dedicated native thread instead of polling
+   *  it from JavaScript. Tunnel callbacks are still delivered on this thread.
+   *  @param tunnelRef  Reference to the tunnel object.
+   *  @param onExit     Called once the pump stops, with the result of the last resume.
+   *  @param timeoutMs  Resume timeout used by the pump thread (default 100).
+   */
+  tunnelStartPump(
+    tunnelRef: number,
+    onExit: (tunnelRef: number, active: boolean) => void,
+    timeoutMs?: number
+  ): boolean;
+  /** Ask the native pump of a tunnel to stop. Returns false if none is running. */
+  tunnelStopPump(tunnelRef: number): boolean;
+  /** End the current resume of a tunnel early, from any thread of the process
+   *  that loaded this addon: it returns within one short wait slice. If no resume
+   *  is in progress the next one returns immediately. Returns false for an
+   *  unknown tunnel. */
+  tunnelWakeup(tunnelRef: number): boolean;
+  /** Bind `flag[0]`, typically in a SharedArrayBuffer, as a wake word for the
+   *  tunnel: setting it to non-zero from any thread acts like `tunnelWakeup`,
+   *  and the addon clears it. Pass null to unbind. */
+  tunnelSetWakeFlag(tunnelRef: number, flag: Int32Array | null): boolean;
+  /** Adaptive resume timeout: `minMs` after activity, doubling up to `maxMs` while idle. */
+  tunnelNextResumeTimeout(tunnelRef: number, minMs: number, maxMs: number): number;
+  /** Scheduling counters of a tunnel, or null if it has never been resumed. */
+  tunnelGetWakeStats(tunnelRef: number): TunnelWakeStats | null;
+  /** Create a reactor: `threads` native threads driving many tunnels, each
+   *  resumed when its own adaptive timeout (100 ms after activity, up to 1 s
+   *  while idle) falls due.
+   *  @param threads    Number of threads (1-64).
+   *  @param quantumMs  Longest resume of one tunnel before the thread turns to
+   *                    the next one due (default 50).
+   *  @returns          Process-wide reactor id, usable from any worker.
+   */
+  reactorCreate(threads: number, quantumMs?: number): number;
+  /** Hand a started tunnel to a reactor. Detach it again with `tunnelStopPump`. */
+  reactorAttach(
+    reactorId: number,
+    tunnelRef: number,
+    onExit: (tunnelRef: number, active: boolean) => void
+  ): boolean;
+  /** Stop a reactor created on this thread; attached tunnels get onExit with
+   *  active = true, and Tunnel then polls them itself. */
+  reactorDestroy(reactorId: number): boolean;
+
+  /**
+   * tunnelStartNonBlocking on the libuv threadpool, so connecting never blocks
+   * the JS thread. Callbacks fired meanwhile run before the promise settles.
+   * These async variants reject with an Error whose `code` is
+   * `ERR_PINGGY_EXCEPTION` when libpinggy raises an exception during the call.
+   */
+  tunnelStartAsync(tunnelRef: number): Promise<boolean>;
+  /** tunnelStop on the libuv threadpool. */
+  tunnelStopAsync(tunnelRef: number): Promise<boolean>;
+  /** getTunnelGreetMessage on the libuv threadpool. */
+  getTunnelGreetMessageAsync(tunnelRef: number): Promise<string>;
+  /** getTunnelUsages on the libuv threadpool; rejects when no usages are available. */
+  getTunnelUsagesAsync(tunnelRef: number): Promise<string>;
+  /** getTunnelWebDebuggingAddress on the libuv threadpool. */
+  getTunnelWebDebuggingAddressAsync(tunnelRef: number): Promise<string>;
+
+  /**
+   * Promise for the tunnel's public URLs, settled from native code: resolved by
+   * the established callback, rejected by the failed, disconnected or
+   * unrecoverable error callback, or when the start call fails, the tunnel is
+   * stopped or freed, or its callbacks are released.
+   * Call before starting the tunnel; callbacks registered from JS keep firing.
+   */
+  tunnelStartPromise(tunnelRef: number): Promise<string[]>;
+
+  /**
+   * Deliver all of a tunnel's events as batches: one call per resume with an
+   * array of [NativeEventType, ...callbackArgs] entries, instead of one call per
+   * event. A batch carries only the latest of its usage updates. Replaces the
+   * per-event callbacks of the tunnel. Pass null to stop.
+   */
+  tunnelSetEventBatchCallback(
+    tunnelRef: number,
+    callback: ((tunnelRef: number, events: [NativeEventType, ...any[]][]) => void) | null
+  ): boolean;
+
+  /**
+   * Have the addon parse the tunnel's usage updates natively into `view`, a
+   * Float64Array of at least 6 slots (elapsedTime, numLiveConnections,
+   * numTotalConnections, numTotalReqBytes, numTotalResBytes, numTotalTxBytes).
+   * The view is filled right before the usage callback runs, and the callback
+   * then receives null instead of the JSON text. Pass null to stop.
+   */
+  tunnelSetUsageView(tunnelRef: number, view: Float64Array | null): boolean;
+
+  /**
+   * Drop every JS callback the addon holds for a tunnel (per-event callbacks,
+   * batch callback and usage view). Call once the tunnel is no longer polled;
+   * events still queued for it are discarded. A start promise still pending
+   * is rejected with `reason`.
+   */
+  tunnelReleaseCallbacks(tunnelRef: number, reason?: string): void;
+
+  /**
+   * Take ownership of a config or tunnel ref created by this thread. The
+   * native object is freed once the returned token is garbage collected (or
+   * when the thread exits); keep the token alive for as long as the ref is used.
+   * Throws if the ref already has an owner.
+   */
+  refOwner(ref: number): object;
 
   /** Start web debugging for a tunnel.
    *  @param tunnel         Reference to the tunnel object.
@@ -217,8 +354,22 @@ export interface PinggyNative {
 
   /** Initialize exception handling. */
   initExceptionHandling(): void;
-  /** Get the last exception message. */
-  getLastException(): string;
+  /**
+   * Get and clear the last exception message. With a tunnel ref, an exception
+   * raised while serving a different tunnel is left in place.
+   */
+  getLastException(tunnelRef?: number): string;
+  /**
+   * An Int32Array whose only element changes every time an exception is
+   * recorded for this thread, or null if the runtime does not allow it.
+   * Read it with `Atomics.load` and call {@link getLastException} only when it moved.
+   */
+  getExceptionGenerationView(): Int32Array | null;
+  /**
+   * Recent exceptions recorded for this thread (at most 64), oldest first.
+   * @param afterSequence Only return exceptions with a greater `sequence`.
+   */
+  getExceptionHistory(afterSequence?: number): NativeExceptionRecord[];
 
   /** Enable or disable debug logging. */
   setDebugLogging(enabled: boolean): void;
@@ -376,6 +527,27 @@ export interface Tunnel {
 }
 
 
+/**
+ * Event types reported by the native addon, in the order of its event table.
+ * Each entry of a tunnelSetEventBatchCallback batch starts with one of these,
+ * followed by the arguments of the matching per-event callback.
+ * @internal
+ */
+export enum NativeEventType {
+  AdditionalForwardingSucceeded = 0,
+  AdditionalForwardingFailed = 1,
+  TunnelEstablished = 2,
+  TunnelFailed = 3,
+  ForwardingsChanged = 4,
+  Disconnected = 5,
+  TunnelError = 6,
+  UsageUpdate = 7,
+  WillReconnect = 8,
+  Reconnecting = 9,
+  ReconnectionCompleted = 10,
+  ReconnectionFailed = 11,
+}
+
 export enum TunnelStateCode {
   Invalid = 0,
   Initial = 1,
@@ -524,7 +696,8 @@ export enum workerMessageType {
   Callback = "callback",
   RegisterCallback = "registerCallback",
   EnableLogger = "enableLogger",
-  GetTunnelConfig = "getConfig"
+  GetTunnelConfig = "getConfig",
+  UpdateConfig = "updateConfig"
 }
 
 export type WorkerMessage =
@@ -534,7 +707,8 @@ export type WorkerMessage =
   | { type: workerMessageType.Callback; event: CallbackType; data: any }
   | { type: workerMessageType.RegisterCallback; event: CallbackType }
   | { type: workerMessageType.EnableLogger; enabled: boolean, logLevel: LogLevel, logFilePath: string | null }
-  | { type: workerMessageType.GetTunnelConfig; id: string };
+  | { type: workerMessageType.GetTunnelConfig; id: string }
+  | { type: workerMessageType.UpdateConfig; id: string; args: [ConfigUpdate] };
 
 export type PendingCall = {
   resolve: (value: any) => void;
@@ -570,6 +744,110 @@ export type TunnelUsageType = {
   numTotalTxBytes: number;
 };
 
+/**
+ * One exception recorded by the native addon, see {@link PinggyNative.getExceptionHistory}.
+ * `code` is `ERR_PINGGY_` followed by `where` upper-cased.
+ * @internal
+ */
+export interface NativeExceptionRecord extends Error {
+  code: string;
+  /** Where libpinggy raised it. */
+  where: string;
+  /** What libpinggy reported. */
+  what: string;
+  /** Tunnel being served when it was raised, 0 if none. */
+  tunnelRef: number;
+  /** Process-wide number of the thread that raised it. */
+  thread: number;
+  /** Milliseconds since the epoch. */
+  timestamp: number;
+  /** Increases by one per exception recorded for this thread. */
+  sequence: number;
+}
+
+/**
+ * Config fields settable through {@link PinggyNative.configApply}, each
+ * matching the `configSet*` call of the same name. Arrays and objects are
+ * set as their JSON text.
+ * @internal
+ */
+export type NativeConfigOptions = {
+  serverAddress?: string;
+  sniServerName?: string;
+  token?: string;
+  forwardings?: string | object[];
+  argument?: string;
+  ipWhiteList?: string | string[];
+  basicAuths?: string | object[];
+  bearerTokenAuths?: string | string[];
+  headerModification?: string | object[];
+  localServerTls?: string;
+  webdebuggerAddr?: string;
+  advancedParsing?: boolean;
+  force?: boolean;
+  ssl?: boolean;
+  insecure?: boolean;
+  httpsOnly?: boolean;
+  allowPreflight?: boolean;
+  xForwardedFor?: boolean;
+  reverseProxy?: boolean;
+  originalRequestUrl?: boolean;
+  autoReconnect?: boolean;
+  webdebugger?: boolean;
+  reconnectInterval?: number;
+  maxReconnectAttempts?: number;
+};
+
+/**
+ * All config fields as read by {@link PinggyNative.configSnapshot}.
+ * @internal
+ */
+export type NativeConfigSnapshot = {
+  serverAddress: string | null;
+  sniServerName: string | null;
+  token: string | null;
+  forwardings: string | null;
+  argument: string | null;
+  ipWhiteList: string | null;
+  basicAuths: string | null;
+  bearerTokenAuths: string | null;
+  headerModification: string | null;
+  localServerTls: string | null;
+  webdebuggerAddr: string | null;
+  advancedParsing: boolean;
+  force: boolean;
+  ssl: boolean;
+  insecure: boolean;
+  httpsOnly: boolean;
+  allowPreflight: boolean;
+  xForwardedFor: boolean;
+  reverseProxy: boolean;
+  originalRequestUrl: boolean;
+  autoReconnect: boolean;
+  webdebugger: boolean;
+  reconnectInterval: number;
+  maxReconnectAttempts: number;
+};
+
+/**
+ * Scheduling counters of a tunnel, see {@link TunnelInstance#getWakeStats}.
+ */
+export type TunnelWakeStats = {
+  /**
+   * Number of times the thread driving the tunnel woke up from resume: one per
+   * libpinggy resume call, so a long wait cut into slices counts every slice.
+   */
+  resumes: number;
+  /** Resumes that ran into their timeout without any activity or wakeup. */
+  idleResumes: number;
+  /** Explicit wakeups (RPCs, stops). */
+  wakeups: number;
+  /** Milliseconds since the tunnel was first resumed. */
+  uptimeMs: number;
+  /** Timeout used by the most recent resume. */
+  lastTimeoutMs: number;
+};
+
 export type CallbackPayloadMap = {
   [CallbackType.TunnelUsageUpdate]: TunnelUsageType;
   [CallbackType.TunnelError]: {
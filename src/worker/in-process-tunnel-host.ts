@@ -0,0 +1,94 @@
+import { CallbackType, PinggyNative, TunnelWorkerLogConfig, workerMessageType } from "../types.js";
+import { Config } from "../bindings/config.js";
+import { Tunnel } from "../bindings/tunnel.js";
+import { initExceptionHandling } from "../bindings/exception.js";
+import { Logger, LogLevel } from "../utils/logger.js";
+import { TunnelConfiguration } from "../tunnelConfiguration.js";
+import { applyConfigUpdate, attachTunnelCallbacks, readTunnelConfig, TunnelHost } from "./tunnel-host.js";
+
+/**
+ * Runs a tunnel on the calling thread instead of a dedicated worker.
+ *
+ * Used for tunnels driven by a native reactor: the reactor's threads resume
+ * the tunnel and deliver its callbacks to this thread, so the tunnel needs
+ * neither a worker (and its V8 isolate) nor a thread of its own. Calls go
+ * straight to the {@link Config} and {@link Tunnel}, and errors reach the
+ * caller unchanged.
+ *
+ * @internal
+ */
+export class InProcessTunnelHost implements TunnelHost {
+  /** Reads go straight to the tunnel, so there is nothing to mirror. */
+  public readonly state = null;
+  public workerErrorCallback?: Function;
+  private readonly addon: PinggyNative;
+  private config: Config | null;
+  private tunnel: Tunnel | null;
+  private callbackHandler?: (event: CallbackType, data: any) => void;
+  private registeredCallbacks: Set<CallbackType> = new Set();
+
+  constructor(addon: PinggyNative, pinggyOptions: TunnelConfiguration, logConfig?: TunnelWorkerLogConfig) {
+    initExceptionHandling(addon);
+    this.addon = addon;
+    // Like a worker, before the config is created.
+    if (logConfig) {
+      this.applyLogging(logConfig.enabled, logConfig.logLevel, logConfig.logFilePath);
+    }
+    this.config = new Config(addon, pinggyOptions);
+    if (!this.config.configRef) throw new Error("Failed to initialize config.");
+
+    this.tunnel = new Tunnel(addon, this.config.configRef, pinggyOptions);
+    attachTunnelCallbacks(this.tunnel, (event, data) => {
+      if (!this.registeredCallbacks.has(event)) return;
+      this.callbackHandler?.(event, data);
+    });
+    Logger.info("In-process tunnel ready.");
+  }
+
+  public setCallbackHandler(fn: (event: CallbackType, data: any) => void): void {
+    this.callbackHandler = fn;
+  }
+
+  public registerCallback(event: CallbackType): void {
+    this.registeredCallbacks.add(event);
+  }
+
+  public async call(target: "config" | "tunnel", method: string, type?: workerMessageType, ...args: any[]): Promise<any> {
+    if (!this.tunnel || !this.config) {
+      throw new Error(`${!this.tunnel ? "Tunnel" : "Config"} not initialized`);
+    }
+    if (type === workerMessageType.GetTunnelConfig) {
+      return readTunnelConfig(this.config, this.tunnel);
+    }
+    if (type === workerMessageType.UpdateConfig) {
+      return applyConfigUpdate(this.config, this.tunnel, args[0]);
+    }
+
+    const targetObject = target === "config" ? this.config : this.tunnel;
+    const fn = (targetObject as any)[method];
+    if (typeof fn !== "function") throw new Error(`Unknown method: ${method}`);
+    return await fn.apply(targetObject, args);
+  }
+
+  /**
+   * An in-process tunnel has no logger of its own: it shares the JS
+   * {@link Logger} of the calling thread, and libpinggy's logging is
+   * process-wide. Both are set here just as a worker sets its own, so this
+   * applies to everything logging on this thread and to libpinggy for every
+   * tunnel in the process.
+   */
+  public async setDebugLoggingInWorker(enable: boolean, logLevel: LogLevel, logFilePath: string | null): Promise<void> {
+    this.applyLogging(enable, logLevel, logFilePath);
+  }
+
+  private applyLogging(enable: boolean, logLevel: LogLevel, logFilePath: string | null): void {
+    Logger.setDebugEnabled(enable, logFilePath ?? null);
+    Logger.setLevel(logLevel);
+    this.addon.setLogEnable(enable);
+    this.addon.setDebugLogging(enable);
+  }
+
+  public unrefWorker(): void {
+    // No worker to keep the process alive.
+  }
+}
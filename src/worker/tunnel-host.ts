@@ -0,0 +1,199 @@
+import { CallbackPayloadMap, CallbackType, TunnelState, TunnelUsageType, workerMessageType } from "../types.js";
+import { Config } from "../bindings/config.js";
+import { Tunnel } from "../bindings/tunnel.js";
+import { Logger, LogLevel } from "../utils/logger.js";
+import { BasicAuthItem, ConfigUpdate, ConfigUpdateOutcome, ConfigUpdateResult, TunnelConfigurationV1 } from "../tunnelConfiguration.js";
+import { TunnelStateMirror } from "./tunnel-state-mirror.js";
+
+/**
+ * What a {@link TunnelInstance} needs from whatever runs its tunnel: either a
+ * {@link TunnelWorkerManager} (a worker thread per tunnel) or an
+ * {@link InProcessTunnelHost} (the tunnel runs on the main thread, driven by a
+ * native reactor).
+ *
+ * @internal
+ */
+export interface TunnelHost {
+  /** Tunnel state readable without a call; null when calls are needed. */
+  readonly state: TunnelStateMirror | null;
+  workerErrorCallback?: Function;
+  call(target: "config" | "tunnel", method: string, type?: workerMessageType, ...args: any[]): Promise<any>;
+  setCallbackHandler(fn: (event: CallbackType, data: any) => void): void;
+  registerCallback(event: CallbackType): void;
+  setDebugLoggingInWorker(enable: boolean, logLevel: LogLevel, logFilePath: string | null): Promise<void>;
+  unrefWorker(): void;
+}
+
+/** Payload of a {@link CallbackType} event as the host hands it on. */
+export type ForwardCallback = <K extends CallbackType>(event: K, data: CallbackPayloadMap[K]) => void;
+
+/**
+ * Sets every tunnel callback so that it hands its event to `forward`.
+ */
+export function attachTunnelCallbacks(tunnel: Tunnel, forward: ForwardCallback): void {
+  const callbacks = {
+    usageUpdate: (usage: TunnelUsageType) =>
+      forward(CallbackType.TunnelUsageUpdate, usage),
+    tunnelError: (errorNo: number, error: string, recoverable: boolean) =>
+      forward(CallbackType.TunnelError, { errorNo, error, recoverable }),
+    tunnelDisconnected: (error: string, messages: string[]) =>
+      forward(CallbackType.TunnelDisconnected, { error, messages }),
+    tunnelAdditionalForwarding: (bindAddress: string, forwardToAddr: string, errorMessage: string | null) =>
+      forward(CallbackType.TunnelAdditionalForwarding, { bindAddress, forwardToAddr, errorMessage }),
+    tunnelEstablishedCallback: (message: string ,urls?: string[]) =>
+      forward(CallbackType.TunnelEstablished, { message, urls }),
+    tunnelForwardingChanged: (message: string, address?: string[]) =>
+      forward(CallbackType.ForwardingChanged, { message, address }),
+    willReconnect: (error: string, messages: string[]) =>
+      forward(CallbackType.WillReconnect, { error, messages }),
+    reconnecting: (retryCnt: number) =>
+      forward(CallbackType.Reconnecting, { retryCnt }),
+    reconnectionCompleted: (urls: string[]) =>
+      forward(CallbackType.ReconnectionCompleted, { urls }),
+    reconnectionFailed: (retryCnt: number) =>
+      forward(CallbackType.ReconnectionFailed, { retryCnt }),
+    pollingError: (error: Error) =>
+      forward(CallbackType.PollingError, { error }),
+    cleanupComplete:()=>{
+      Logger.info("Tunnel cleanup completed.");
+      forward(CallbackType.TunnelCleanupComplete, {});
+    }
+  };
+
+  tunnel.setUsageUpdateCallback(callbacks.usageUpdate);
+  tunnel.setTunnelErrorCallback(callbacks.tunnelError);
+  tunnel.setTunnelDisconnectedCallback(callbacks.tunnelDisconnected);
+  tunnel.setAdditionalForwardingCallback(callbacks.tunnelAdditionalForwarding)
+  tunnel.setTunnelEstablishedCallback(callbacks.tunnelEstablishedCallback);
+  tunnel.setOnTunnelForwardingChanged(callbacks.tunnelForwardingChanged);
+  tunnel.setWillReconnectCallback(callbacks.willReconnect);
+  tunnel.setReconnectingCallback(callbacks.reconnecting);
+  tunnel.setReconnectionCompletedCallback(callbacks.reconnectionCompleted);
+  tunnel.setReconnectionFailedCallback(callbacks.reconnectionFailed);
+  tunnel.setPollingErrorCallback(callbacks.pollingError);
+  tunnel.setCleanupCompleteCallback(callbacks.cleanupComplete);
+}
+
+/**
+ * Reads the tunnel's current options back from its native config.
+ */
+export function readTunnelConfig(config: Config, tunnel: Tunnel): TunnelConfigurationV1 {
+  const options: TunnelConfigurationV1 = { optional: {} };
+  // Every config field in one addon call; only the web debugger address
+  // comes from the tunnel.
+  const {
+    serverAddress,
+    token,
+    sniServerName,
+    force,
+    httpsOnly,
+    ipWhiteList,
+    allowPreflight,
+    reverseProxy: noReverseProxy,
+    xForwardedFor,
+    originalRequestUrl,
+    basicAuth: rawAuthValue,
+    bearerTokenAuth: bearerAuth,
+    reconnectInterval,
+    maxReconnectAttempts,
+    autoReconnect,
+    headerModification: headerModificationRaw,
+    forwarding: forwardingJSON,
+    ssl,
+    argument: argString,
+  } = config.getSnapshot();
+  const webDebugger = tunnel.GetWebDebuggerAddress();
+
+  // Assign simple values
+  options.serverAddress = serverAddress || "";
+  options.token = token || "";
+  options.optional!.sniServerName = sniServerName || "";
+  options.force = force || false;
+  options.httpsOnly = httpsOnly ?? false;
+  options.ipWhitelist = ipWhiteList;
+  options.allowPreflight = allowPreflight ?? false;
+  options.reverseProxy = noReverseProxy ?? false;
+  options.xForwardedFor = xForwardedFor ?? false;
+  options.originalRequestUrl = originalRequestUrl ?? false;
+  options.basicAuth = normalizeBasicAuth(rawAuthValue);
+  options.bearerTokenAuth = bearerAuth;
+  options.reconnectInterval = reconnectInterval ?? 0;
+  options.maxReconnectAttempts = maxReconnectAttempts ?? 0;
+  options.autoReconnect = autoReconnect ?? false;
+  options.webDebugger = webDebugger;
+  options.optional!.ssl = ssl ?? false;
+
+  // Handle header modification
+  options.headerModification = Array.isArray(headerModificationRaw)
+    ? headerModificationRaw.map(h =>
+      h.type === "remove"
+        ? { key: h.key, type: "remove" as const }
+        : { key: h.key, type: h.type, value: Array.isArray(h.value) ? h.value : [] },
+    )
+    : [];
+
+  // Parse forwarding JSON to extract type and forwarding address
+  if (forwardingJSON) {
+    try {
+    const forwardingRules = JSON.parse(forwardingJSON);
+    if (Array.isArray(forwardingRules) && forwardingRules.length > 0) {
+      options.forwarding = forwardingRules || null;
+    } else {
+      options.forwarding = null;
+    }
+    } catch (e) {
+    Logger.error("Failed to parse forwarding JSON:", e as Error);
+    options.forwarding = null;
+    }
+  } else {
+    options.forwarding = null;
+  }
+
+  // Parse argument string
+  const regex = /[^\s"']+|"([^"]*)"|'([^']*)'/g;
+  const argumentInParts: string[] = [];
+  let match;
+  while ((match = regex.exec(argString || "")) !== null) {
+    argumentInParts.push(match[1] || match[2] || match[0]);
+  }
+
+  if (
+    argumentInParts.length > 0 &&
+    !/^(w:|b:|k:|a:|r:|u:|x:)/.test(argumentInParts[0])
+  ) {
+    options.optional!.additionalArguments = argumentInParts[0];
+  }
+
+  return options;
+}
+
+/**
+ * Applies an option update to the tunnel's native config and reports, per
+ * option given, whether it changed and when it takes effect.
+ *
+ * The tunnel state is read in the same call, so the outcome describes the
+ * tunnel the update actually landed on: one still in its initial state
+ * connects with the new values, any other keeps the old ones until it
+ * reconnects.
+ */
+export function applyConfigUpdate(config: Config, tunnel: Tunnel, update: ConfigUpdate): ConfigUpdateResult {
+  const changed = config.update(update);
+  const outcome: ConfigUpdateOutcome = tunnel.GetTunnelState() === TunnelState.Initial ? "applied" : "reconnect";
+
+  const result: ConfigUpdateResult = {};
+  for (const option of Object.keys(update) as (keyof ConfigUpdate)[]) {
+    if (update[option] !== undefined) {
+      result[option] = changed.includes(option) ? outcome : "unchanged";
+    }
+  }
+  return result;
+}
+
+function normalizeBasicAuth(input: BasicAuthItem[] | null): BasicAuthItem[] {
+  let parsed: BasicAuthItem[] | null = null;
+  parsed = input || []
+  if (!Array.isArray(parsed) || parsed.length === 0) {
+    return [];
+  }
+  return parsed.filter(({ username, password }) => !!username && !!password);
+}
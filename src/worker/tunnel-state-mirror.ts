@@ -0,0 +1,166 @@
+import { TunnelStatus, TunnelUsageType } from "../types.js";
+
+// Int32 slots of the header.
+const SEQ = 0;
+const STATUS = 1;
+const ACTIVE = 2;
+const URLS_LENGTH = 3; // bytes, -1 when the URLs did not fit
+const URLS_VERSION = 4;
+const WAKE = 5; // set by the main thread, cleared by the addon when it wakes the worker
+const HEADER_SLOTS = 8;
+
+const USAGE_OFFSET = HEADER_SLOTS * Int32Array.BYTES_PER_ELEMENT;
+const USAGE_SLOTS = 6;
+const URLS_OFFSET = USAGE_OFFSET + USAGE_SLOTS * Float64Array.BYTES_PER_ELEMENT;
+const URLS_CAPACITY = 4096;
+
+/** Give up on a read after this many torn attempts and let the caller ask the worker. */
+const MAX_READ_ATTEMPTS = 64;
+
+const STATUS_CODES = Object.values(TunnelStatus) as TunnelStatus[];
+
+/**
+ * Tunnel state shared between a tunnel worker and the main thread.
+ *
+ * The worker is the only writer: it publishes the tunnel status, whether it is
+ * active, its URLs and the latest usage counters into a SharedArrayBuffer under
+ * a seqlock. The sequence number is odd while a write is in progress, and a
+ * reader retries whenever it changed underneath it. The main thread reads
+ * without any message round trip.
+ *
+ * Readers return null until the worker has published once, or if the buffer
+ * cannot answer (URLs too long, writer too busy); callers then fall back to
+ * asking the worker.
+ *
+ * The buffer also carries a wake word in the other direction: the main thread
+ * sets it after posting a message, and the worker's addon, which binds it with
+ * `tunnelSetWakeFlag`, ends the current resume so the message is handled.
+ *
+ * @internal
+ */
+export class TunnelStateMirror {
+  public readonly buffer: SharedArrayBuffer;
+  private readonly header: Int32Array;
+  private readonly usage: Float64Array;
+  private readonly urlBytes: Uint8Array;
+
+  // Writer side: last URLs written, so unchanged lists are not re-encoded.
+  private publishedUrls: string | null = null;
+  // Reader side: URLs decoded at `decodedVersion`.
+  private decodedUrls: string[] = [];
+  private decodedVersion = -1;
+
+  /**
+   * Allocates a mirror for a new worker, or returns null where
+   * SharedArrayBuffer is unavailable.
+   */
+  static create(): TunnelStateMirror | null {
+    if (typeof SharedArrayBuffer !== "function") return null;
+    return new TunnelStateMirror(new SharedArrayBuffer(URLS_OFFSET + URLS_CAPACITY));
+  }
+
+  constructor(buffer: SharedArrayBuffer) {
+    this.buffer = buffer;
+    this.header = new Int32Array(buffer, 0, HEADER_SLOTS);
+    this.usage = new Float64Array(buffer, USAGE_OFFSET, USAGE_SLOTS);
+    this.urlBytes = new Uint8Array(buffer, URLS_OFFSET, URLS_CAPACITY);
+  }
+
+  /** The wake word, for the worker to bind with `tunnelSetWakeFlag`. */
+  get wakeFlag(): Int32Array {
+    return new Int32Array(this.buffer, WAKE * Int32Array.BYTES_PER_ELEMENT, 1);
+  }
+
+  /** Ask the worker to leave its current resume. Main thread side. */
+  requestWake(): void {
+    Atomics.store(this.header, WAKE, 1);
+  }
+
+  /**
+   * Publish the tunnel state. Worker side only.
+   */
+  publish(status: TunnelStatus, active: boolean, urls: string[], usage: TunnelUsageType | null): void {
+    const seq = Atomics.add(this.header, SEQ, 1) + 1; // odd: write in progress
+
+    Atomics.store(this.header, STATUS, STATUS_CODES.indexOf(status));
+    Atomics.store(this.header, ACTIVE, active ? 1 : 0);
+
+    if (usage) {
+      this.usage[0] = usage.elapsedTime;
+      this.usage[1] = usage.numLiveConnections;
+      this.usage[2] = usage.numTotalConnections;
+      this.usage[3] = usage.numTotalReqBytes;
+      this.usage[4] = usage.numTotalResBytes;
+      this.usage[5] = usage.numTotalTxBytes;
+    }
+
+    const joined = urls.join("\n");
+    if (joined !== this.publishedUrls) {
+      const encoded = Buffer.from(joined, "utf8");
+      if (encoded.length <= URLS_CAPACITY) {
+        this.urlBytes.set(encoded);
+        Atomics.store(this.header, URLS_LENGTH, encoded.length);
+      } else {
+        Atomics.store(this.header, URLS_LENGTH, -1);
+      }
+      Atomics.add(this.header, URLS_VERSION, 1);
+      this.publishedUrls = joined;
+    }
+
+    Atomics.store(this.header, SEQ, seq + 1);
+  }
+
+  /** The published status, or null. */
+  status(): TunnelStatus | null {
+    const code = this.readConsistent(() => Atomics.load(this.header, STATUS));
+    return code === null || code < 0 ? null : STATUS_CODES[code] ?? null;
+  }
+
+  /** Whether the tunnel was active when last published, or null. */
+  isActive(): boolean | null {
+    const active = this.readConsistent(() => Atomics.load(this.header, ACTIVE));
+    return active === null ? null : active === 1;
+  }
+
+  /** The published URLs, or null. */
+  urls(): string[] | null {
+    const urls = this.readConsistent(() => {
+      const version = Atomics.load(this.header, URLS_VERSION);
+      if (version === this.decodedVersion) return this.decodedUrls;
+      const length = Atomics.load(this.header, URLS_LENGTH);
+      if (length < 0) return null;
+      // slice() copies out of shared memory; decode only once per version.
+      const text = Buffer.from(this.urlBytes.slice(0, length)).toString("utf8");
+      return { version, urls: text ? text.split("\n") : [] };
+    });
+    if (urls === null) return null;
+    if (!Array.isArray(urls)) {
+      this.decodedVersion = urls.version;
+      this.decodedUrls = urls.urls;
+    }
+    return [...this.decodedUrls];
+  }
+
+  /** The published usage counters, or null. */
+  latestUsage(): TunnelUsageType | null {
+    return this.readConsistent(() => ({
+      elapsedTime: this.usage[0],
+      numLiveConnections: this.usage[1],
+      numTotalConnections: this.usage[2],
+      numTotalReqBytes: this.usage[3],
+      numTotalResBytes: this.usage[4],
+      numTotalTxBytes: this.usage[5],
+    }));
+  }
+
+  private readConsistent<T>(read: () => T): T | null {
+    for (let attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+      const before = Atomics.load(this.header, SEQ);
+      if (before === 0) return null; // nothing published yet
+      if (before & 1) continue;
+      const value = read();
+      if (Atomics.load(this.header, SEQ) === before) return value;
+    }
+    return null;
+  }
+}
@@ -4,6 +4,8 @@ import { Logger, LogLevel } from "../utils/logger.js";
 import { TunnelConfiguration } from "../tunnelConfiguration.js";
 import { CallbackType, PendingCall, TunnelWorkerLogConfig, WorkerMessage, workerMessageType } from "../types.js";
 import { getRandomId } from "../utils/getRandomId.js";
+import { TunnelStateMirror } from "./tunnel-state-mirror.js";
+import { TunnelHost } from "./tunnel-host.js";
 import { fileURLToPath } from "url";
 
 /**
@@ -17,17 +19,20 @@ import { fileURLToPath } from "url";
  * - Receiving async responses and callback events from the worker.
  * - Managing worker lifecycle, readiness state, and graceful termination.
  * - Propagating runtime configurations like debug logging to the worker.
+ * - Exposing the tunnel state the worker mirrors into shared memory ({@link state}).
  *
  * @internal
  */
 
-export class TunnelWorkerManager {
+export class TunnelWorkerManager implements TunnelHost {
     private worker: Worker;
     private pendingCalls = new Map<string, PendingCall>();
     private ready = false;
     private readyPromise: Promise<void>;
     private callbackHandler?: (event: CallbackType, data: any) => void;
     public workerErrorCallback?: Function;
+    /** State published by the worker, readable without a round trip; null without SharedArrayBuffer. */
+    public readonly state: TunnelStateMirror | null = TunnelStateMirror.create();
 
     public static async create(pinggyOptions: TunnelConfiguration, logConfig?: TunnelWorkerLogConfig): Promise<TunnelWorkerManager> {
         const manager = new TunnelWorkerManager(pinggyOptions, logConfig);
@@ -38,7 +43,7 @@ export class TunnelWorkerManager {
 
     private constructor(pinggyOptions: TunnelConfiguration, logConfig?: TunnelWorkerLogConfig) {
         const workerPath = fileURLToPath(new URL('./worker/tunnel-worker.cjs', import.meta.url));
-        this.worker = new Worker(workerPath, { workerData: { options: pinggyOptions, logConfig } });
+        this.worker = new Worker(workerPath, { workerData: { options: pinggyOptions, logConfig, stateBuffer: this.state?.buffer ?? null } });
 
         // First message from worker can either be Ready or InitError
         this.readyPromise = new Promise((resolve, reject) => {
@@ -91,7 +96,7 @@ export class TunnelWorkerManager {
                 method,
                 args,
             } as WorkerMessage;
-            this.worker.postMessage(msg);
+            this.postToWorker(msg);
         });
     }
 
@@ -102,15 +107,16 @@ export class TunnelWorkerManager {
             logLevel: logLevel,
             logFilePath: logFilePath
         }
-        this.worker.postMessage(msg);
+        this.postToWorker(msg);
     }
 
     public registerCallback(event: CallbackType) {
-        this.worker.postMessage({ type: workerMessageType.RegisterCallback, event });
+        this.postToWorker({ type: workerMessageType.RegisterCallback, event });
     }
 
     public async terminate(): Promise<number | void> {
         try {
+            this.wakeWorker();
             return await this.worker.terminate();
         } catch (e) {
             Logger.error(`Error terminating TunnelWorker:${e}`);
@@ -122,6 +128,21 @@ export class TunnelWorkerManager {
         this.worker.unref();
     }
 
+    /**
+     * The worker spends most of its time blocked in `tunnelResumeWithTimeout`, so a
+     * message is only seen once that call returns. Ask it to return early through
+     * the shared wake word; without SharedArrayBuffer the message waits for the
+     * resume's timeout.
+     */
+    private postToWorker(msg: WorkerMessage): void {
+        this.worker.postMessage(msg);
+        this.wakeWorker();
+    }
+
+    private wakeWorker(): void {
+        this.state?.requestWake();
+    }
+
     private registerWorkerListeners(): void {
         this.worker.on("message", (msg: WorkerMessage) => {
             Logger.debug(`[Main] Recived msg from worker ${JSON.stringify(msg)}`)
@@ -1,5 +1,5 @@
 import { parentPort, workerData } from "worker_threads";
-import { CallbackPayloadMap, CallbackType, PinggyNative, TunnelUsageType, TunnelWorkerLogConfig, WorkerMessage, workerMessageType } from "../types.js";
+import { CallbackPayloadMap, CallbackType, PinggyNative, TunnelStatus, TunnelWorkerLogConfig, WorkerMessage, workerMessageType } from "../types.js";
 import { Config } from "../bindings/config.js";
 import { Tunnel } from "../bindings/tunnel.js";
 import { Logger, LogLevel } from "../utils/logger.js";
@@ -8,7 +8,9 @@ import {
   PinggyError,
   initExceptionHandling,
 } from "../bindings/exception.js";
-import { BasicAuthItem, HeaderModification, TunnelConfiguration, TunnelConfigurationV1 } from "../tunnelConfiguration.js";
+import { TunnelStateMirror } from "./tunnel-state-mirror.js";
+import { applyConfigUpdate, attachTunnelCallbacks, readTunnelConfig } from "./tunnel-host.js";
+import { TunnelConfiguration, TunnelConfigurationV1 } from "../tunnelConfiguration.js";
 import path from "path";
 import { fileURLToPath } from "url";
 import { createRequire } from "module";
@@ -25,9 +27,11 @@ class TunnelWorker {
   private parentPid: number;
   private parentCheckInterval: ReturnType<typeof setInterval> | null = null;
   private initialLogConfig: TunnelWorkerLogConfig;
+  private state: TunnelStateMirror | null;
 
-  constructor(rawTunnelOptions: any, logConfig?: TunnelWorkerLogConfig) {
+  constructor(rawTunnelOptions: any, logConfig?: TunnelWorkerLogConfig, stateBuffer?: SharedArrayBuffer | null) {
     this.parentPid = process.ppid;
+    this.state = stateBuffer ? new TunnelStateMirror(stateBuffer) : null;
     this.initialLogConfig = {
       enabled: logConfig?.enabled ?? false,
       logLevel: logConfig?.logLevel ?? LogLevel.INFO,
@@ -78,8 +82,14 @@ class TunnelWorker {
       if (!this.tunnel) throw new Error("Failed to initialize tunnel.");
 
       this.attachCallbacks();
+      this.bindWakeFlag();
+      this.publishState();
 
-      this.postMessage({ type: workerMessageType.Init, success: true, error: null });
+      this.postMessage({
+        type: workerMessageType.Init,
+        success: true,
+        error: null,
+      });
     } catch (e: any) {
       const pinggyError = this.convertToPinggyError(e);
       Logger.error("TunnelWorker init error:", pinggyError);
@@ -127,6 +137,9 @@ class TunnelWorker {
         case workerMessageType.GetTunnelConfig:
           this.getTunnelConfig(msg);
           return;
+        case workerMessageType.UpdateConfig:
+          this.updateConfig(msg);
+          return;
           
         default:
           Logger.info(`Unhandled message type from main thread: ${msg.type}`);
@@ -155,9 +168,11 @@ class TunnelWorker {
       if (typeof fn !== "function") throw new Error(`Unknown method: ${method}`);
 
       const result = await fn.apply(targetObject, args || []);
+      this.publishState();
       this.sendResponse(id, result);
     } catch (err: any) {
       Logger.error("TunnelWorker call error:", err);
+      this.publishState();
       this.sendResponse(id, null, err?.message || String(err));
     }
   }
@@ -168,47 +183,8 @@ class TunnelWorker {
   private attachCallbacks(): void {
     if (!this.tunnel) return;
 
-    const callbacks = {
-      usageUpdate: (usage: TunnelUsageType) =>
-        this.forwardCallback(CallbackType.TunnelUsageUpdate, usage),
-      tunnelError: (errorNo: number, error: string, recoverable: boolean) =>
-        this.forwardCallback(CallbackType.TunnelError, { errorNo, error, recoverable }),
-      tunnelDisconnected: (error: string, messages: string[]) =>
-        this.forwardCallback(CallbackType.TunnelDisconnected, { error, messages }),
-      tunnelAdditionalForwarding: (bindAddress: string, forwardToAddr: string, errorMessage: string | null) =>
-        this.forwardCallback(CallbackType.TunnelAdditionalForwarding, { bindAddress, forwardToAddr, errorMessage }),
-      tunnelEstablishedCallback: (message: string ,urls?: string[]) =>
-        this.forwardCallback(CallbackType.TunnelEstablished, { message, urls }),
-      tunnelForwardingChanged: (message: string, address?: string[]) =>
-        this.forwardCallback(CallbackType.ForwardingChanged, { message, address }),
-      willReconnect: (error: string, messages: string[]) =>
-        this.forwardCallback(CallbackType.WillReconnect, { error, messages }),
-      reconnecting: (retryCnt: number) =>
-        this.forwardCallback(CallbackType.Reconnecting, { retryCnt }),
-      reconnectionCompleted: (urls: string[]) =>
-        this.forwardCallback(CallbackType.ReconnectionCompleted, { urls }),
-      reconnectionFailed: (retryCnt: number) =>
-        this.forwardCallback(CallbackType.ReconnectionFailed, { retryCnt }),
-      pollingError: (error: Error) =>
-        this.forwardCallback(CallbackType.PollingError, { error }),
-      cleanupComplete:()=>{
-        Logger.info("Tunnel cleanup completed.");
-        this.forwardCallback(CallbackType.TunnelCleanupComplete, {});
-      }
-    };
-
-    this.tunnel.setUsageUpdateCallback(callbacks.usageUpdate);
-    this.tunnel.setTunnelErrorCallback(callbacks.tunnelError);
-    this.tunnel.setTunnelDisconnectedCallback(callbacks.tunnelDisconnected);
-    this.tunnel.setAdditionalForwardingCallback(callbacks.tunnelAdditionalForwarding)
-    this.tunnel.setTunnelEstablishedCallback(callbacks.tunnelEstablishedCallback);
-    this.tunnel.setOnTunnelForwardingChanged(callbacks.tunnelForwardingChanged);
-    this.tunnel.setWillReconnectCallback(callbacks.willReconnect);
-    this.tunnel.setReconnectingCallback(callbacks.reconnecting);
-    this.tunnel.setReconnectionCompletedCallback(callbacks.reconnectionCompleted);
-    this.tunnel.setReconnectionFailedCallback(callbacks.reconnectionFailed);
-    this.tunnel.setPollingErrorCallback(callbacks.pollingError);
-    this.tunnel.setCleanupCompleteCallback(callbacks.cleanupComplete);
+    attachTunnelCallbacks(this.tunnel, (event, data) => this.forwardCallback(event, data));
+    this.tunnel.setStatusChangeCallback(() => this.publishState());
   }
 
   /**
@@ -216,6 +192,7 @@ class TunnelWorker {
    */
   private forwardCallback<K extends CallbackType>(event: K, data:CallbackPayloadMap[K]) {
     Logger.debug(`[Worker] Callback recived. Callbackname: ${event},data:${JSON.stringify(data)}`)
+    this.publishState();
     if (!this.registeredCallbacks.has(event)) return;
     this.postMessage({
       type: workerMessageType.Callback,
@@ -237,6 +214,36 @@ class TunnelWorker {
     });
   }
 
+  /**
+   * Let the main thread end the tunnel's resume early through the shared
+   * buffer, so posted messages are handled without waiting for its timeout.
+   */
+  private bindWakeFlag(): void {
+    if (!this.state || !this.tunnel || typeof this.addon?.tunnelSetWakeFlag !== "function") return;
+    try {
+      this.addon.tunnelSetWakeFlag(this.tunnel.tunnelRef, this.state.wakeFlag);
+    } catch (e) {
+      Logger.debug(`[Worker] Failed to bind the wake flag: ${e}`);
+    }
+  }
+
+  /**
+   * Mirror the tunnel's status, URLs and usage into the buffer shared with the main thread.
+   */
+  private publishState(): void {
+    if (!this.state || !this.tunnel || !this.addon) return;
+    try {
+      this.state.publish(
+        this.tunnel.getStatus(),
+        this.addon.tunnelIsActive(this.tunnel.tunnelRef),
+        this.tunnel.getUrls(),
+        this.tunnel.getLatestUsage(),
+      );
+    } catch (e) {
+      Logger.debug(`[Worker] Failed to publish tunnel state: ${e}`);
+    }
+  }
+
   /**
    * Gracefully clean up resources when the worker shuts down
    */
@@ -249,6 +256,7 @@ class TunnelWorker {
     } catch (e) {
       Logger.error(`TunnelWorker cleanup error: ${e}`);
     }
+    this.state?.publish(TunnelStatus.CLOSED, false, [], null);
     this.tunnel = null;
     this.config = null;
     this.addon = null;
@@ -334,129 +342,26 @@ class TunnelWorker {
     this.sendResponse(id, tunnelConfig);
   }
 
-  private async getConfig(): Promise<TunnelConfigurationV1 | null> {
-    const options: TunnelConfigurationV1 = { optional: {} };
-    if (!this.config || !this.tunnel) return null;
-    // Run all independent async calls in parallel
-    const [
-      serverAddress,
-      token,
-      sniServerName,
-      force,
-      httpsOnly,
-      ipWhiteList,
-      allowPreflight,
-      noReverseProxy,
-      xForwardedFor,
-      originalRequestUrl,
-      rawAuthValue,
-      bearerAuth,
-      reconnectInterval,
-      maxReconnectAttempts,
-      autoReconnect,
-      headerModificationRaw,
-      webDebugger,
-      forwardingJSON,
-      ssl,
-      argString,
-    ] = await Promise.all([
-      this.config.getServerAddress(),
-      this.config.getToken(),
-      this.config.getSniServerName(),
-      this.config.getForce(),
-      this.config.getHttpsOnly(),
-      this.config.getIpWhiteList(),
-      this.config.getAllowPreflight(),
-      this.config.getNoReverseProxy(),
-      this.config.getXForwardedFor(),
-      this.config.getOriginalRequestUrl(),
-      this.config.getBasicAuth(),
-      this.config.getBearerTokenAuth(),
-      this.config.getReconnectInterval(),
-      this.config.getMaxReconnectAttempts(),
-      this.config.getAutoReconnect(),
-      this.config.getHeaderModification() as unknown as Promise<HeaderModification[]>,
-      this.tunnel.GetWebDebuggerAddress(),
-      this.config.getForwarding(),
-      this.config.getTunnelSsl(),
-      this.config.getArgument(),
-    ]);
-
-    // Assign simple values
-    options.serverAddress = serverAddress || "";
-    options.token = token || "";
-    options.optional!.sniServerName = sniServerName || "";
-    options.force = force || false;
-    options.httpsOnly = httpsOnly ?? false;
-    options.ipWhitelist = ipWhiteList;
-    options.allowPreflight = allowPreflight ?? false;
-    options.reverseProxy = noReverseProxy ?? false;
-    options.xForwardedFor = xForwardedFor ?? false;
-    options.originalRequestUrl = originalRequestUrl ?? false;
-    options.basicAuth = this.normalizeBasicAuth(rawAuthValue as BasicAuthItem[] | null);
-    options.bearerTokenAuth = bearerAuth;
-    options.reconnectInterval = reconnectInterval ?? 0;
-    options.maxReconnectAttempts = maxReconnectAttempts ?? 0;
-    options.autoReconnect = autoReconnect ?? false;
-    options.webDebugger = webDebugger;
-    options.optional!.ssl = ssl ?? false;
-
-    // Handle header modification
-    options.headerModification = Array.isArray(headerModificationRaw)
-      ? headerModificationRaw.map(h =>
-        h.type === "remove"
-          ? { key: h.key, type: "remove" as const }
-          : { key: h.key, type: h.type, value: Array.isArray(h.value) ? h.value : [] },
-      )
-      : [];
-
-    // Parse forwarding JSON to extract type and forwarding address
-    if (forwardingJSON) {
-      try {
-      const forwardingRules = JSON.parse(forwardingJSON);
-      if (Array.isArray(forwardingRules) && forwardingRules.length > 0) {
-        options.forwarding = forwardingRules || null;
-      } else {
-        options.forwarding = null;
-      }
-      } catch (e) {
-      Logger.error("Failed to parse forwarding JSON:", e as Error);
-      options.forwarding = null;
-      }
-    } else {
-      options.forwarding = null;
-    }
-
-    // Parse argument string
-    const regex = /[^\s"']+|"([^"]*)"|'([^']*)'/g;
-    const argumentInParts: string[] = [];
-    let match;
-    while ((match = regex.exec(argString || "")) !== null) {
-      argumentInParts.push(match[1] || match[2] || match[0]);
+  private updateConfig(msg: Extract<WorkerMessage, { type: workerMessageType.UpdateConfig }>) {
+    const { id, args } = msg;
+    if (!this.tunnel || !this.config) {
+      this.sendResponse(id, null, `${!this.tunnel ? "Tunnel" : "Config"} not initialized`);
+      return;
     }
-
-    if (
-      argumentInParts.length > 0 &&
-      !/^(w:|b:|k:|a:|r:|u:|x:)/.test(argumentInParts[0])
-    ) {
-      options.optional!.additionalArguments = argumentInParts[0];
+    try {
+      this.sendResponse(id, applyConfigUpdate(this.config, this.tunnel, args[0]));
+    } catch (err: any) {
+      Logger.error("TunnelWorker config update error:", err);
+      this.sendResponse(id, null, err?.message || String(err));
     }
-
-    return options;
   }
 
-
-  private normalizeBasicAuth(input: BasicAuthItem[] | null): BasicAuthItem[] {
-    let parsed: BasicAuthItem[] | null = null;
-    parsed = input || []
-    if (!Array.isArray(parsed) || parsed.length === 0) {
-      return [];
-    }
-    return parsed.filter(({ username, password }) => !!username && !!password);
+  private async getConfig(): Promise<TunnelConfigurationV1 | null> {
+    if (!this.config || !this.tunnel) return null;
+    return readTunnelConfig(this.config, this.tunnel);
   }
-
 }
 
 // ======== Worker Entrypoint ======== //
-const { options, logConfig } = workerData;
-new TunnelWorker(options, logConfig);
+const { options, logConfig, stateBuffer } = workerData;
+new TunnelWorker(options, logConfig, stateBuffer);